@@ -127,6 +127,7 @@ int main(int argc, char *argv[])
 						while (!glfwWindowShouldClose(window))
 						{
 							glfwPollEvents();
+							ClownAudio_CollectGarbage();
 
 							ImGui_ImplOpenGL3_NewFrame();
 							ImGui_ImplGlfw_NewFrame();
@@ -48,18 +48,43 @@ typedef struct ClownAudio_SoundDataConfig
 	bool must_predecode;
 	/// If sound is predecoded, then this needs to be true for `ClownAudio_SoundSetSampleRate` to work
 	bool dynamic_sample_rate;
+	/// If not NULL, then predecoded sounds are saved to this directory (which must already exist), and are mapped from it instead of
+	/// being decoded again the next time that they are loaded. Saved sounds are rebuilt automatically if their files change.
+	const char *predecode_cache_directory;
 } ClownAudio_SoundDataConfig;
 
 typedef struct ClownAudio_SoundConfig
 {
 	/// If true, the sound will loop indefinitely
+	/// Files with loop points in their metadata (`LOOPSTART`/`LOOPLENGTH` comments, or a WAV `smpl` chunk) loop between those, instead of looping the whole file
 	bool loop;
 	/// If true, the sound will not be automatically destroyed once it finishes playing
 	bool do_not_destroy_when_done;
-	/// If sound is not predecoded, then this needs to be true for `ClownAudio_SoundSetSampleRate` to work
+	/// If sound is not predecoded, then this needs to be true for `ClownAudio_SoundSetSampleRate` to work. `ClownAudio_SoundSetLowPassFilter` always needs it.
 	bool dynamic_sample_rate;
+	/// If true, the sound will be decoded ahead of time on a background thread, so that decoding cannot hold up the audio thread.
+	/// Worth it for sounds which are expensive to decode, but it makes changes to looping take a little while to be heard.
+	/// Always enabled for sounds that are streamed through `ClownAudio_IO` callbacks.
+	bool decode_ahead;
 } ClownAudio_SoundConfig;
 
+/// Callbacks for reading a file that is not simply in memory or on disk, such as one inside of an archive.
+/// They may be called from any thread, but never from more than one at once. They are never called from the audio thread, since sounds that stream
+/// through them are always decoded ahead (see `decode_ahead`), so they are free to block.
+typedef struct ClownAudio_IO
+{
+	/// Passed to each of the callbacks
+	void *user_data;
+	/// Reads up to `size` bytes into `buffer`, and returns how many were read
+	size_t (*read)(void *user_data, void *buffer, size_t size);
+	/// Moves to `position` bytes from the start of the file. Returns false if it fails.
+	bool (*seek)(void *user_data, size_t position);
+	/// Returns the current position, in bytes from the start of the file
+	size_t (*tell)(void *user_data);
+	/// Returns the size of the file, in bytes
+	size_t (*size)(void *user_data);
+} ClownAudio_IO;
+
 
 //////////////////////////////////
 // Configuration initialisation //
@@ -82,6 +107,22 @@ CLOWNAUDIO_EXPORT bool ClownAudio_Init(void);
 /// Deinitialises clownaudio
 CLOWNAUDIO_EXPORT void ClownAudio_Deinit(void);
 
+/// Sets how many extra threads are used to mix sounds in parallel. By default, there are none.
+/// Returns false if the threads could not be created, in which case there are none.
+/// Playback is paused while the threads are changed.
+CLOWNAUDIO_EXPORT bool ClownAudio_SetMixerWorkerCount(unsigned int worker_count);
+
+/// Makes a dedicated thread mix the given number of milliseconds ahead of time, so that the audio device only has to copy the result.
+/// This adds that much latency, but stops audio from breaking up when the audio thread is held up. 0 (the default) disables it.
+/// Returns false if the thread could not be created, in which case render-ahead is disabled.
+CLOWNAUDIO_EXPORT bool ClownAudio_SetRenderAhead(unsigned int milliseconds);
+
+/// Returns how many frames have been rendered ahead and are waiting to be played, or 0 if render-ahead is disabled.
+CLOWNAUDIO_EXPORT size_t ClownAudio_GetRenderAheadFill(void);
+
+/// Returns how many times the audio device has run out of rendered-ahead samples, and had to be given silence instead.
+CLOWNAUDIO_EXPORT unsigned long ClownAudio_GetRenderAheadUnderruns(void);
+
 
 //////////////////////////////////
 // Sound-data loading/unloading //
@@ -89,13 +130,34 @@ CLOWNAUDIO_EXPORT void ClownAudio_Deinit(void);
 
 /// Loads data from up to two memory buffers - either buffer pointer can be NULL.
 /// If two buffers are specified and looping is enabled, the sound will loop at the point where the first buffer ends and the second one begins.
+/// The buffers must stay valid until the sound-data is unloaded, unless `must_predecode` is set, in which case they can be freed as soon as this returns.
 CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_SoundDataLoadFromMemory(const unsigned char *file_buffer1, size_t file_size1, const unsigned char *file_buffer2, size_t file_size2, ClownAudio_SoundDataConfig *config);
 
 /// Loads data from up to two files - either file path can be NULL.
 /// If two files are specified and looping is enabled, the sound will loop at the point where the first file ends and the second one begins.
 CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_SoundDataLoadFromFiles(const char *intro_path, const char *loop_path, ClownAudio_SoundDataConfig *config);
 
+/// Loads data from up to two sets of callbacks - either pointer can be NULL.
+/// Formats that support it are streamed through the callbacks as they play, so the whole file never has to be in memory. Other formats are read into memory.
+/// Streamed sounds are always decoded ahead, on a background thread, so that the audio thread never has to wait for the callbacks.
+/// The callbacks must keep working until the sound-data is unloaded, unless `must_predecode` is set, in which case they are not used after this returns.
+CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_SoundDataLoadFromIO(const ClownAudio_IO *io1, const ClownAudio_IO *io2, ClownAudio_SoundDataConfig *config);
+
+/// Like `ClownAudio_SoundDataLoadFromFiles`, but the files are loaded (and predecoded, if requested) on a pool of background threads, one per processor core.
+/// Returns a handle to the load straight away, or NULL if the load could not be started.
+/// If `callback` is not NULL, it is called on a background thread once loading has finished, with the sound-data, or NULL if it could not be loaded.
+/// Either way, the handle must be passed to `ClownAudio_SoundDataLoadFinish` eventually, and every load must be finished before clownaudio is deinitialised.
+CLOWNAUDIO_EXPORT ClownAudio_SoundDataLoad* ClownAudio_SoundDataLoadAsync(const char *intro_path, const char *loop_path, ClownAudio_SoundDataConfig *config, void (*callback)(void *user_data, ClownAudio_SoundData *sound_data), void *user_data);
+
+/// Returns true if the load has finished, in which case `ClownAudio_SoundDataLoadFinish` will not have to wait.
+CLOWNAUDIO_EXPORT bool ClownAudio_SoundDataLoadIsDone(ClownAudio_SoundDataLoad *load);
+
+/// Waits for the load to finish, frees its handle, and returns the sound-data, or NULL if it could not be loaded.
+CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_SoundDataLoadFinish(ClownAudio_SoundDataLoad *load);
+
 /// Unloads data. All sounds using the specified data must be destroyed manually before this function is called.
+/// Unlike most other functions, this waits for the audio thread, which has to finish with the sounds before the data can be freed.
+/// If the audio thread does not respond within a moment (for instance, because the audio device has been lost), then the sounds are destroyed on the calling thread instead.
 CLOWNAUDIO_EXPORT void ClownAudio_SoundDataUnload(ClownAudio_SoundData *sound_data);
 
 
@@ -104,16 +166,29 @@ CLOWNAUDIO_EXPORT void ClownAudio_SoundDataUnload(ClownAudio_SoundData *sound_da
 ////////////////////////////////
 
 /// Creates a sound from sound-data. The sound will be paused by default.
+/// Returns 0 if the sound could not be created.
 CLOWNAUDIO_EXPORT ClownAudio_SoundID ClownAudio_SoundCreate(ClownAudio_SoundData *sound_data, ClownAudio_SoundConfig *config);
 
 /// Destroys sound.
 CLOWNAUDIO_EXPORT void ClownAudio_SoundDestroy(ClownAudio_SoundID sound_id);
 
+/// Frees sounds that have been destroyed, or that finished playing. The audio thread never frees memory, so until this is called, their
+/// decoders and buffers stay allocated. `ClownAudio_SoundCreate` and `ClownAudio_SoundDataUnload` call this automatically, but a program
+/// that goes a long time without either (for instance, while one piece of streamed music plays) should call it every now and then, such as once per frame.
+CLOWNAUDIO_EXPORT void ClownAudio_CollectGarbage(void);
+
 
 /////////////////////////////
 // Assorted sound controls //
 /////////////////////////////
 
+// These functions, along with `ClownAudio_SoundCreate` and `ClownAudio_SoundDestroy`, do not wait for the audio thread: their effects are queued,
+// and applied just before the next batch of samples is mixed. Up to 4096 of them can be waiting at once, which is far more than a program issues
+// between two batches in normal use.
+// If the queue is full anyway (for instance, because the audio device has stopped calling back), then a call does not fail or get dropped: instead,
+// it blocks while it pauses playback, applies everything that is queued along with itself, and resumes playback. Such a call can take as long as
+// the audio backend takes to pause and resume the device, so it should be avoided on threads that must not stall.
+
 /// Rewinds sound to the very beginning.
 CLOWNAUDIO_EXPORT void ClownAudio_SoundRewind(ClownAudio_SoundID sound_id);
 
@@ -124,6 +199,8 @@ CLOWNAUDIO_EXPORT void ClownAudio_SoundPause(ClownAudio_SoundID sound_id);
 CLOWNAUDIO_EXPORT void ClownAudio_SoundUnpause(ClownAudio_SoundID sound_id);
 
 /// Returns -1 if the sound does not exist, 0 if it is unpaused, or 1 if it is paused.
+/// The status lags behind the queued controls: it only reflects the ones that the audio thread has applied so far, so calling this straight after
+/// `ClownAudio_SoundPause`, `ClownAudio_SoundUnpause` or `ClownAudio_SoundDestroy` may still return the old status. The exception is that a new sound counts as paused straight away.
 CLOWNAUDIO_EXPORT int ClownAudio_SoundGetStatus(ClownAudio_SoundID sound_id);
 
 /// Sets stereo volume. Volume is linear and ranges from 0 (silence) to 0x100 (full volume). Exceeding 0x100 will amplify the volume.
@@ -137,6 +214,8 @@ CLOWNAUDIO_EXPORT void ClownAudio_SoundSetLoop(ClownAudio_SoundID sound_id, bool
 CLOWNAUDIO_EXPORT void ClownAudio_SoundSetSpeed(ClownAudio_SoundID sound_id, unsigned long speed);
 
 /// Set the low-pass filter cut-off point. Remember that the frequency is half of the sample rate.
+/// Note: the sound must have been created with `dynamic_sample_rate` enabled in the configuration struct, otherwise this function might silently fail.
+/// Only the clownresampler backend has a low-pass filter: with the others, this function does nothing.
 CLOWNAUDIO_EXPORT void ClownAudio_SoundSetLowPassFilter(ClownAudio_SoundID sound_id, unsigned long low_pass_filter_sample_rate);
 
 /// Make sound fade to the specified volume over the specified duration, measured in milliseconds.
@@ -36,6 +36,7 @@ extern "C" {
 typedef struct ClownAudio_Mixer ClownAudio_Mixer;
 typedef struct ClownAudio_Sound ClownAudio_Sound;
 typedef struct ClownAudio_SoundData ClownAudio_SoundData;
+typedef struct ClownAudio_SoundDataLoad ClownAudio_SoundDataLoad;
 typedef unsigned int ClownAudio_SoundID;
 
 typedef struct ClownAudio_SoundDataConfig
@@ -49,18 +50,43 @@ typedef struct ClownAudio_SoundDataConfig
 	bool must_predecode;
 	/// If sound is predecoded, then this needs to be true for `ClownAudio_SoundSetSampleRate` to work
 	bool dynamic_sample_rate;
+	/// If not NULL, then predecoded sounds are saved to this directory (which must already exist), and are mapped from it instead of
+	/// being decoded again the next time that they are loaded. Saved sounds are rebuilt automatically if their files change.
+	const char *predecode_cache_directory;
 } ClownAudio_SoundDataConfig;
 
 typedef struct ClownAudio_SoundConfig
 {
 	/// If true, the sound will loop indefinitely
+	/// Files with loop points in their metadata (`LOOPSTART`/`LOOPLENGTH` comments, or a WAV `smpl` chunk) loop between those, instead of looping the whole file
 	bool loop;
 	/// If true, the sound will not be automatically destroyed once it finishes playing
 	bool do_not_destroy_when_done;
-	/// If sound is not predecoded, then this needs to be true for `ClownAudio_SoundSetSampleRate` to work
+	/// If sound is not predecoded, then this needs to be true for `ClownAudio_SoundSetSampleRate` to work. `ClownAudio_SoundSetLowPassFilter` always needs it.
 	bool dynamic_sample_rate;
+	/// If true, the sound will be decoded ahead of time on a background thread, so that decoding cannot hold up the audio thread.
+	/// Worth it for sounds which are expensive to decode, but it makes changes to looping take a little while to be heard.
+	/// Always enabled for sounds that are streamed through `ClownAudio_IO` callbacks.
+	bool decode_ahead;
 } ClownAudio_SoundConfig;
 
+/// Callbacks for reading a file that is not simply in memory or on disk, such as one inside of an archive.
+/// They may be called from any thread, but never from more than one at once. They are never called from the audio thread, since sounds that stream
+/// through them are always decoded ahead (see `decode_ahead`), so they are free to block.
+typedef struct ClownAudio_IO
+{
+	/// Passed to each of the callbacks
+	void *user_data;
+	/// Reads up to `size` bytes into `buffer`, and returns how many were read
+	size_t (*read)(void *user_data, void *buffer, size_t size);
+	/// Moves to `position` bytes from the start of the file. Returns false if it fails.
+	bool (*seek)(void *user_data, size_t position);
+	/// Returns the current position, in bytes from the start of the file
+	size_t (*tell)(void *user_data);
+	/// Returns the size of the file, in bytes
+	size_t (*size)(void *user_data);
+} ClownAudio_IO;
+
 
 //////////////////////////////////
 // Configuration initialisation //
@@ -80,9 +106,15 @@ CLOWNAUDIO_EXPORT void ClownAudio_SoundConfigInit(ClownAudio_SoundConfig *config
 /// Creates a mixer. Will return NULL if it fails.
 CLOWNAUDIO_EXPORT ClownAudio_Mixer* ClownAudio_Mixer_Create(unsigned long sample_rate);
 
-/// Destroys a mixer. All sounds playing through the specified mixer must be destroyed manually before this function is called.
+/// Destroys a mixer, along with any sounds that are still registered to it. Sounds that were created but never registered must be destroyed manually before this function is called.
 CLOWNAUDIO_EXPORT void ClownAudio_Mixer_Destroy(ClownAudio_Mixer *mixer);
 
+/// Sets how many extra threads the mixer uses to mix sounds in parallel. By default, there are none, and every sound is mixed on the thread that calls `ClownAudio_Mixer_MixSamples`.
+/// This is worth doing when many sounds that are expensive to decode (such as trackers or emulated formats) play at once.
+/// Returns false if the threads could not be created, in which case the mixer is left with none.
+/// Must be guarded with mutex.
+CLOWNAUDIO_EXPORT bool ClownAudio_Mixer_SetWorkerCount(ClownAudio_Mixer *mixer, unsigned int worker_count);
+
 
 //////////////////////////////////
 // Sound-data loading/unloading //
@@ -90,12 +122,35 @@ CLOWNAUDIO_EXPORT void ClownAudio_Mixer_Destroy(ClownAudio_Mixer *mixer);
 
 /// Loads data from up to two memory buffers - either buffer pointer can be NULL.
 /// If two buffers are specified and looping is enabled, the sound will loop at the point where the first buffer ends and the second one begins.
+/// The buffers must stay valid until the sound-data is unloaded, unless `must_predecode` is set, in which case they can be freed as soon as this returns.
 CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_Mixer_SoundDataLoadFromMemory(ClownAudio_Mixer *mixer, const unsigned char *file_buffer1, size_t file_size1, const unsigned char *file_buffer2, size_t file_size2, ClownAudio_SoundDataConfig *config);
 
 /// Loads data from up to two files - either file path can be NULL.
 /// If two files are specified and looping is enabled, the sound will loop at the point where the first file ends and the second one begins.
 CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_Mixer_SoundDataLoadFromFiles(ClownAudio_Mixer *mixer, const char *intro_path, const char *loop_path, ClownAudio_SoundDataConfig *config);
 
+/// Loads data from up to two sets of callbacks - either pointer can be NULL.
+/// Formats that support it are streamed through the callbacks as they play, so the whole file never has to be in memory. Other formats are read into memory.
+/// Streamed sounds are always decoded ahead, on a background thread, so that the audio thread never has to wait for the callbacks.
+/// The callbacks must keep working until the sound-data is unloaded, unless `must_predecode` is set, in which case they are not used after this returns.
+CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_Mixer_SoundDataLoadFromIO(ClownAudio_Mixer *mixer, const ClownAudio_IO *io1, const ClownAudio_IO *io2, ClownAudio_SoundDataConfig *config);
+
+/// Like `ClownAudio_Mixer_SoundDataLoadFromFiles`, but the files are loaded (and predecoded, if requested) on a pool of background threads, one per processor core.
+/// Returns a handle to the load straight away, or NULL if the load could not be started.
+/// If `callback` is not NULL, it is called on a background thread once loading has finished, with the sound-data, or NULL if it could not be loaded.
+/// Either way, the handle must be passed to `ClownAudio_Mixer_SoundDataLoadFinish` eventually, and every load must be finished before the mixer is destroyed.
+CLOWNAUDIO_EXPORT ClownAudio_SoundDataLoad* ClownAudio_Mixer_SoundDataLoadAsync(ClownAudio_Mixer *mixer, const char *intro_path, const char *loop_path, ClownAudio_SoundDataConfig *config, void (*callback)(void *user_data, ClownAudio_SoundData *sound_data), void *user_data);
+
+/// Returns true if the load has finished, in which case `ClownAudio_Mixer_SoundDataLoadFinish` will not have to wait.
+CLOWNAUDIO_EXPORT bool ClownAudio_Mixer_SoundDataLoadIsDone(ClownAudio_Mixer *mixer, ClownAudio_SoundDataLoad *load);
+
+/// Waits for the load to finish, frees its handle, and returns the sound-data, or NULL if it could not be loaded.
+CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_Mixer_SoundDataLoadFinish(ClownAudio_Mixer *mixer, ClownAudio_SoundDataLoad *load);
+
+/// Destroys every sound that was created from the sound-data.
+/// Must be guarded with mutex.
+CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundDataDestroySounds(ClownAudio_Mixer *mixer, ClownAudio_SoundData *sound_data);
+
 /// Unloads data. All sounds using the specified data must be destroyed manually before this function is called.
 CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundDataUnload(ClownAudio_Mixer *mixer, ClownAudio_SoundData *sound_data);
 
@@ -111,10 +166,25 @@ CLOWNAUDIO_EXPORT ClownAudio_Sound* ClownAudio_Mixer_SoundCreate(ClownAudio_Mixe
 /// Must be guarded with mutex.
 CLOWNAUDIO_EXPORT ClownAudio_SoundID ClownAudio_Mixer_SoundRegister(ClownAudio_Mixer *mixer, ClownAudio_Sound *sound, ClownAudio_SoundData *sound_data);
 
-/// Destroys sound.
+/// Reserves a sound ID, to be given to a sound later with `ClownAudio_Mixer_SoundRegisterWithID`. Returns 0 if it fails.
+/// Does not need to be guarded with mutex.
+CLOWNAUDIO_EXPORT ClownAudio_SoundID ClownAudio_Mixer_SoundAllocateID(ClownAudio_Mixer *mixer);
+
+/// Like `ClownAudio_Mixer_SoundRegister`, but uses an ID that was reserved with `ClownAudio_Mixer_SoundAllocateID`.
+/// If the ID is 0, then the sound is destroyed instead.
+/// Must be guarded with mutex.
+CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundRegisterWithID(ClownAudio_Mixer *mixer, ClownAudio_Sound *sound, ClownAudio_SoundData *sound_data, ClownAudio_SoundID sound_id);
+
+/// Destroys sound. Its memory is not released until `ClownAudio_Mixer_CollectGarbage` is called.
 /// Must be guarded with mutex.
 CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundDestroy(ClownAudio_Mixer *mixer, ClownAudio_SoundID sound_id);
 
+/// Frees sounds that have been destroyed, or that finished playing, along with any other memory that the mixer is done with.
+/// The mixer never frees memory while mixing, so this should be called every now and then from a thread other than the audio thread.
+/// `ClownAudio_Mixer_SoundCreate` and `ClownAudio_Mixer_SoundDataUnload` call this automatically.
+/// Does not need to be guarded with mutex.
+CLOWNAUDIO_EXPORT void ClownAudio_Mixer_CollectGarbage(ClownAudio_Mixer *mixer);
+
 
 /////////////////////////////
 // Assorted sound controls //
@@ -133,7 +203,8 @@ CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundPause(ClownAudio_Mixer *mixer, Clow
 CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundUnpause(ClownAudio_Mixer *mixer, ClownAudio_SoundID sound_id);
 
 /// Returns -1 if the sound does not exist, 0 if it is unpaused, or 1 if it is paused.
-/// Must be guarded with mutex.
+/// A sound counts as paused from the moment its ID is allocated.
+/// Does not need to be guarded with mutex.
 CLOWNAUDIO_EXPORT int ClownAudio_Mixer_SoundGetStatus(ClownAudio_Mixer *mixer, ClownAudio_SoundID sound_id);
 
 /// Sets stereo volume. Volume is linear and ranges from 0 (silence) to 0x100 (full volume). Exceeding 0x100 will amplify the volume.
@@ -150,6 +221,8 @@ CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundSetLoop(ClownAudio_Mixer *mixer, Cl
 CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundSetSpeed(ClownAudio_Mixer *mixer, ClownAudio_SoundID sound_id, unsigned long speed);
 
 /// Set the low-pass filter cut-off point. Remember that the frequency is half of the sample rate.
+/// Note: the sound must have been created with `dynamic_sample_rate` enabled in the configuration struct, otherwise this function might silently fail.
+/// Only the clownresampler backend has a low-pass filter: with the others, this function does nothing.
 CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundSetLowPassFilter(ClownAudio_Mixer *mixer, ClownAudio_SoundID sound_id, unsigned long low_pass_filter_sample_rate);
 
 /// Make sound fade to the specified volume over the specified duration, measured in milliseconds.
@@ -163,7 +236,7 @@ CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundFade(ClownAudio_Mixer *mixer, Clown
 // Output //
 ////////////
 
-/// Mix interlaced (L,R ordering) S16 PCM samples into specified S32 buffer (not clamped).
+/// Add interlaced (L,R ordering) S16 PCM samples to the contents of the specified S32 buffer (not clamped).
 /// Must be guarded with mutex.
 CLOWNAUDIO_EXPORT void ClownAudio_Mixer_MixSamples(ClownAudio_Mixer *mixer, long *output_buffer, size_t frames_to_do);
 
@@ -171,6 +244,20 @@ CLOWNAUDIO_EXPORT void ClownAudio_Mixer_MixSamples(ClownAudio_Mixer *mixer, long
 /// Must be guarded with mutex.
 CLOWNAUDIO_EXPORT void ClownAudio_Mixer_OutputSamples(ClownAudio_Mixer *mixer, short *output_buffer, size_t frames_to_do);
 
+/// Add interlaced (L,R ordering) float PCM samples to the contents of the specified float buffer (not clamped).
+/// The buffer is not cleared first, so it must already hold silence or other audio. Samples range from -1.0 to 1.0.
+/// Must be guarded with mutex.
+CLOWNAUDIO_EXPORT void ClownAudio_Mixer_MixSamplesFloat(ClownAudio_Mixer *mixer, float *output_buffer, size_t frames_to_do);
+
+/// Output interlaced (L,R ordering) float PCM samples into specified float buffer (not clamped).
+/// The buffer's previous contents are overwritten. Samples range from -1.0 to 1.0.
+/// Must be guarded with mutex.
+CLOWNAUDIO_EXPORT void ClownAudio_Mixer_OutputSamplesFloat(ClownAudio_Mixer *mixer, float *output_buffer, size_t frames_to_do);
+
+/// Output planar float PCM samples (not clamped). `output_buffers` is an array of two buffers: left, then right.
+/// Must be guarded with mutex.
+CLOWNAUDIO_EXPORT void ClownAudio_Mixer_OutputSamplesFloatPlanar(ClownAudio_Mixer *mixer, float *const *output_buffers, size_t frames_to_do);
+
 
 #ifdef __cplusplus
 }
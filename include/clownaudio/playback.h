@@ -39,6 +39,7 @@ typedef struct ClownAudio_Stream ClownAudio_Stream;
 CLOWNAUDIO_EXPORT bool ClownAudio_InitPlayback(void);
 CLOWNAUDIO_EXPORT void ClownAudio_DeinitPlayback(void);
 CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *sample_rate, void (*user_callback)(void *user_data, short *output_buffer, size_t frames_to_do));
+CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreateFloat(unsigned long *sample_rate, void (*user_callback)(void *user_data, float *output_buffer, size_t frames_to_do)); // Like `ClownAudio_StreamCreate`, but with interlaced float samples (-1.0 to 1.0, not clamped)
 CLOWNAUDIO_EXPORT bool ClownAudio_StreamDestroy(ClownAudio_Stream *stream);
 CLOWNAUDIO_EXPORT void ClownAudio_StreamSetCallbackData(ClownAudio_Stream *stream, void *user_data);
 CLOWNAUDIO_EXPORT bool ClownAudio_StreamPause(ClownAudio_Stream *stream);
@@ -0,0 +1,102 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+// Minimal atomic operations, since neither C99 nor C++98 provide any.
+// Loads have acquire semantics, stores have release semantics, and everything else is sequentially-consistent.
+
+#ifndef ATOMIC_H
+#define ATOMIC_H
+
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+#include <stddef.h>
+
+#if defined(__GNUC__)
+ #define ATOMIC_GCC
+#elif defined(_MSC_VER)
+ #define ATOMIC_MSVC
+ #include <intrin.h>
+#else
+ #error "clownaudio does not know how to perform atomic operations with this compiler"
+#endif
+
+#if defined(ATOMIC_MSVC) && !defined(__cplusplus)
+ #define ATOMIC_INLINE static __inline
+#else
+ #define ATOMIC_INLINE static inline
+#endif
+
+ATOMIC_INLINE unsigned long Atomic_Load(volatile unsigned long *pointer)
+{
+#ifdef ATOMIC_GCC
+	return __atomic_load_n(pointer, __ATOMIC_ACQUIRE);
+#else
+	return (unsigned long)_InterlockedCompareExchange((volatile long*)pointer, 0, 0);
+#endif
+}
+
+ATOMIC_INLINE void Atomic_Store(volatile unsigned long *pointer, unsigned long value)
+{
+#ifdef ATOMIC_GCC
+	__atomic_store_n(pointer, value, __ATOMIC_RELEASE);
+#else
+	_InterlockedExchange((volatile long*)pointer, (long)value);
+#endif
+}
+
+// Returns the value from before the addition
+ATOMIC_INLINE unsigned long Atomic_FetchAdd(volatile unsigned long *pointer, unsigned long value)
+{
+#ifdef ATOMIC_GCC
+	return __atomic_fetch_add(pointer, value, __ATOMIC_SEQ_CST);
+#else
+	return (unsigned long)_InterlockedExchangeAdd((volatile long*)pointer, (long)value);
+#endif
+}
+
+// Returns true if `*pointer` was equal to `expected`, and has been replaced with `desired`
+ATOMIC_INLINE bool Atomic_CompareExchange(volatile unsigned long *pointer, unsigned long expected, unsigned long desired)
+{
+#ifdef ATOMIC_GCC
+	return __atomic_compare_exchange_n(pointer, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#else
+	return (unsigned long)_InterlockedCompareExchange((volatile long*)pointer, (long)desired, (long)expected) == expected;
+#endif
+}
+
+ATOMIC_INLINE void* Atomic_LoadPointer(void *volatile *pointer)
+{
+#ifdef ATOMIC_GCC
+	return __atomic_load_n(pointer, __ATOMIC_ACQUIRE);
+#else
+	return _InterlockedCompareExchangePointer(pointer, NULL, NULL);
+#endif
+}
+
+// Returns true if `*pointer` was equal to `expected`, and has been replaced with `desired`
+ATOMIC_INLINE bool Atomic_CompareExchangePointer(void *volatile *pointer, void *expected, void *desired)
+{
+#ifdef ATOMIC_GCC
+	return __atomic_compare_exchange_n(pointer, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#else
+	return _InterlockedCompareExchangePointer(pointer, desired, expected) == expected;
+#endif
+}
+
+#endif // ATOMIC_H
@@ -22,11 +22,16 @@
 #include <stdbool.h>
 #endif
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "clownaudio/mixer.h"
 #include "clownaudio/playback.h"
 
+#include "atomic.h"
+#include "command_queue.h"
+#include "threading.h"
+
 #ifdef CLOWNAUDIO_OSWRAPPER_AUDIO
 #define OSWRAPPER_AUDIO_MANAGE_COINIT
 #define OSWRAPPER_AUDIO_NO_LOAD_FROM_PATH
@@ -34,24 +39,345 @@
 #include "decoding/decoders/libs/OSWrapper/oswrapper_audio.h"
 #endif
 
+// Must match the limit given in `clownaudio.h`
+#define COMMAND_QUEUE_SIZE 0x1000
+
+// How long `ClownAudio_SoundDataUnload` waits for the mixing thread before doing the work itself
+#define UNLOAD_TIMEOUT_MILLISECONDS 200
+
+// The most that the render-ahead thread will mix in one go, so that it does not hold the mixer mutex for too long when the worker count is being changed
+#define RENDER_AHEAD_CHUNK_FRAMES 0x400
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+typedef struct RenderAhead
+{
+	Thread *thread;
+	Semaphore *semaphore;	// Only posted to make the thread quit: the device callback never posts it, since posting takes a lock
+	volatile unsigned long quit;
+
+	void *ring;	// Holds samples in the stream's format
+	unsigned long ring_frames;	// Always a power of two
+	unsigned long target_frames;	// How full the ring is kept
+
+	// Positions count frames, and are allowed to wrap
+	volatile unsigned long write_position;
+	volatile unsigned long read_position;
+	volatile unsigned long underruns;
+} RenderAhead;
+
 static ClownAudio_Stream *stream;
+static unsigned long sample_rate;
+static bool float_output;	// The stream takes float samples, so the mix is never clamped to S16 along the way
+static size_t frame_size;	// The size of one frame in the stream's format
 static ClownAudio_Mixer *mixer;
 
+// Only the thread that is mixing may touch the mixer's sounds. That is the device callback, unless render-ahead is
+// enabled, in which case it is the render-ahead thread. The device callback never takes a lock, so the API can never hold it up.
+
+// Held by the render-ahead thread while it mixes, so that the worker count can be changed without stopping it.
+// The device callback does not need it, since the stream is paused instead.
+static Mutex *mixer_mutex;
+
+// Held while the stream is paused so that another thread can mix, so that two such threads cannot resume it under each other
+static Mutex *pause_mutex;
+
+// Sound controls are not applied to the mixer directly: instead, they are sent to
+// the mixing thread through this queue, so that the calling thread never has to wait
+// for the mixer to finish. If the queue is full, then the calling thread stops the
+// mixing thread and applies the command itself, so that nothing is ever lost.
+static CommandQueue *command_queue;
+
+// Sound-data cannot be freed until the mixing thread has destroyed its sounds, so unloading it is a request to that thread
+static Mutex *unload_mutex;	// Only one unload can be requested at a time
+static Semaphore *unload_semaphore;	// Posted once the request has been dealt with
+static void *volatile unload_request;	// The sound-data to destroy the sounds of
+
+// When this exists, mixing is done on its own thread, ahead of time, and the device callback just copies the result
+static RenderAhead *render_ahead;
+
+static void ApplyCommand(const Command *command)
+{
+	switch (command->type)
+	{
+		case COMMAND_REGISTER:
+			ClownAudio_Mixer_SoundRegisterWithID(mixer, command->parameters.reg.sound, command->parameters.reg.sound_data, command->sound_id);
+			break;
+
+		case COMMAND_DESTROY:
+			ClownAudio_Mixer_SoundDestroy(mixer, command->sound_id);
+			break;
+
+		case COMMAND_REWIND:
+			ClownAudio_Mixer_SoundRewind(mixer, command->sound_id);
+			break;
+
+		case COMMAND_PAUSE:
+			ClownAudio_Mixer_SoundPause(mixer, command->sound_id);
+			break;
+
+		case COMMAND_UNPAUSE:
+			ClownAudio_Mixer_SoundUnpause(mixer, command->sound_id);
+			break;
+
+		case COMMAND_SET_VOLUME:
+			ClownAudio_Mixer_SoundSetVolume(mixer, command->sound_id, command->parameters.volume.left, command->parameters.volume.right);
+			break;
+
+		case COMMAND_SET_LOOP:
+			ClownAudio_Mixer_SoundSetLoop(mixer, command->sound_id, command->parameters.loop);
+			break;
+
+		case COMMAND_SET_SPEED:
+			ClownAudio_Mixer_SoundSetSpeed(mixer, command->sound_id, command->parameters.speed);
+			break;
+
+		case COMMAND_SET_LOW_PASS_FILTER:
+			ClownAudio_Mixer_SoundSetLowPassFilter(mixer, command->sound_id, command->parameters.low_pass_filter_sample_rate);
+			break;
+
+		case COMMAND_FADE:
+			ClownAudio_Mixer_SoundFade(mixer, command->sound_id, command->parameters.fade.volume, command->parameters.fade.duration);
+			break;
+	}
+}
+
+// Must only be called by the thread that is mixing
+static void DrainCommandQueue(void)
+{
+	// This is checked first, so that the commands which were queued before the request are applied before it is dealt with
+	ClownAudio_SoundData *sound_data = (ClownAudio_SoundData*)Atomic_LoadPointer(&unload_request);
+
+	Command command;
+
+	while (CommandQueue_Pop(command_queue, &command))
+		ApplyCommand(&command);
+
+	if (sound_data != NULL)
+	{
+		ClownAudio_Mixer_SoundDataDestroySounds(mixer, sound_data);
+
+		Atomic_CompareExchangePointer(&unload_request, sound_data, NULL);
+		Semaphore_Post(unload_semaphore);
+	}
+}
+
+// Stops the device callback and the render-ahead thread from mixing, so that the calling thread can touch the mixer's sounds
+static void TakeOverMixing(void)
+{
+	Mutex_Lock(pause_mutex);
+	ClownAudio_StreamPause(stream);
+	Mutex_Lock(mixer_mutex);
+}
+
+static void HandBackMixing(void)
+{
+	Mutex_Unlock(mixer_mutex);
+	ClownAudio_StreamResume(stream);
+	Mutex_Unlock(pause_mutex);
+}
+
+static void SubmitCommand(const Command *command)
+{
+	if (!CommandQueue_Push(command_queue, command))
+	{
+		// The mixing thread has fallen far behind (or stopped altogether), so apply the command here instead,
+		// after the ones that are already queued so that they stay in order
+		TakeOverMixing();
+		DrainCommandQueue();
+		ApplyCommand(command);
+		HandBackMixing();
+	}
+}
+
+// Writes `frames_to_do` frames to `output_buffer`, in the stream's format
+static void OutputSamples(void *output_buffer, size_t frames_to_do)
+{
+	if (float_output)
+		ClownAudio_Mixer_OutputSamplesFloat(mixer, (float*)output_buffer, frames_to_do);
+	else
+		ClownAudio_Mixer_OutputSamples(mixer, (short*)output_buffer, frames_to_do);
+}
+
+// Tops up the render-ahead ring. Must only be called by one thread at a time.
+static void RenderAheadFill(void)
+{
+	for (;;)
+	{
+		const unsigned long write_position = render_ahead->write_position;
+		const unsigned long frames_buffered = write_position - Atomic_Load(&render_ahead->read_position);
+
+		if (frames_buffered >= render_ahead->target_frames)
+			break;
+
+		// Don't write past the end of the ring: the rest will be done on the next iteration
+		const unsigned long ring_index = write_position & (render_ahead->ring_frames - 1);
+		const unsigned long frames_to_do = MIN(MIN(render_ahead->target_frames - frames_buffered, render_ahead->ring_frames - ring_index), RENDER_AHEAD_CHUNK_FRAMES);
+
+		Mutex_Lock(mixer_mutex);
+		DrainCommandQueue();
+		OutputSamples((char*)render_ahead->ring + ring_index * frame_size, frames_to_do);
+		Mutex_Unlock(mixer_mutex);
+
+		Atomic_Store(&render_ahead->write_position, write_position + frames_to_do);
+	}
+}
+
+static void RenderAheadThread(void *user_data)
+{
+	(void)user_data;
+
+	for (;;)
+	{
+		RenderAheadFill();
+
+		// Rather than be woken by the device callback, sleep until the ring has drained to about three quarters of its target
+		const unsigned long frames_buffered = Atomic_Load(&render_ahead->write_position) - Atomic_Load(&render_ahead->read_position);
+		const unsigned long low_water_frames = render_ahead->target_frames - render_ahead->target_frames / 4;
+		const unsigned long milliseconds = frames_buffered > low_water_frames ? (frames_buffered - low_water_frames) * 1000 / sample_rate : 0;
+
+		Semaphore_TimedWait(render_ahead->semaphore, milliseconds != 0 ? milliseconds : 1);
+
+		if (Atomic_Load(&render_ahead->quit))
+			break;
+	}
+}
+
+static void RenderAheadRead(char *output_buffer, size_t frames_to_do)
+{
+	unsigned long read_position = render_ahead->read_position;
+	const unsigned long frames_buffered = Atomic_Load(&render_ahead->write_position) - read_position;
+	const size_t frames_done = MIN(frames_to_do, frames_buffered);
+
+	for (size_t frames_copied = 0; frames_copied != frames_done; )
+	{
+		const unsigned long ring_index = read_position & (render_ahead->ring_frames - 1);
+		const size_t frames = MIN(frames_done - frames_copied, render_ahead->ring_frames - ring_index);
+
+		memcpy(&output_buffer[frames_copied * frame_size], (char*)render_ahead->ring + ring_index * frame_size, frames * frame_size);
+
+		frames_copied += frames;
+		read_position += (unsigned long)frames;
+	}
+
+	Atomic_Store(&render_ahead->read_position, read_position);
+
+	if (frames_done != frames_to_do)
+	{
+		// The mixing thread has fallen behind, so fill the gap with silence rather than wait for it
+		// All bits clear is silence in both S16 and float
+		memset(&output_buffer[frames_done * frame_size], 0, (frames_to_do - frames_done) * frame_size);
+		Atomic_FetchAdd(&render_ahead->underruns, 1);
+	}
+}
+
+// The stream must be paused
+static bool RenderAheadStart(unsigned int milliseconds)
+{
+	render_ahead = (RenderAhead*)malloc(sizeof(RenderAhead));
+
+	if (render_ahead != NULL)
+	{
+		render_ahead->quit = false;
+		render_ahead->write_position = 0;
+		render_ahead->read_position = 0;
+		render_ahead->underruns = 0;
+
+		render_ahead->target_frames = sample_rate * (milliseconds / 1000) + (sample_rate * (milliseconds % 1000) + 999) / 1000;
+
+		render_ahead->ring_frames = 1;
+
+		while (render_ahead->ring_frames < render_ahead->target_frames)
+			render_ahead->ring_frames <<= 1;
+
+		render_ahead->ring = malloc(render_ahead->ring_frames * frame_size);
+
+		if (render_ahead->ring != NULL)
+		{
+			render_ahead->semaphore = Semaphore_Create(0);
+
+			if (render_ahead->semaphore != NULL)
+			{
+				// Fill the ring before the device starts taking from it
+				RenderAheadFill();
+
+				render_ahead->thread = Thread_Create(RenderAheadThread, NULL);
+
+				if (render_ahead->thread != NULL)
+					return true;
+
+				Semaphore_Destroy(render_ahead->semaphore);
+			}
+
+			free(render_ahead->ring);
+		}
+
+		free(render_ahead);
+		render_ahead = NULL;
+	}
+
+	return false;
+}
+
+// The stream must be paused
+static void RenderAheadStop(void)
+{
+	if (render_ahead != NULL)
+	{
+		Atomic_Store(&render_ahead->quit, true);
+		Semaphore_Post(render_ahead->semaphore);
+		Thread_Join(render_ahead->thread);
+
+		Semaphore_Destroy(render_ahead->semaphore);
+		free(render_ahead->ring);
+		free(render_ahead);
+		render_ahead = NULL;
+	}
+}
+
+static void StreamOutput(void *output_buffer, size_t frames_to_do)
+{
+	if (render_ahead != NULL)
+	{
+		RenderAheadRead((char*)output_buffer, frames_to_do);
+	}
+	else
+	{
+		DrainCommandQueue();
+		OutputSamples(output_buffer, frames_to_do);
+	}
+}
+
 static void StreamCallback(void *user_data, short *output_buffer, size_t frames_to_do)
 {
 	(void)user_data;
 
-	ClownAudio_StreamLock(stream);
-	ClownAudio_Mixer_OutputSamples(mixer, output_buffer, frames_to_do);
-	ClownAudio_StreamUnlock(stream);
+	StreamOutput(output_buffer, frames_to_do);
+}
+
+static void StreamCallbackFloat(void *user_data, float *output_buffer, size_t frames_to_do)
+{
+	(void)user_data;
+
+	StreamOutput(output_buffer, frames_to_do);
 }
 
 CLOWNAUDIO_EXPORT bool ClownAudio_Init(void)
 {
 	if (ClownAudio_InitPlayback())
 	{
-		unsigned long sample_rate = 48000;	// This default value is a fallback - it will be overwritten if the backend has a preferred rate
-		stream = ClownAudio_StreamCreate(&sample_rate, StreamCallback);
+		// Prefer float output, since then the mix is only clamped by the device, but not every backend or device supports it
+		sample_rate = 48000;	// This default value is a fallback - it will be overwritten if the backend has a preferred rate
+		stream = ClownAudio_StreamCreateFloat(&sample_rate, StreamCallbackFloat);
+		float_output = stream != NULL;
+
+		if (stream == NULL)
+		{
+			sample_rate = 48000;
+			stream = ClownAudio_StreamCreate(&sample_rate, StreamCallback);
+		}
+
+		frame_size = (float_output ? sizeof(float) : sizeof(short)) * CLOWNAUDIO_STREAM_CHANNEL_COUNT;
 
 		if (stream != NULL)
 		{
@@ -59,14 +385,51 @@ CLOWNAUDIO_EXPORT bool ClownAudio_Init(void)
 
 			if (mixer != NULL)
 			{
-				ClownAudio_StreamResume(stream);
+				command_queue = CommandQueue_Create(COMMAND_QUEUE_SIZE);
+
+				if (command_queue != NULL)
+				{
+					mixer_mutex = Mutex_Create();
 
-			#ifdef CLOWNAUDIO_OSWRAPPER_AUDIO
-				if (oswrapper_audio_init())
-					is_oswrapper_audio_loaded = true;
-			#endif
+					if (mixer_mutex != NULL)
+					{
+						pause_mutex = Mutex_Create();
 
-				return true;
+						if (pause_mutex != NULL)
+						{
+							unload_mutex = Mutex_Create();
+
+							if (unload_mutex != NULL)
+							{
+								unload_semaphore = Semaphore_Create(0);
+
+								if (unload_semaphore != NULL)
+								{
+									unload_request = NULL;
+
+									ClownAudio_StreamResume(stream);
+
+								#ifdef CLOWNAUDIO_OSWRAPPER_AUDIO
+									if (oswrapper_audio_init())
+										is_oswrapper_audio_loaded = true;
+								#endif
+
+									return true;
+								}
+
+								Mutex_Destroy(unload_mutex);
+							}
+
+							Mutex_Destroy(pause_mutex);
+						}
+
+						Mutex_Destroy(mixer_mutex);
+					}
+
+					CommandQueue_Destroy(command_queue);
+				}
+
+				ClownAudio_Mixer_Destroy(mixer);
 			}
 
 			ClownAudio_StreamDestroy(stream);
@@ -81,6 +444,16 @@ CLOWNAUDIO_EXPORT bool ClownAudio_Init(void)
 CLOWNAUDIO_EXPORT void ClownAudio_Deinit(void)
 {
 	ClownAudio_StreamPause(stream);
+	RenderAheadStop();
+
+	// Nothing else is mixing now, so this thread can apply what is left in the queue
+	DrainCommandQueue();
+
+	Semaphore_Destroy(unload_semaphore);
+	Mutex_Destroy(unload_mutex);
+	Mutex_Destroy(pause_mutex);
+	Mutex_Destroy(mixer_mutex);
+	CommandQueue_Destroy(command_queue);
 	ClownAudio_Mixer_Destroy(mixer);
 	ClownAudio_StreamDestroy(stream);
 	ClownAudio_DeinitPlayback();
@@ -94,6 +467,44 @@ CLOWNAUDIO_EXPORT void ClownAudio_Deinit(void)
 #endif
 }
 
+CLOWNAUDIO_EXPORT bool ClownAudio_SetMixerWorkerCount(unsigned int worker_count)
+{
+	// Neither the device callback nor the render-ahead thread can be mixing while the workers are changed
+	TakeOverMixing();
+
+	const bool success = ClownAudio_Mixer_SetWorkerCount(mixer, worker_count);
+
+	HandBackMixing();
+
+	return success;
+}
+
+CLOWNAUDIO_EXPORT bool ClownAudio_SetRenderAhead(unsigned int milliseconds)
+{
+	// The device callback must not be running while the switch is made
+	Mutex_Lock(pause_mutex);
+	ClownAudio_StreamPause(stream);
+
+	RenderAheadStop();
+
+	const bool success = milliseconds == 0 || RenderAheadStart(milliseconds);
+
+	ClownAudio_StreamResume(stream);
+	Mutex_Unlock(pause_mutex);
+
+	return success;
+}
+
+CLOWNAUDIO_EXPORT size_t ClownAudio_GetRenderAheadFill(void)
+{
+	return render_ahead == NULL ? 0 : (size_t)(Atomic_Load(&render_ahead->write_position) - Atomic_Load(&render_ahead->read_position));
+}
+
+CLOWNAUDIO_EXPORT unsigned long ClownAudio_GetRenderAheadUnderruns(void)
+{
+	return render_ahead == NULL ? 0 : Atomic_Load(&render_ahead->underruns);
+}
+
 CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_SoundDataLoadFromMemory(const unsigned char *file_buffer1, size_t file_size1, const unsigned char *file_buffer2, size_t file_size2, ClownAudio_SoundDataConfig *config)
 {
 	return ClownAudio_Mixer_SoundDataLoadFromMemory(mixer, file_buffer1, file_size1, file_buffer2, file_size2, config);
@@ -104,90 +515,152 @@ CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_SoundDataLoadFromFiles(const
 	return ClownAudio_Mixer_SoundDataLoadFromFiles(mixer, intro_path, loop_path, config);
 }
 
+CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_SoundDataLoadFromIO(const ClownAudio_IO *io1, const ClownAudio_IO *io2, ClownAudio_SoundDataConfig *config)
+{
+	return ClownAudio_Mixer_SoundDataLoadFromIO(mixer, io1, io2, config);
+}
+
+CLOWNAUDIO_EXPORT ClownAudio_SoundDataLoad* ClownAudio_SoundDataLoadAsync(const char *intro_path, const char *loop_path, ClownAudio_SoundDataConfig *config, void (*callback)(void *user_data, ClownAudio_SoundData *sound_data), void *user_data)
+{
+	return ClownAudio_Mixer_SoundDataLoadAsync(mixer, intro_path, loop_path, config, callback, user_data);
+}
+
+CLOWNAUDIO_EXPORT bool ClownAudio_SoundDataLoadIsDone(ClownAudio_SoundDataLoad *load)
+{
+	return ClownAudio_Mixer_SoundDataLoadIsDone(mixer, load);
+}
+
+CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_SoundDataLoadFinish(ClownAudio_SoundDataLoad *load)
+{
+	return ClownAudio_Mixer_SoundDataLoadFinish(mixer, load);
+}
+
 CLOWNAUDIO_EXPORT void ClownAudio_SoundDataUnload(ClownAudio_SoundData *sound_data)
 {
-	ClownAudio_Mixer_SoundDataUnload(mixer, sound_data);
+	if (sound_data != NULL)
+	{
+		// Wait for the mixing thread to apply the commands that are already queued, and to destroy the sound-data's sounds
+		Mutex_Lock(unload_mutex);
+		Atomic_CompareExchangePointer(&unload_request, NULL, sound_data);
+
+		if (!Semaphore_TimedWait(unload_semaphore, UNLOAD_TIMEOUT_MILLISECONDS))
+		{
+			// The mixing thread is not responding (the device may have stopped or been lost), so do the work here instead.
+			// If the mixing thread got to the request after all, then this finds nothing to do, and the semaphore has been posted either way.
+			TakeOverMixing();
+			DrainCommandQueue();
+			HandBackMixing();
+
+			Semaphore_Wait(unload_semaphore);
+		}
+
+		ClownAudio_Mixer_SoundDataUnload(mixer, sound_data);
+		Mutex_Unlock(unload_mutex);
+	}
 }
 
 CLOWNAUDIO_EXPORT ClownAudio_SoundID ClownAudio_SoundCreate(ClownAudio_SoundData *sound_data, ClownAudio_SoundConfig *config)
 {
 	ClownAudio_Sound *sound = ClownAudio_Mixer_SoundCreate(mixer, sound_data, config);
 
-	ClownAudio_StreamLock(stream);
-	ClownAudio_SoundID sound_id = ClownAudio_Mixer_SoundRegister(mixer, sound, sound_data);
-	ClownAudio_StreamUnlock(stream);
+	if (sound == NULL)
+		return 0;
+
+	Command command;
+	command.type = COMMAND_REGISTER;
+	command.sound_id = ClownAudio_Mixer_SoundAllocateID(mixer);
+	command.parameters.reg.sound = sound;
+	command.parameters.reg.sound_data = sound_data;
+	SubmitCommand(&command);
 
-	return sound_id;
+	return command.sound_id;
 }
 
 CLOWNAUDIO_EXPORT void ClownAudio_SoundDestroy(ClownAudio_SoundID sound_id)
 {
-	ClownAudio_StreamLock(stream);
-	ClownAudio_Mixer_SoundDestroy(mixer, sound_id);
-	ClownAudio_StreamUnlock(stream);
+	Command command;
+	command.type = COMMAND_DESTROY;
+	command.sound_id = sound_id;
+	SubmitCommand(&command);
+}
+
+CLOWNAUDIO_EXPORT void ClownAudio_CollectGarbage(void)
+{
+	ClownAudio_Mixer_CollectGarbage(mixer);
 }
 
 CLOWNAUDIO_EXPORT void ClownAudio_SoundRewind(ClownAudio_SoundID sound_id)
 {
-	ClownAudio_StreamLock(stream);
-	ClownAudio_Mixer_SoundRewind(mixer, sound_id);
-	ClownAudio_StreamUnlock(stream);
+	Command command;
+	command.type = COMMAND_REWIND;
+	command.sound_id = sound_id;
+	SubmitCommand(&command);
 }
 
 CLOWNAUDIO_EXPORT void ClownAudio_SoundPause(ClownAudio_SoundID sound_id)
 {
-	ClownAudio_StreamLock(stream);
-	ClownAudio_Mixer_SoundPause(mixer, sound_id);
-	ClownAudio_StreamUnlock(stream);
+	Command command;
+	command.type = COMMAND_PAUSE;
+	command.sound_id = sound_id;
+	SubmitCommand(&command);
 }
 
 CLOWNAUDIO_EXPORT void ClownAudio_SoundUnpause(ClownAudio_SoundID sound_id)
-{	
-	ClownAudio_StreamLock(stream);
-	ClownAudio_Mixer_SoundUnpause(mixer, sound_id);
-	ClownAudio_StreamUnlock(stream);
+{
+	Command command;
+	command.type = COMMAND_UNPAUSE;
+	command.sound_id = sound_id;
+	SubmitCommand(&command);
 }
 
 CLOWNAUDIO_EXPORT void ClownAudio_SoundFade(ClownAudio_SoundID sound_id, unsigned short volume, unsigned int duration)
 {
-	ClownAudio_StreamLock(stream);
-	ClownAudio_Mixer_SoundFade(mixer, sound_id, volume, duration);
-	ClownAudio_StreamUnlock(stream);
+	Command command;
+	command.type = COMMAND_FADE;
+	command.sound_id = sound_id;
+	command.parameters.fade.volume = volume;
+	command.parameters.fade.duration = duration;
+	SubmitCommand(&command);
 }
 
 CLOWNAUDIO_EXPORT int ClownAudio_SoundGetStatus(ClownAudio_SoundID sound_id)
 {
-	ClownAudio_StreamLock(stream);
-	int status = ClownAudio_Mixer_SoundGetStatus(mixer, sound_id);
-	ClownAudio_StreamUnlock(stream);
-
-	return status;
+	return ClownAudio_Mixer_SoundGetStatus(mixer, sound_id);
 }
 
 CLOWNAUDIO_EXPORT void ClownAudio_SoundSetVolume(ClownAudio_SoundID sound_id, unsigned short volume_left, unsigned short volume_right)
 {
-	ClownAudio_StreamLock(stream);
-	ClownAudio_Mixer_SoundSetVolume(mixer, sound_id, volume_left, volume_right);
-	ClownAudio_StreamUnlock(stream);
+	Command command;
+	command.type = COMMAND_SET_VOLUME;
+	command.sound_id = sound_id;
+	command.parameters.volume.left = volume_left;
+	command.parameters.volume.right = volume_right;
+	SubmitCommand(&command);
 }
 
 CLOWNAUDIO_EXPORT void ClownAudio_SoundSetLoop(ClownAudio_SoundID sound_id, bool loop)
 {
-	ClownAudio_StreamLock(stream);
-	ClownAudio_Mixer_SoundSetLoop(mixer, sound_id, loop);
-	ClownAudio_StreamUnlock(stream);
+	Command command;
+	command.type = COMMAND_SET_LOOP;
+	command.sound_id = sound_id;
+	command.parameters.loop = loop;
+	SubmitCommand(&command);
 }
 
 CLOWNAUDIO_EXPORT void ClownAudio_SoundSetSpeed(ClownAudio_SoundID sound_id, unsigned long speed)
 {
-	ClownAudio_StreamLock(stream);
-	ClownAudio_Mixer_SoundSetSpeed(mixer, sound_id, speed);
-	ClownAudio_StreamUnlock(stream);
+	Command command;
+	command.type = COMMAND_SET_SPEED;
+	command.sound_id = sound_id;
+	command.parameters.speed = speed;
+	SubmitCommand(&command);
 }
 
 CLOWNAUDIO_EXPORT void ClownAudio_SoundSetLowPassFilter(ClownAudio_SoundID sound_id, unsigned long low_pass_filter_sample_rate)
 {
-	ClownAudio_StreamLock(stream);
-	ClownAudio_Mixer_SoundSetLowPassFilter(mixer, sound_id, low_pass_filter_sample_rate);
-	ClownAudio_StreamUnlock(stream);
+	Command command;
+	command.type = COMMAND_SET_LOW_PASS_FILTER;
+	command.sound_id = sound_id;
+	command.parameters.low_pass_filter_sample_rate = low_pass_filter_sample_rate;
+	SubmitCommand(&command);
 }
@@ -0,0 +1,126 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+// This is Dmitry Vyukov's bounded MPMC queue, with the consumer side simplified since only one thread pops at a time.
+// Each cell has a sequence number, which tells producers and the consumer whose turn it is to use the cell.
+
+#include "command_queue.h"
+
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "atomic.h"
+
+typedef struct CommandQueueCell
+{
+	volatile unsigned long sequence;
+	Command command;
+} CommandQueueCell;
+
+struct CommandQueue
+{
+	CommandQueueCell *cells;
+	unsigned long mask;
+
+	volatile unsigned long enqueue_position;
+	unsigned long dequeue_position;
+};
+
+CommandQueue* CommandQueue_Create(size_t size)
+{
+	CommandQueue *queue = (CommandQueue*)malloc(sizeof(CommandQueue));
+
+	if (queue != NULL)
+	{
+		queue->cells = (CommandQueueCell*)malloc(sizeof(CommandQueueCell) * size);
+
+		if (queue->cells != NULL)
+		{
+			for (size_t i = 0; i < size; ++i)
+				queue->cells[i].sequence = (unsigned long)i;
+
+			queue->mask = (unsigned long)size - 1;
+
+			queue->enqueue_position = 0;
+			queue->dequeue_position = 0;
+
+			return queue;
+		}
+
+		free(queue);
+	}
+
+	return NULL;
+}
+
+void CommandQueue_Destroy(CommandQueue *queue)
+{
+	free(queue->cells);
+	free(queue);
+}
+
+bool CommandQueue_Push(CommandQueue *queue, const Command *command)
+{
+	unsigned long position = Atomic_Load(&queue->enqueue_position);
+
+	for (;;)
+	{
+		CommandQueueCell *cell = &queue->cells[position & queue->mask];
+		const long difference = (long)(Atomic_Load(&cell->sequence) - position);
+
+		if (difference == 0)
+		{
+			// The cell is free: try to claim it
+			if (Atomic_CompareExchange(&queue->enqueue_position, position, position + 1))
+			{
+				cell->command = *command;
+				Atomic_Store(&cell->sequence, position + 1);	// Hand the cell over to the consumer
+				return true;
+			}
+		}
+		else if (difference < 0)
+		{
+			// The consumer has not got around to this cell yet, so the queue is full
+			return false;
+		}
+
+		// Another producer got here first: try again with the next position
+		position = Atomic_Load(&queue->enqueue_position);
+	}
+}
+
+bool CommandQueue_Pop(CommandQueue *queue, Command *command)
+{
+	const unsigned long position = queue->dequeue_position;
+	CommandQueueCell *cell = &queue->cells[position & queue->mask];
+
+	// Bail if the cell has not been filled yet
+	if (Atomic_Load(&cell->sequence) != position + 1)
+		return false;
+
+	*command = cell->command;
+	Atomic_Store(&cell->sequence, position + queue->mask + 1);	// Hand the cell back to the producers, for the next time around the ring
+
+	queue->dequeue_position = position + 1;
+
+	return true;
+}
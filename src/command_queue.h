@@ -0,0 +1,84 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+#include <stddef.h>
+
+#include "clownaudio/mixer.h"
+
+typedef enum CommandType
+{
+	COMMAND_REGISTER,
+	COMMAND_DESTROY,
+	COMMAND_REWIND,
+	COMMAND_PAUSE,
+	COMMAND_UNPAUSE,
+	COMMAND_SET_VOLUME,
+	COMMAND_SET_LOOP,
+	COMMAND_SET_SPEED,
+	COMMAND_SET_LOW_PASS_FILTER,
+	COMMAND_FADE
+} CommandType;
+
+typedef struct Command
+{
+	CommandType type;
+	ClownAudio_SoundID sound_id;
+
+	union
+	{
+		struct
+		{
+			ClownAudio_Sound *sound;
+			ClownAudio_SoundData *sound_data;
+		} reg;
+
+		struct
+		{
+			unsigned short left;
+			unsigned short right;
+		} volume;
+
+		struct
+		{
+			unsigned short volume;
+			unsigned int duration;
+		} fade;
+
+		bool loop;
+		unsigned long speed;
+		unsigned long low_pass_filter_sample_rate;
+	} parameters;
+} Command;
+
+typedef struct CommandQueue CommandQueue;
+
+// Bounded queue which any number of threads can push to without blocking.
+// Only one thread may pop at a time.
+
+CommandQueue* CommandQueue_Create(size_t size); // `size` must be a power of two
+void CommandQueue_Destroy(CommandQueue *queue);
+bool CommandQueue_Push(CommandQueue *queue, const Command *command); // Returns false if the queue is full
+bool CommandQueue_Pop(CommandQueue *queue, Command *command); // Returns false if the queue is empty
+
+#endif // COMMAND_QUEUE_H
@@ -0,0 +1,375 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#include "decode_ahead_decoder.h"
+
+#include <assert.h>
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "decoders/common.h"
+
+#include "../atomic.h"
+#include "../pool.h"
+#include "../threading.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+#define RING_FRAMES 0x1000	// Must be a power of two
+
+// The ring is only topped-up once it is this empty, so that the background thread is not woken for every little read
+#define REFILL_THRESHOLD (RING_FRAMES / 2)
+
+// How often the background thread checks for decoders that want topping-up. Half of the ring lasts about 10 milliseconds even
+// at 192kHz, so this leaves plenty of headroom.
+#define POLL_MILLISECONDS 5
+
+typedef struct DecodeAheadDecoder
+{
+	// Only touched by the background thread (or by `DecodeAheadDecoder_Create`, before the decoder is handed to it)
+	DecoderStage next_stage;
+	unsigned long applied_rewind_count;
+	unsigned long applied_loop;
+	struct DecodeAheadDecoder *prev;
+	struct DecodeAheadDecoder *next;
+
+	// Only touched by the reader
+	unsigned long seen_rewind_count;
+
+	// Requests from the reader to the background thread.
+	// Rewinds are counted rather than flagged, so that the background thread can tell when it has caught up.
+	volatile unsigned long rewind_count;
+	volatile unsigned long loop;
+	volatile unsigned long wake_pending;
+
+	// Written by the background thread. Positions count frames, and are allowed to wrap.
+	volatile unsigned long write_position;
+	volatile unsigned long ended;	// Set once the stage below has run out of samples, and `write_position` will not advance any more
+	volatile unsigned long rewound_count;	// The background thread has dealt with this many rewinds...
+	volatile unsigned long rewound_position;	// ...and the samples after the latest one begin here
+
+	// Written by the reader
+	volatile unsigned long read_position;
+
+	DecodeAheadThread *thread;
+	unsigned int channel_count;
+	short *ring;
+} DecodeAheadDecoder;
+
+struct DecodeAheadThread
+{
+	Thread *thread;
+	Semaphore *semaphore;	// Posted when the thread is quitting, or is given its first decoder. Readers never post it, since posting takes a lock.
+	Mutex *mutex;	// Guards the list of decoders, and is held while they are being filled
+	DecodeAheadDecoder *decoders;
+	volatile unsigned long quit;
+};
+
+// Must be called with the thread's mutex held, or before the decoder has been given to the thread
+static void Fill(DecodeAheadDecoder *decoder)
+{
+	Atomic_Store(&decoder->wake_pending, false);
+
+	const unsigned long rewind_count = Atomic_Load(&decoder->rewind_count);
+
+	if (decoder->applied_rewind_count != rewind_count)
+	{
+		// Everything in the ring is now stale: the reader will skip it once it sees `rewound_count` change
+		decoder->applied_rewind_count = rewind_count;
+		decoder->next_stage.Rewind(decoder->next_stage.decoder);
+
+		Atomic_Store(&decoder->ended, false);
+		Atomic_Store(&decoder->rewound_position, decoder->write_position);
+		Atomic_Store(&decoder->rewound_count, rewind_count);
+	}
+
+	const unsigned long loop = Atomic_Load(&decoder->loop);
+
+	if (decoder->applied_loop != loop)
+	{
+		// This only affects samples which have not been decoded yet, so anything already in the ring is kept
+		decoder->applied_loop = loop;
+		decoder->next_stage.SetLoop(decoder->next_stage.decoder, loop != 0);
+	}
+
+	if (decoder->ended)
+		return;
+
+	for (;;)
+	{
+		const unsigned long write_position = decoder->write_position;
+
+		// The reader will skip anything from before the latest rewind, so it can be overwritten without waiting for the reader to catch up
+		const unsigned long frames_used = MIN(write_position - Atomic_Load(&decoder->read_position), write_position - decoder->rewound_position);
+		const unsigned long frames_free = RING_FRAMES - frames_used;
+
+		if (frames_free == 0)
+			break;
+
+		// Don't write past the end of the ring: the rest will be done on the next iteration
+		const size_t ring_index = write_position & (RING_FRAMES - 1);
+		const size_t frames_to_do = MIN(frames_free, RING_FRAMES - ring_index);
+		const size_t frames_done = decoder->next_stage.GetSamples(decoder->next_stage.decoder, &decoder->ring[ring_index * decoder->channel_count], frames_to_do, NULL);
+
+		Atomic_Store(&decoder->write_position, write_position + (unsigned long)frames_done);
+
+		if (frames_done < frames_to_do)
+		{
+			Atomic_Store(&decoder->ended, true);
+			break;
+		}
+	}
+}
+
+static void ThreadFunction(void *user_data)
+{
+	DecodeAheadThread *thread = (DecodeAheadThread*)user_data;
+
+	bool idle = true;
+
+	for (;;)
+	{
+		// The readers are usually on the audio thread, so rather than wake this thread, they just flag their decoders for it to poll
+		if (idle)
+			Semaphore_Wait(thread->semaphore);
+		else
+			Semaphore_TimedWait(thread->semaphore, POLL_MILLISECONDS);
+
+		if (Atomic_Load(&thread->quit))
+			break;
+
+		Mutex_Lock(thread->mutex);
+
+		for (DecodeAheadDecoder *decoder = thread->decoders; decoder != NULL; decoder = decoder->next)
+			if (Atomic_Load(&decoder->wake_pending))
+				Fill(decoder);
+
+		idle = thread->decoders == NULL;
+
+		Mutex_Unlock(thread->mutex);
+	}
+}
+
+// Never takes a lock, so it is safe to call on the audio thread
+static void Wake(DecodeAheadDecoder *decoder)
+{
+	Atomic_Store(&decoder->wake_pending, true);
+}
+
+DecodeAheadThread* DecodeAheadThread_Create(void)
+{
+	DecodeAheadThread *thread = (DecodeAheadThread*)malloc(sizeof(DecodeAheadThread));
+
+	if (thread != NULL)
+	{
+		thread->decoders = NULL;
+		thread->quit = false;
+
+		thread->semaphore = Semaphore_Create(0);
+
+		if (thread->semaphore != NULL)
+		{
+			thread->mutex = Mutex_Create();
+
+			if (thread->mutex != NULL)
+			{
+				thread->thread = Thread_Create(ThreadFunction, thread);
+
+				if (thread->thread != NULL)
+					return thread;
+
+				Mutex_Destroy(thread->mutex);
+			}
+
+			Semaphore_Destroy(thread->semaphore);
+		}
+
+		free(thread);
+	}
+
+	return NULL;
+}
+
+void DecodeAheadThread_Destroy(DecodeAheadThread *thread)
+{
+	assert(thread->decoders == NULL);
+
+	Atomic_Store(&thread->quit, true);
+	Semaphore_Post(thread->semaphore);
+	Thread_Join(thread->thread);
+
+	Mutex_Destroy(thread->mutex);
+	Semaphore_Destroy(thread->semaphore);
+	free(thread);
+}
+
+void* DecodeAheadDecoder_Create(DecoderStage *next_stage, const DecoderSpec *spec, bool loop, DecodeAheadThread *thread, Pool *pool)
+{
+	DecodeAheadDecoder *decoder = (DecodeAheadDecoder*)Pool_Alloc(pool, sizeof(DecodeAheadDecoder));
+
+	if (decoder != NULL)
+	{
+		decoder->ring = (short*)Pool_Alloc(pool, RING_FRAMES * spec->channel_count * sizeof(short));
+
+		if (decoder->ring != NULL)
+		{
+			decoder->next_stage = *next_stage;
+			decoder->applied_rewind_count = 0;
+			decoder->applied_loop = loop;
+			decoder->seen_rewind_count = 0;
+			decoder->rewind_count = 0;
+			decoder->loop = loop;
+			decoder->wake_pending = false;
+			decoder->write_position = 0;
+			decoder->ended = false;
+			decoder->rewound_count = 0;
+			decoder->rewound_position = 0;
+			decoder->read_position = 0;
+			decoder->thread = thread;
+			decoder->channel_count = spec->channel_count;
+
+			// Fill the ring straight away, so that the sound does not start with silence
+			Fill(decoder);
+
+			// Hand the decoder over to the background thread
+			Mutex_Lock(thread->mutex);
+
+			const bool thread_was_idle = thread->decoders == NULL;
+
+			decoder->prev = NULL;
+			decoder->next = thread->decoders;
+
+			if (thread->decoders != NULL)
+				thread->decoders->prev = decoder;
+
+			thread->decoders = decoder;
+
+			Mutex_Unlock(thread->mutex);
+
+			// The background thread stops polling while it has no decoders, so make sure that it starts again
+			if (thread_was_idle)
+				Semaphore_Post(thread->semaphore);
+
+			return decoder;
+		}
+
+		Pool_Free(decoder);
+	}
+
+	return NULL;
+}
+
+void DecodeAheadDecoder_Destroy(void *decode_ahead_decoder_void)
+{
+	DecodeAheadDecoder *decoder = (DecodeAheadDecoder*)decode_ahead_decoder_void;
+	DecodeAheadThread *thread = decoder->thread;
+
+	// Taking the decoder back from the background thread also waits for it to finish filling it
+	Mutex_Lock(thread->mutex);
+
+	if (decoder->prev != NULL)
+		decoder->prev->next = decoder->next;
+	else
+		thread->decoders = decoder->next;
+
+	if (decoder->next != NULL)
+		decoder->next->prev = decoder->prev;
+
+	Mutex_Unlock(thread->mutex);
+
+	decoder->next_stage.Destroy(decoder->next_stage.decoder);
+	Pool_Free(decoder->ring);
+	Pool_Free(decoder);
+}
+
+void DecodeAheadDecoder_Rewind(void *decode_ahead_decoder_void)
+{
+	DecodeAheadDecoder *decoder = (DecodeAheadDecoder*)decode_ahead_decoder_void;
+
+	Atomic_Store(&decoder->rewind_count, decoder->rewind_count + 1);
+	Wake(decoder);
+}
+
+size_t DecodeAheadDecoder_GetSamples(void *decode_ahead_decoder_void, short *buffer, size_t frames_to_do, short *scratch)
+{
+	(void)scratch;
+
+	DecodeAheadDecoder *decoder = (DecodeAheadDecoder*)decode_ahead_decoder_void;
+
+	const unsigned long rewound_count = Atomic_Load(&decoder->rewound_count);
+
+	if (rewound_count != Atomic_Load(&decoder->rewind_count))
+	{
+		// The background thread has not dealt with the latest rewind yet, so everything in the ring is stale
+		memset(buffer, 0, frames_to_do * decoder->channel_count * sizeof(short));
+		return frames_to_do;
+	}
+
+	if (decoder->seen_rewind_count != rewound_count)
+	{
+		// Skip the samples from before the rewind
+		decoder->seen_rewind_count = rewound_count;
+		Atomic_Store(&decoder->read_position, Atomic_Load(&decoder->rewound_position));
+	}
+
+	// `ended` must be read before `write_position`, so that no samples are missed if the stage below ends in the meantime
+	const bool ended = Atomic_Load(&decoder->ended) != 0;
+	unsigned long read_position = decoder->read_position;
+	const size_t frames_available = (size_t)(Atomic_Load(&decoder->write_position) - read_position);
+
+	const size_t frames_done = MIN(frames_to_do, frames_available);
+
+	for (size_t frames_copied = 0; frames_copied != frames_done; )
+	{
+		const size_t ring_index = read_position & (RING_FRAMES - 1);
+		const size_t frames = MIN(frames_done - frames_copied, RING_FRAMES - ring_index);
+
+		memcpy(&buffer[frames_copied * decoder->channel_count], &decoder->ring[ring_index * decoder->channel_count], frames * decoder->channel_count * sizeof(short));
+
+		frames_copied += frames;
+		read_position += (unsigned long)frames;
+	}
+
+	Atomic_Store(&decoder->read_position, read_position);
+
+	if (!ended && frames_available - frames_done < RING_FRAMES - REFILL_THRESHOLD)
+		Wake(decoder);
+
+	if (frames_done < frames_to_do && !ended)
+	{
+		// The background thread has fallen behind: output silence rather than wait for it, and rather than make it look like the sound has ended
+		memset(&buffer[frames_done * decoder->channel_count], 0, (frames_to_do - frames_done) * decoder->channel_count * sizeof(short));
+		return frames_to_do;
+	}
+
+	return frames_done;
+}
+
+void DecodeAheadDecoder_SetLoop(void *decode_ahead_decoder_void, bool loop)
+{
+	DecodeAheadDecoder *decoder = (DecodeAheadDecoder*)decode_ahead_decoder_void;
+
+	// Samples which have already been decoded are kept, so this takes effect once the ring has been played through
+	Atomic_Store(&decoder->loop, loop);
+	Wake(decoder);
+}
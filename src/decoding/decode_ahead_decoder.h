@@ -0,0 +1,46 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#ifndef DECODE_AHEAD_DECODER_H
+#define DECODE_AHEAD_DECODER_H
+
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif // DECODE_AHEAD_DECODER_H
+#include <stddef.h>
+
+#include "decoders/common.h"
+
+#include "../pool.h"
+
+// A decoder stage which runs the stage below it on a background thread, buffering its output in a ring.
+// Reading from it never waits on the background thread: if the ring runs dry, silence is output instead.
+
+typedef struct DecodeAheadThread DecodeAheadThread;
+
+DecodeAheadThread* DecodeAheadThread_Create(void);
+void DecodeAheadThread_Destroy(DecodeAheadThread *thread); // All of the thread's decoders must be destroyed first
+
+void* DecodeAheadDecoder_Create(DecoderStage *next_stage, const DecoderSpec *spec, bool loop, DecodeAheadThread *thread, Pool *pool); // `loop` must match what the stage below is already set to
+void DecodeAheadDecoder_Destroy(void *decode_ahead_decoder);
+void DecodeAheadDecoder_Rewind(void *decode_ahead_decoder);
+size_t DecodeAheadDecoder_GetSamples(void *decode_ahead_decoder, short *buffer, size_t frames_to_do, short *scratch);
+void DecodeAheadDecoder_SetLoop(void *decode_ahead_decoder, bool loop);
+
+#endif // DECODE_AHEAD_DECODER_H
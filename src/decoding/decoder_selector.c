@@ -23,8 +23,14 @@
 #endif
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
+
+#include "../atomic.h"
 
 #include "decoders/common.h"
+#include "decoders/io_stream.h"
+#include "decoders/loop_points.h"
+#include "predecode_cache.h"
 #include "predecoder.h"
 
 #ifdef CLOWNAUDIO_LIBVORBIS
@@ -68,12 +74,24 @@
 #include "decoders/oswrapper_audio.h"
 #endif
 
-#define DECODER_FUNCTIONS(name) \
+#define COUNT_OF(array) (sizeof(array) / sizeof(*(array)))
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+// `create_from_io`, `clone`, `set_loop`, `seek`, `get_length` and `get_loop_points` are optional, and can be NULL
+#define DECODER_FUNCTIONS(name, format, create_from_io, clone, set_loop, seek, get_length, get_loop_points) \
 { \
+	format, \
+	#name, \
 	Decoder_##name##_Create, \
+	create_from_io, \
+	clone, \
 	Decoder_##name##_Destroy, \
 	Decoder_##name##_Rewind, \
-	Decoder_##name##_GetSamples \
+	Decoder_##name##_GetSamples, \
+	set_loop, \
+	seek, \
+	get_length, \
+	get_loop_points \
 }
 
 typedef enum DecoderType
@@ -83,12 +101,42 @@ typedef enum DecoderType
 	DECODER_TYPE_SIMPLE
 } DecoderType;
 
+// The file formats that can be recognised without trying to create a decoder
+typedef enum DecoderFormat
+{
+	DECODER_FORMAT_UNKNOWN,	// Also used by decoders which handle too many formats to be worth identifying
+	DECODER_FORMAT_VORBIS,
+	DECODER_FORMAT_MP3,
+	DECODER_FORMAT_OPUS,
+	DECODER_FORMAT_FLAC,
+	DECODER_FORMAT_WAV,
+	DECODER_FORMAT_MODULE,
+	DECODER_FORMAT_PXTONE,
+	DECODER_FORMAT_PXTONE_NOISE,
+	DECODER_FORMAT_SPC
+} DecoderFormat;
+
 typedef struct DecoderFunctions
 {
+	DecoderFormat format;
+	const char *name;	// Recorded in predecode cache entries, so that changing decoder for a format does not bring back PCM from the old one
 	void* (*Create)(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
+	// Optional: like `Create`, but streams the file from `io_source` instead of needing all of it in memory
+	void* (*CreateFromIO)(IOSource *io_source, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
+	// Optional: creates a decoder that shares whatever it can with one that was made earlier by `Create`, such
+	// as parsed headers and lookup tables. The prototype is never used for decoding, and outlives its clones.
+	void* (*Clone)(void *prototype, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
 	void (*Destroy)(void *decoder);
 	void (*Rewind)(void *decoder);
 	size_t (*GetSamples)(void *decoder, short *buffer, size_t frames_to_do);
+	// Optional: only used by complex decoders, since the simple ones are looped by the selector
+	void (*SetLoop)(void *decoder, bool loop);
+	// Optional, but both are needed for the predecoder to split the file between several threads.
+	// `Seek` must land on exactly the requested frame. `GetLength` returns 0 if the length is unknown.
+	bool (*Seek)(void *decoder, size_t frame);
+	size_t (*GetLength)(void *decoder);
+	// Optional: adds any loop points that are in the file's metadata to `loop_points`
+	void (*GetLoopPoints)(void *decoder, LoopPoints *loop_points);
 } DecoderFunctions;
 
 typedef struct DecoderSelector
@@ -96,163 +144,649 @@ typedef struct DecoderSelector
 	void *decoder;
 	DecoderSelectorData *data;
 	bool loop;
+	bool recyclable;	// If true, then the decoder can become the sound-data's spare once the sound is destroyed
+	size_t position;	// In frames. Only kept track of for simple decoders, so that they can stop at the loop point.
 } DecoderSelector;
 
 struct DecoderSelectorData
 {
 	const unsigned char *file_buffer;
 	size_t file_size;
+	IOSource *io_source;	// Used instead of `file_buffer` if the decoder can stream
+	unsigned char *io_source_buffer;	// All of `io_source`, if the decoder cannot stream
 	DecoderType decoder_type;
 	const DecoderFunctions *decoder_functions;
+	void *prototype;	// Kept from when the format was being identified, if the decoder supports cloning
+	void *volatile spare;	// Otherwise, that decoder is kept here instead, and handed to the next sound that can use it. Destroyed sounds give theirs back.
+	DecoderSpec spare_spec;
+	unsigned long spare_wanted_sample_rate;
 	PredecoderData *predecoder_data;
 	unsigned int channel_count;
+	LoopPoints loop_points;	// Only used by simple decoders, since predecoded data keeps its own
 };
 
 static const DecoderFunctions decoder_function_list[] = {
 #ifdef CLOWNAUDIO_LIBVORBIS
-	DECODER_FUNCTIONS(libVorbis),
+	DECODER_FUNCTIONS(libVorbis, DECODER_FORMAT_VORBIS, NULL, NULL, NULL, Decoder_libVorbis_Seek, NULL, Decoder_libVorbis_GetLoopPoints),
 #endif
 #ifdef CLOWNAUDIO_STB_VORBIS
-	DECODER_FUNCTIONS(STB_Vorbis),
+	DECODER_FUNCTIONS(STB_Vorbis, DECODER_FORMAT_VORBIS, NULL, Decoder_STB_Vorbis_Clone, NULL, Decoder_STB_Vorbis_Seek, Decoder_STB_Vorbis_GetLength, Decoder_STB_Vorbis_GetLoopPoints),
 #endif
 #ifdef CLOWNAUDIO_DR_MP3
-	DECODER_FUNCTIONS(DR_MP3),
+	DECODER_FUNCTIONS(DR_MP3, DECODER_FORMAT_MP3, Decoder_DR_MP3_CreateFromIO, NULL, NULL, NULL, NULL, NULL),
 #endif
 #ifdef CLOWNAUDIO_LIBOPUS
-	DECODER_FUNCTIONS(libOpus),
+	DECODER_FUNCTIONS(libOpus, DECODER_FORMAT_OPUS, NULL, NULL, NULL, Decoder_libOpus_Seek, NULL, Decoder_libOpus_GetLoopPoints),
 #endif
 #ifdef CLOWNAUDIO_LIBFLAC
-	DECODER_FUNCTIONS(libFLAC),
+	DECODER_FUNCTIONS(libFLAC, DECODER_FORMAT_FLAC, Decoder_libFLAC_CreateFromIO, NULL, NULL, Decoder_libFLAC_Seek, Decoder_libFLAC_GetLength, NULL),
 #endif
 #ifdef CLOWNAUDIO_DR_FLAC
-	DECODER_FUNCTIONS(DR_FLAC),
+	DECODER_FUNCTIONS(DR_FLAC, DECODER_FORMAT_FLAC, Decoder_DR_FLAC_CreateFromIO, NULL, NULL, Decoder_DR_FLAC_Seek, Decoder_DR_FLAC_GetLength, Decoder_DR_FLAC_GetLoopPoints),
 #endif
 #ifdef CLOWNAUDIO_DR_WAV
-	DECODER_FUNCTIONS(DR_WAV),
+	DECODER_FUNCTIONS(DR_WAV, DECODER_FORMAT_WAV, Decoder_DR_WAV_CreateFromIO, NULL, NULL, Decoder_DR_WAV_Seek, Decoder_DR_WAV_GetLength, Decoder_DR_WAV_GetLoopPoints),
 #endif
 #ifdef CLOWNAUDIO_LIBSNDFILE
-	DECODER_FUNCTIONS(libSndfile),
+	DECODER_FUNCTIONS(libSndfile, DECODER_FORMAT_UNKNOWN, Decoder_libSndfile_CreateFromIO, NULL, NULL, NULL, NULL, NULL),
 #endif
 #ifdef CLOWNAUDIO_LIBOPENMPT
-	DECODER_FUNCTIONS(libOpenMPT),
+	DECODER_FUNCTIONS(libOpenMPT, DECODER_FORMAT_MODULE, NULL, NULL, Decoder_libOpenMPT_SetLoop, NULL, NULL, NULL),
 #endif
 #ifdef CLOWNAUDIO_LIBXMP
-	DECODER_FUNCTIONS(libXMP),
+	DECODER_FUNCTIONS(libXMP, DECODER_FORMAT_MODULE, NULL, NULL, Decoder_libXMP_SetLoop, NULL, NULL, NULL),
 #endif
 #ifdef CLOWNAUDIO_PXTONE
-	DECODER_FUNCTIONS(PxTone),
+	DECODER_FUNCTIONS(PxTone, DECODER_FORMAT_PXTONE, NULL, Decoder_PxTone_Clone, Decoder_PxTone_SetLoop, NULL, NULL, NULL),
 #endif
 #ifdef CLOWNAUDIO_PXTONE
-	DECODER_FUNCTIONS(PxToneNoise),
+	DECODER_FUNCTIONS(PxToneNoise, DECODER_FORMAT_PXTONE_NOISE, NULL, Decoder_PxToneNoise_Clone, NULL, NULL, NULL, NULL),
 #endif
 #ifdef CLOWNAUDIO_SNES_SPC
-	DECODER_FUNCTIONS(SNES_SPC),
+	DECODER_FUNCTIONS(SNES_SPC, DECODER_FORMAT_SPC, NULL, NULL, Decoder_SNES_SPC_SetLoop, NULL, NULL, NULL),
 #endif
 #ifdef CLOWNAUDIO_OSWRAPPER_AUDIO
-	DECODER_FUNCTIONS(OSWrapper),
+	DECODER_FUNCTIONS(OSWrapper, DECODER_FORMAT_UNKNOWN, NULL, NULL, NULL, NULL, NULL, NULL),
 #endif
 };
 
 static const DecoderFunctions predecoder_functions = {
+	DECODER_FORMAT_UNKNOWN,
+	"Predecoder",
+	NULL,
+	NULL,
 	NULL,
 	Predecoder_Destroy,
 	Predecoder_Rewind,
-	Predecoder_GetSamples
+	Predecoder_GetSamples,
+	NULL,
+	NULL,
+	NULL,
+	NULL
 };
 
-DecoderSelectorData* DecoderSelector_LoadData(const unsigned char *file_buffer, size_t file_size, bool predecode, bool must_predecode, const DecoderSpec *wanted_spec)
+// What the predecoder needs to create more decoders for a file, so that it can decode several parts of it at once
+typedef struct SegmentSource
+{
+	const DecoderFunctions *decoder_functions;
+	const unsigned char *file_buffer;
+	size_t file_size;
+	IOSource *io_source;
+	const DecoderSpec *wanted_spec;
+} SegmentSource;
+
+static bool MatchBytes(const unsigned char *file_buffer, size_t file_size, size_t offset, const char *bytes)
+{
+	const size_t length = strlen(bytes);
+
+	return file_size >= offset + length && memcmp(&file_buffer[offset], bytes, length) == 0;
+}
+
+static bool MatchExtension(const char *extension, const char *wanted_extension)
+{
+	// Case-insensitive, without relying on the non-standard `strcasecmp`
+	for (;;)
+	{
+		const char character = *extension >= 'A' && *extension <= 'Z' ? *extension - 'A' + 'a' : *extension;
+
+		if (character != *wanted_extension)
+			return false;
+
+		if (character == '\0')
+			return true;
+
+		++extension;
+		++wanted_extension;
+	}
+}
+
+static DecoderFormat IdentifyFormatFromSignature(const unsigned char *file_buffer, size_t file_size)
+{
+	static const char *module_signatures[] = {"M.K.", "M!K!", "M&K!", "FLT4", "FLT8", "4CHN", "6CHN", "8CHN"};
+
+	// Skip any ID3v2 tag, since it can be stuck onto the front of both MP3 and FLAC files
+	if (MatchBytes(file_buffer, file_size, 0, "ID3") && file_size >= 10)
+	{
+		const size_t tag_size = 10 + (((size_t)file_buffer[6] & 0x7F) << 21 | ((size_t)file_buffer[7] & 0x7F) << 14 | ((size_t)file_buffer[8] & 0x7F) << 7 | ((size_t)file_buffer[9] & 0x7F));
+
+		if (tag_size < file_size && MatchBytes(file_buffer, file_size, tag_size, "fLaC"))
+			return DECODER_FORMAT_FLAC;
+
+		return DECODER_FORMAT_MP3;
+	}
+
+	if (MatchBytes(file_buffer, file_size, 0, "OggS") && file_size >= 27)
+	{
+		// The first packet follows the page's segment table, and starts with the codec's identification header
+		const size_t packet_offset = 27 + file_buffer[26];
+
+		if (MatchBytes(file_buffer, file_size, packet_offset, "\x01vorbis"))
+			return DECODER_FORMAT_VORBIS;
+
+		if (MatchBytes(file_buffer, file_size, packet_offset, "OpusHead"))
+			return DECODER_FORMAT_OPUS;
+
+		if (MatchBytes(file_buffer, file_size, packet_offset, "\x7F" "FLAC"))
+			return DECODER_FORMAT_FLAC;
+
+		return DECODER_FORMAT_UNKNOWN;
+	}
+
+	if (MatchBytes(file_buffer, file_size, 0, "fLaC"))
+		return DECODER_FORMAT_FLAC;
+
+	if ((MatchBytes(file_buffer, file_size, 0, "RIFF") && MatchBytes(file_buffer, file_size, 8, "WAVE")) || MatchBytes(file_buffer, file_size, 0, "RF64") || MatchBytes(file_buffer, file_size, 0, "riff\x2E\x91\xCF\x11"))
+		return DECODER_FORMAT_WAV;
+
+	if (MatchBytes(file_buffer, file_size, 0, "PTCOLLAGE-") || MatchBytes(file_buffer, file_size, 0, "PTTUNE--"))
+		return DECODER_FORMAT_PXTONE;
+
+	if (MatchBytes(file_buffer, file_size, 0, "PTNOISE-"))
+		return DECODER_FORMAT_PXTONE_NOISE;
+
+	if (MatchBytes(file_buffer, file_size, 0, "SNES-SPC700 Sound File Data"))
+		return DECODER_FORMAT_SPC;
+
+	if (MatchBytes(file_buffer, file_size, 0, "Extended Module: ") || MatchBytes(file_buffer, file_size, 0, "IMPM") || MatchBytes(file_buffer, file_size, 44, "SCRM"))
+		return DECODER_FORMAT_MODULE;
+
+	for (size_t i = 0; i < COUNT_OF(module_signatures); ++i)
+		if (MatchBytes(file_buffer, file_size, 1080, module_signatures[i]))
+			return DECODER_FORMAT_MODULE;
+
+	// MPEG audio frame sync, which is the weakest signature of the lot, so it goes last
+	if (file_size >= 2 && file_buffer[0] == 0xFF && (file_buffer[1] & 0xE0) == 0xE0 && (file_buffer[1] & 6) != 0)
+		return DECODER_FORMAT_MP3;
+
+	return DECODER_FORMAT_UNKNOWN;
+}
+
+static DecoderFormat IdentifyFormatFromFilename(const char *filename)
+{
+	static const struct
+	{
+		const char *extension;
+		DecoderFormat format;
+	} extensions[] = {
+		{"ogg", DECODER_FORMAT_VORBIS},
+		{"mp3", DECODER_FORMAT_MP3},
+		{"opus", DECODER_FORMAT_OPUS},
+		{"flac", DECODER_FORMAT_FLAC},
+		{"wav", DECODER_FORMAT_WAV},
+		{"mod", DECODER_FORMAT_MODULE},
+		{"xm", DECODER_FORMAT_MODULE},
+		{"s3m", DECODER_FORMAT_MODULE},
+		{"it", DECODER_FORMAT_MODULE},
+		{"mptm", DECODER_FORMAT_MODULE},
+		{"ptcop", DECODER_FORMAT_PXTONE},
+		{"pttune", DECODER_FORMAT_PXTONE},
+		{"ptnoise", DECODER_FORMAT_PXTONE_NOISE},
+		{"spc", DECODER_FORMAT_SPC}
+	};
+
+	if (filename != NULL)
+	{
+		const char *extension = strrchr(filename, '.');
+
+		if (extension != NULL && strchr(extension, '/') == NULL && strchr(extension, '\\') == NULL)
+			for (size_t i = 0; i < COUNT_OF(extensions); ++i)
+				if (MatchExtension(extension + 1, extensions[i].extension))
+					return extensions[i].format;
+	}
+
+	return DECODER_FORMAT_UNKNOWN;
+}
+
+// Lets the predecoder use a bare decoder as a stage
+typedef struct DecoderAdapter
+{
+	const DecoderFunctions *functions;
+	void *decoder;
+} DecoderAdapter;
+
+static void DecoderAdapter_Destroy(void *adapter_void)
+{
+	DecoderAdapter *adapter = (DecoderAdapter*)adapter_void;
+
+	adapter->functions->Destroy(adapter->decoder);
+	free(adapter);
+}
+
+static void DecoderAdapter_Rewind(void *adapter_void)
+{
+	DecoderAdapter *adapter = (DecoderAdapter*)adapter_void;
+
+	adapter->functions->Rewind(adapter->decoder);
+}
+
+static size_t DecoderAdapter_GetSamples(void *adapter_void, short *buffer, size_t frames_to_do, short *scratch)
+{
+	(void)scratch;
+
+	DecoderAdapter *adapter = (DecoderAdapter*)adapter_void;
+
+	return adapter->functions->GetSamples(adapter->decoder, buffer, frames_to_do);
+}
+
+static size_t DecoderAdapter_GetLength(void *adapter_void)
+{
+	DecoderAdapter *adapter = (DecoderAdapter*)adapter_void;
+
+	return adapter->functions->GetLength(adapter->decoder);
+}
+
+// The stage takes ownership of `decoder` on success
+static bool CreateAdapterStage(const DecoderFunctions *functions, void *decoder, DecoderStage *stage)
+{
+	DecoderAdapter *adapter = (DecoderAdapter*)malloc(sizeof(DecoderAdapter));
+
+	if (adapter == NULL)
+		return false;
+
+	adapter->functions = functions;
+	adapter->decoder = decoder;
+
+	stage->decoder = adapter;
+	stage->Destroy = DecoderAdapter_Destroy;
+	stage->Rewind = DecoderAdapter_Rewind;
+	stage->GetSamples = DecoderAdapter_GetSamples;
+	stage->SetLoop = NULL;
+	stage->ReadDirect = NULL;
+
+	return true;
+}
+
+// Called by the predecoder when it splits a file into segments
+static bool CreateSegmentStage(void *user_data, size_t frame, DecoderStage *stage)
+{
+	const SegmentSource *source = (const SegmentSource*)user_data;
+	const DecoderFunctions *functions = source->decoder_functions;
+
+	DecoderSpec spec;
+	void *decoder;
+
+	if (source->io_source != NULL && functions->CreateFromIO != NULL)
+		decoder = functions->CreateFromIO(source->io_source, false, source->wanted_spec, &spec);
+	else
+		decoder = functions->Create(source->file_buffer, source->file_size, false, source->wanted_spec, &spec);
+
+	if (decoder != NULL)
+	{
+		if (functions->Seek(decoder, frame) && CreateAdapterStage(functions, decoder, stage))
+			return true;
+
+		functions->Destroy(decoder);
+	}
+
+	return false;
+}
+
+// Throws away loop points that do not fit in the file. `total_frames` is 0 if the length of the file is unknown.
+static void ValidateLoopPoints(LoopPoints *loop_points, size_t total_frames)
+{
+	if (loop_points->length > (size_t)-1 - loop_points->start)
+	{
+		LoopPoints_Init(loop_points);
+	}
+	else if (total_frames != 0)
+	{
+		if (loop_points->start >= total_frames)
+			LoopPoints_Init(loop_points);
+		else if (loop_points->start + loop_points->length > total_frames)
+			loop_points->length = total_frames - loop_points->start;	// Some tools put the end one frame too late
+	}
+}
+
+// Reads the whole of an `IOSource` into memory, for decoders that cannot stream
+static unsigned char* ReadIOSource(IOSource *io_source, size_t *size)
+{
+	IOStream io_stream;
+	IOStream_CreateFromSource(&io_stream, io_source);
+
+	*size = IOStream_GetSize(&io_stream);
+
+	unsigned char *buffer = *size != 0 ? (unsigned char*)malloc(*size) : NULL;
+
+	if (buffer != NULL && IOStream_Read(&io_stream, buffer, 1, *size) != *size)
+	{
+		free(buffer);
+		buffer = NULL;
+	}
+
+	return buffer;
+}
+
+// Hashes the whole of an `IOSource`, a piece at a time
+static void HashIOSource(PredecodeCacheKey *key, IOSource *io_source)
+{
+	IOStream io_stream;
+	IOStream_CreateFromSource(&io_stream, io_source);
+
+	unsigned char buffer[0x1000];
+	size_t size;
+
+	while ((size = IOStream_Read(&io_stream, buffer, 1, sizeof(buffer))) != 0)
+		PredecodeCache_HashData(key, buffer, size);
+}
+
+DecoderSelectorData* DecoderSelector_LoadData(const unsigned char *file_buffer, size_t file_size, IOSource *io_source, const char *filename, bool predecode, bool must_predecode, const char *predecode_cache_directory, const DecoderSpec *wanted_spec)
 {
 	DecoderType decoder_type;
 	const DecoderFunctions *decoder_functions = NULL;
+	void *prototype = NULL;
+	void *spare = NULL;
 	PredecoderData *predecoder_data = NULL;
+	unsigned char *io_source_buffer = NULL;
 
 	DecoderSpec spec;
 
-	// Figure out what format this sound is
-	for (size_t i = 0; i < sizeof(decoder_function_list) / sizeof(decoder_function_list[0]); ++i)
+	LoopPoints loop_points;
+	LoopPoints_Init(&loop_points);
+
+	// Only the start of a streamed file is needed to identify its format
+	unsigned char header_buffer[0x1000];
+	const unsigned char *header = file_buffer;
+	size_t header_size = file_size;
+
+	if (io_source != NULL)
+	{
+		IOStream io_stream;
+		IOStream_CreateFromSource(&io_stream, io_source);
+
+		header = header_buffer;
+		header_size = IOStream_Read(&io_stream, header_buffer, 1, sizeof(header_buffer));
+	}
+
+	// Figure out what format this sound is. Trying to create every decoder in turn is slow, so first
+	// guess the format from the file's header (or its extension if that fails), and try the decoders
+	// for that format first. The rest are still tried afterwards, in case the guess was wrong.
+	DecoderFormat format = IdentifyFormatFromSignature(header, header_size);
+
+	if (format == DECODER_FORMAT_UNKNOWN)
+		format = IdentifyFormatFromFilename(filename);
+
+	size_t decoder_order[COUNT_OF(decoder_function_list)];
+	size_t total_decoders = 0;
+
+	if (format != DECODER_FORMAT_UNKNOWN)
+		for (size_t i = 0; i < COUNT_OF(decoder_function_list); ++i)
+			if (decoder_function_list[i].format == format)
+				decoder_order[total_decoders++] = i;
+
+	for (size_t i = 0; i < COUNT_OF(decoder_function_list); ++i)
+		if (format == DECODER_FORMAT_UNKNOWN || decoder_function_list[i].format != format)
+			decoder_order[total_decoders++] = i;
+
+	// If this file has been predecoded before, then there may be no need to decode it at all.
+	// Unless it turns out to be unusable, the first decoder to be tried is the one that will decode the file, so the entry is looked up under its name.
+	PredecodeCacheKey cache_key;
+	const DecoderFunctions *cache_decoder_functions = total_decoders != 0 ? &decoder_function_list[decoder_order[0]] : NULL;
+	const bool use_cache = predecode_cache_directory != NULL && (predecode || must_predecode) && cache_decoder_functions != NULL;
+
+	if (use_cache)
 	{
-		void *decoder = decoder_function_list[i].Create(file_buffer, file_size, false, wanted_spec, &spec);
+		PredecodeCache_InitKey(&cache_key, wanted_spec, cache_decoder_functions->name);
+
+		if (io_source != NULL)
+			HashIOSource(&cache_key, io_source);
+		else
+			PredecodeCache_HashData(&cache_key, file_buffer, file_size);
+
+		predecoder_data = PredecodeCache_Load(predecode_cache_directory, &cache_key);
+
+		if (predecoder_data != NULL)
+		{
+			decoder_type = DECODER_TYPE_PREDECODER;
+			decoder_functions = &predecoder_functions;
+			spec = *wanted_spec;
+		}
+	}
+
+	for (size_t i = 0; i < total_decoders && predecoder_data == NULL; ++i)
+	{
+		const DecoderFunctions *functions = &decoder_function_list[decoder_order[i]];
+
+		void *decoder = NULL;
+
+		if (io_source != NULL && functions->CreateFromIO != NULL)
+		{
+			decoder = functions->CreateFromIO(io_source, false, wanted_spec, &spec);
+		}
+		else
+		{
+			// This decoder needs the whole file in memory
+			if (io_source != NULL && io_source_buffer == NULL)
+			{
+				io_source_buffer = ReadIOSource(io_source, &file_size);
+				file_buffer = io_source_buffer;
+			}
+
+			if (file_buffer != NULL)
+				decoder = functions->Create(file_buffer, file_size, false, wanted_spec, &spec);
+		}
 
 		if (decoder != NULL)
 		{
 			decoder_type = spec.is_complex ? DECODER_TYPE_COMPLEX : DECODER_TYPE_SIMPLE;
-			decoder_functions = &decoder_function_list[i];
+			decoder_functions = functions;
+
+			// Complex decoders do their own looping, so they have no use for loop points
+			if (decoder_type == DECODER_TYPE_SIMPLE && functions->GetLoopPoints != NULL)
+			{
+				functions->GetLoopPoints(decoder, &loop_points);
+				ValidateLoopPoints(&loop_points, functions->GetLength != NULL ? functions->GetLength(decoder) : 0);
+			}
 
 			DecoderStage stage;
-			stage.decoder = decoder;
-			stage.Destroy = decoder_functions->Destroy;
-			stage.Rewind = decoder_functions->Rewind;
-			stage.GetSamples = decoder_functions->GetSamples;
-			stage.SetLoop = NULL;
 
-			if (decoder_type == DECODER_TYPE_SIMPLE && (predecode || must_predecode))
+			if (decoder_type == DECODER_TYPE_SIMPLE && (predecode || must_predecode) && CreateAdapterStage(functions, decoder, &stage))
 			{
-				predecoder_data = Predecoder_DecodeData(&spec, wanted_spec, &stage);
+				SegmentSource segment_source;
+				segment_source.decoder_functions = functions;
+				segment_source.file_buffer = file_buffer;
+				segment_source.file_size = file_size;
+				segment_source.io_source = io_source;
+				segment_source.wanted_spec = wanted_spec;
+
+				PredecoderSegmenter segmenter;
+				segmenter.user_data = &segment_source;
+				segmenter.GetLength = DecoderAdapter_GetLength;
+				segmenter.CreateStage = CreateSegmentStage;
+
+				predecoder_data = Predecoder_DecodeData(&spec, wanted_spec, &stage, functions->Seek != NULL && functions->GetLength != NULL ? &segmenter : NULL);
 
 				if (predecoder_data != NULL)
 				{
+					Predecoder_SetLoopPoints(predecoder_data, &loop_points, spec.sample_rate);
+
+					// If a different decoder had to be used, then the entry would be under the wrong name, and never be found
+					if (use_cache && functions == cache_decoder_functions)
+						PredecodeCache_Save(predecode_cache_directory, &cache_key, predecoder_data);
+
 					decoder_type = DECODER_TYPE_PREDECODER;
 					decoder_functions = &predecoder_functions;
 					break;
 				}
+
+				// The decoder was left alone, so only the adapter needs to go
+				free(stage.decoder);
 			}
 
-			decoder_function_list[i].Destroy(decoder);
+			// Hold onto the decoder, so that creating sounds does not have to parse the file all over again.
+			// If it can be cloned, then it can be used by every sound. Otherwise, only the first sound can have it.
+			if (functions->Clone != NULL)
+				prototype = decoder;
+			else
+				spare = decoder;
 
 			break;
 		}
 	}
 
+	// Don't keep the file in memory if nothing is going to use it
+	if (io_source_buffer != NULL && (decoder_type == DECODER_TYPE_PREDECODER || decoder_functions == NULL || decoder_functions->CreateFromIO != NULL))
+	{
+		free(io_source_buffer);
+		io_source_buffer = NULL;
+	}
+
 	if (decoder_functions != NULL && (!must_predecode || decoder_type == DECODER_TYPE_PREDECODER))
 	{
 		DecoderSelectorData *data = (DecoderSelectorData*)malloc(sizeof(DecoderSelectorData));
 
 		if (data != NULL)
 		{
-			data->file_buffer = file_buffer;
+			// Predecoded data never reads the file again, so it is not held onto, and the caller is free to release it
+			const bool needs_file = decoder_type != DECODER_TYPE_PREDECODER;
+
+			data->file_buffer = !needs_file ? NULL : io_source != NULL ? io_source_buffer : file_buffer;
 			data->file_size = file_size;
+			data->io_source = needs_file ? io_source : NULL;
+			data->io_source_buffer = io_source_buffer;
 			data->decoder_type = decoder_type;
 			data->decoder_functions = decoder_functions;
+			data->prototype = prototype;
+			data->spare = spare;
+			data->spare_spec = spec;
+			data->spare_wanted_sample_rate = wanted_spec->sample_rate;
 			data->predecoder_data = predecoder_data;
 			data->channel_count = spec.channel_count;
+			data->loop_points = loop_points;
+
+			// Without seeking, the only place that a simple decoder can loop back to is the start of the file
+			if (decoder_type == DECODER_TYPE_SIMPLE && decoder_functions->Seek == NULL)
+				LoopPoints_Init(&data->loop_points);
 
 			return data;
 		}
 	}
 
+	if (prototype != NULL)
+		decoder_functions->Destroy(prototype);
+
+	if (spare != NULL)
+		decoder_functions->Destroy(spare);
+
 	if (predecoder_data != NULL)
 		Predecoder_UnloadData(predecoder_data);
 
+	free(io_source_buffer);
+
 	return NULL;
 }
 
+bool DecoderSelector_NeedsFile(const DecoderSelectorData *data)
+{
+	return data->decoder_type != DECODER_TYPE_PREDECODER;
+}
+
+bool DecoderSelector_IsStreamed(const DecoderSelectorData *data)
+{
+	return data->io_source != NULL && data->decoder_functions->CreateFromIO != NULL;
+}
+
 void DecoderSelector_UnloadData(DecoderSelectorData *data)
 {
+	if (data->prototype != NULL)
+		data->decoder_functions->Destroy(data->prototype);
+
+	if (data->spare != NULL)
+		data->decoder_functions->Destroy(data->spare);
+
 	if (data->predecoder_data != NULL)
 		Predecoder_UnloadData(data->predecoder_data);
 
+	free(data->io_source_buffer);
 	free(data);
 }
 
-void* DecoderSelector_Create(DecoderSelectorData *data, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+// Returns true if a decoder made for the sound would be interchangeable with the spare
+static bool SuitsSpare(const DecoderSelectorData *data, bool loop, const DecoderSpec *wanted_spec)
 {
-	DecoderSelector *selector = (DecoderSelector*)malloc(sizeof(DecoderSelector));
+	if (data->decoder_type == DECODER_TYPE_PREDECODER || data->prototype != NULL || wanted_spec->sample_rate != data->spare_wanted_sample_rate)
+		return false;
+
+	// The spare was created without looping, and complex decoders do their own looping
+	if (data->decoder_type == DECODER_TYPE_COMPLEX && loop && data->decoder_functions->SetLoop == NULL)
+		return false;
+
+	return true;
+}
+
+// Returns the decoder that was left over from loading the data (or from an earlier sound), if there is one and it suits the sound
+static void* TakeSpare(DecoderSelectorData *data, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+{
+	void *spare = Atomic_LoadPointer(&data->spare);
+
+	if (spare == NULL || !SuitsSpare(data, loop, wanted_spec))
+		return NULL;
+
+	// Another sound may have beaten us to it
+	if (!Atomic_CompareExchangePointer(&data->spare, spare, NULL))
+		return NULL;
+
+	if (data->decoder_type == DECODER_TYPE_COMPLEX && loop)
+		data->decoder_functions->SetLoop(spare, loop);
+
+	*spec = data->spare_spec;
+
+	return spare;
+}
+
+void* DecoderSelector_Create(DecoderSelectorData *data, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec, Pool *pool)
+{
+	DecoderSelector *selector = (DecoderSelector*)Pool_Alloc(pool, sizeof(DecoderSelector));
 
 	if (selector != NULL)
 	{
+		selector->decoder = NULL;
+
 		if (data->decoder_type == DECODER_TYPE_PREDECODER)
-			selector->decoder = Predecoder_Create(data->predecoder_data, loop, wanted_spec, spec);
+			selector->decoder = Predecoder_Create(data->predecoder_data, loop, wanted_spec, spec, pool);
+		else if (data->prototype != NULL)
+			selector->decoder = data->decoder_functions->Clone(data->prototype, loop, wanted_spec, spec);
 		else
-			selector->decoder = data->decoder_functions->Create(data->file_buffer, data->file_size, loop, wanted_spec, spec);
+			selector->decoder = TakeSpare(data, loop, wanted_spec, spec);
+
+		// Cloning can fail if the sound wants something the prototype can't give it, like a different sample rate
+		if (selector->decoder == NULL && data->decoder_type != DECODER_TYPE_PREDECODER)
+		{
+			if (data->io_source != NULL && data->decoder_functions->CreateFromIO != NULL)
+				selector->decoder = data->decoder_functions->CreateFromIO(data->io_source, loop, wanted_spec, spec);
+			else
+				selector->decoder = data->decoder_functions->Create(data->file_buffer, data->file_size, loop, wanted_spec, spec);
+		}
 
 		if (selector->decoder != NULL)
 		{
 			selector->data = data;
 			selector->loop = loop;
+			selector->recyclable = SuitsSpare(data, loop, wanted_spec);
+			selector->position = 0;
 			return selector;
 		}
 
-		free(selector);
+		Pool_Free(selector);
 	}
 
 	return NULL;
@@ -261,9 +795,26 @@ void* DecoderSelector_Create(DecoderSelectorData *data, bool loop, const Decoder
 void DecoderSelector_Destroy(void *selector_void)
 {
 	DecoderSelector *selector = (DecoderSelector*)selector_void;
+	DecoderSelectorData *data = selector->data;
+
+	// Decoders that cannot be cloned are expensive to make (modules have to be parsed all over again), so rather than
+	// destroy this one, put it back to how the spare was made, so that the next sound can have it instead
+	bool recycled = false;
+
+	if (selector->recyclable && Atomic_LoadPointer(&data->spare) == NULL)
+	{
+		data->decoder_functions->Rewind(selector->decoder);
+
+		if (data->decoder_type == DECODER_TYPE_COMPLEX && selector->loop)
+			data->decoder_functions->SetLoop(selector->decoder, false);
+
+		recycled = Atomic_CompareExchangePointer(&data->spare, NULL, selector->decoder);
+	}
 
-	selector->data->decoder_functions->Destroy(selector->decoder);
-	free(selector);
+	if (!recycled)
+		data->decoder_functions->Destroy(selector->decoder);
+
+	Pool_Free(selector);
 }
 
 void DecoderSelector_Rewind(void *selector_void)
@@ -271,10 +822,24 @@ void DecoderSelector_Rewind(void *selector_void)
 	DecoderSelector *selector = (DecoderSelector*)selector_void;
 
 	selector->data->decoder_functions->Rewind(selector->decoder);
+	selector->position = 0;
+}
+
+// Goes back to where the loop starts, which is the start of the file unless its metadata says otherwise
+static void Loop(DecoderSelector *selector)
+{
+	const DecoderSelectorData *data = selector->data;
+
+	if (data->loop_points.start != 0 && data->decoder_functions->Seek(selector->decoder, data->loop_points.start))
+		selector->position = data->loop_points.start;
+	else
+		DecoderSelector_Rewind(selector);
 }
 
-size_t DecoderSelector_GetSamples(void *selector_void, short *buffer, size_t frames_to_do)
+size_t DecoderSelector_GetSamples(void *selector_void, short *buffer, size_t frames_to_do, short *scratch)
 {
+	(void)scratch;
+
 	DecoderSelector *selector = (DecoderSelector*)selector_void;
 
 	size_t frames_done = 0;
@@ -291,26 +856,48 @@ size_t DecoderSelector_GetSamples(void *selector_void, short *buffer, size_t fra
 			return selector->data->decoder_functions->GetSamples(selector->decoder, buffer, frames_to_do);
 
 		case DECODER_TYPE_SIMPLE:
+		{
 			// Handle looping here, since the simple decoders don't do it by themselves
+			const LoopPoints *loop_points = &selector->data->loop_points;
+			const size_t loop_end = loop_points->length != 0 ? loop_points->start + loop_points->length : (size_t)-1;
+
 			while (frames_done != frames_to_do)
 			{
-				const size_t frames = selector->data->decoder_functions->GetSamples(selector->decoder, &buffer[frames_done * selector->data->channel_count], frames_to_do - frames_done);
+				size_t frames_wanted = frames_to_do - frames_done;
 
-				if (frames == 0)
-				{
-					if (selector->loop)
-						selector->data->decoder_functions->Rewind(selector->decoder);
-					else
-						break;
-				}
+				// Stop at the end of the loop, unless it was passed while the sound was not looping
+				if (selector->loop && selector->position < loop_end)
+					frames_wanted = MIN(frames_wanted, loop_end - selector->position);
+
+				const size_t frames = selector->data->decoder_functions->GetSamples(selector->decoder, &buffer[frames_done * selector->data->channel_count], frames_wanted);
 
 				frames_done += frames;
+				selector->position += frames;
+
+				if (selector->loop && (frames == 0 || selector->position == loop_end))
+					Loop(selector);
+				else if (frames == 0)
+					break;
 			}
 
 			return frames_done;
+		}
 	}
 }
 
+// Predecoded data is already in memory, in the form that the mixer wants it
+bool DecoderSelector_CanReadDirect(const DecoderSelectorData *data)
+{
+	return data->decoder_type == DECODER_TYPE_PREDECODER;
+}
+
+size_t DecoderSelector_ReadDirect(void *selector_void, const short **buffer, size_t frames_to_do)
+{
+	DecoderSelector *selector = (DecoderSelector*)selector_void;
+
+	return Predecoder_ReadDirect(selector->decoder, buffer, frames_to_do);
+}
+
 void DecoderSelector_SetLoop(void *selector_void, bool loop)
 {
 	DecoderSelector *selector = (DecoderSelector*)selector_void;
@@ -326,7 +913,9 @@ void DecoderSelector_SetLoop(void *selector_void, bool loop)
 			break;
 
 		case DECODER_TYPE_COMPLEX:
-			// TODO - This is impossible to implement
+			if (selector->data->decoder_functions->SetLoop != NULL)
+				selector->data->decoder_functions->SetLoop(selector->decoder, loop);
+
 			break;
 	}
 }
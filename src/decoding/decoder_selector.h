@@ -25,15 +25,22 @@
 #include <stddef.h>
 
 #include "decoders/common.h"
+#include "decoders/io_stream.h"
+
+#include "../pool.h"
 
 typedef struct DecoderSelectorData DecoderSelectorData;
 
-DecoderSelectorData* DecoderSelector_LoadData(const unsigned char *data, size_t data_size, bool predecode, bool must_predecode, const DecoderSpec *wanted_spec);
+DecoderSelectorData* DecoderSelector_LoadData(const unsigned char *data, size_t data_size, IOSource *io_source, const char *filename, bool predecode, bool must_predecode, const char *predecode_cache_directory, const DecoderSpec *wanted_spec); // If `io_source` is not NULL, then the file is read from it instead. `filename` and `predecode_cache_directory` are optional.
+bool DecoderSelector_NeedsFile(const DecoderSelectorData *data); // Returns false if the file that the data was loaded from is no longer used, and can be freed
+bool DecoderSelector_IsStreamed(const DecoderSelectorData *data); // Returns true if the decoders read the file through its `IOSource` as they play, which may block
 void DecoderSelector_UnloadData(DecoderSelectorData *data);
-void* DecoderSelector_Create(DecoderSelectorData *data, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
+void* DecoderSelector_Create(DecoderSelectorData *data, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec, Pool *pool);
 void DecoderSelector_Destroy(void *selector);
 void DecoderSelector_Rewind(void *selector);
-size_t DecoderSelector_GetSamples(void *selector, short *buffer, size_t frames_to_do);
+size_t DecoderSelector_GetSamples(void *selector, short *buffer, size_t frames_to_do, short *scratch);
+bool DecoderSelector_CanReadDirect(const DecoderSelectorData *data);
+size_t DecoderSelector_ReadDirect(void *selector, const short **buffer, size_t frames_to_do); // Only usable if `DecoderSelector_CanReadDirect` returned true for the selector's data
 void DecoderSelector_SetLoop(void *selector, bool loop);
 
 #endif // DECODER_SELECTOR_H
@@ -31,14 +31,22 @@ typedef struct DecoderSpec
 	bool is_complex;
 } DecoderSpec;
 
+// How many samples of scratch space the caller of `DecoderStage::GetSamples` lends to the stage
+#define DECODER_SCRATCH_SIZE 0x400
+
 typedef struct DecoderStage
 {
 	void *decoder;
 
 	void (*Destroy)(void *decoder);
 	void (*Rewind)(void *decoder);
-	size_t (*GetSamples)(void *decoder, short *buffer, size_t frames_to_do);
+	// `scratch` belongs to the thread that is pulling the samples, and the stage may only use it until it returns.
+	// Only resamplers use it, and they are never chained, so stages that only ever sit beneath one are given NULL.
+	size_t (*GetSamples)(void *decoder, short *buffer, size_t frames_to_do, short *scratch);
 	void (*SetLoop)(void *decoder, bool loop);
+	// Optional: points `*buffer` at the stage's own samples, instead of copying them, and returns how many frames (up to
+	// `frames_to_do`) are there. Unlike `GetSamples`, returning fewer frames does not mean that the stage has ended - only 0 does.
+	size_t (*ReadDirect)(void *decoder, const short **buffer, size_t frames_to_do);
 } DecoderStage;
 
 #endif // COMMON_H
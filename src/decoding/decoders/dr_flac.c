@@ -22,6 +22,7 @@
 #include <stdbool.h>
 #endif
 #include <stddef.h>
+#include <stdlib.h>
 
 #define DR_FLAC_IMPLEMENTATION
 #define DR_FLAC_NO_STDIO
@@ -30,35 +31,142 @@
 #include "libs/dr_flac.h"
 
 #include "common.h"
+#include "io_stream.h"
+#include "loop_points.h"
+
+typedef struct Decoder_DR_FLAC
+{
+	drflac *backend;
+	IOStream io_stream;	// Only used when streaming
+	LoopPoints loop_points;
+} Decoder_DR_FLAC;
+
+// dr_flac passes the same user data to every callback, so these are given the whole decoder
+static size_t ReadCallback(void *user_data, void *output, size_t bytes_to_read)
+{
+	return IOStream_Read(&((Decoder_DR_FLAC*)user_data)->io_stream, output, 1, bytes_to_read);
+}
+
+static drflac_bool32 SeekCallback(void *user_data, int offset, drflac_seek_origin origin)
+{
+	return IOStream_SetPosition(&((Decoder_DR_FLAC*)user_data)->io_stream, offset, origin == drflac_seek_origin_start ? IOSTREAM_START : IOSTREAM_CURRENT);
+}
+
+// Loop points can either be in Vorbis comments, or in a WAV file's `smpl` chunk, which
+// `flac --keep-foreign-metadata` stores in 'riff' application blocks, one chunk per block
+static void MetadataCallback(void *user_data, drflac_metadata *metadata)
+{
+	LoopPoints *loop_points = &((Decoder_DR_FLAC*)user_data)->loop_points;
+
+	if (metadata->type == DRFLAC_METADATA_BLOCK_TYPE_VORBIS_COMMENT)
+	{
+		drflac_vorbis_comment_iterator iterator;
+		drflac_init_vorbis_comment_iterator(&iterator, metadata->data.vorbis_comment.commentCount, metadata->data.vorbis_comment.pComments);
+
+		const char *comment;
+		drflac_uint32 comment_length;
+
+		while ((comment = drflac_next_vorbis_comment(&iterator, &comment_length)) != NULL)
+			LoopPoints_ParseComment(loop_points, comment, comment_length);
+	}
+	else if (metadata->type == DRFLAC_METADATA_BLOCK_TYPE_APPLICATION && metadata->data.application.id == 0x72696666)	// 'riff'
+	{
+		const unsigned char *chunk = (const unsigned char*)metadata->data.application.pData;
+		const size_t chunk_size = metadata->data.application.dataSize;
+
+		if (chunk_size >= 8 && chunk[0] == 's' && chunk[1] == 'm' && chunk[2] == 'p' && chunk[3] == 'l')
+			LoopPoints_ParseSmplChunk(loop_points, &chunk[8], chunk_size - 8);
+	}
+}
+
+static void* CreateDecoder(const unsigned char *data, size_t data_size, IOSource *io_source, DecoderSpec *spec)
+{
+	Decoder_DR_FLAC *decoder = (Decoder_DR_FLAC*)malloc(sizeof(Decoder_DR_FLAC));
+
+	if (decoder != NULL)
+	{
+		LoopPoints_Init(&decoder->loop_points);
+
+		if (io_source != NULL)
+		{
+			IOStream_CreateFromSource(&decoder->io_stream, io_source);
+			decoder->backend = drflac_open_with_metadata(ReadCallback, SeekCallback, MetadataCallback, decoder, NULL);
+		}
+		else
+		{
+			decoder->backend = drflac_open_memory_with_metadata(data, data_size, MetadataCallback, decoder, NULL);
+		}
+
+		if (decoder->backend != NULL)
+		{
+			spec->sample_rate = decoder->backend->sampleRate;
+			spec->channel_count = decoder->backend->channels;
+			spec->is_complex = false;
+
+			return decoder;
+		}
+
+		free(decoder);
+	}
+
+	return NULL;
+}
 
 void* Decoder_DR_FLAC_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
 {
 	(void)loop;	// This is ignored in simple decoders
 	(void)wanted_spec;
 
-	drflac *backend = drflac_open_memory(data, data_size, NULL);
+	return CreateDecoder(data, data_size, NULL, spec);
+}
 
-	if (backend != NULL)
-	{
-		spec->sample_rate = backend->sampleRate;
-		spec->channel_count = backend->channels;
-		spec->is_complex = false;
-	}
+void* Decoder_DR_FLAC_CreateFromIO(IOSource *io_source, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+{
+	(void)loop;	// This is ignored in simple decoders
+	(void)wanted_spec;
 
-	return backend;
+	return CreateDecoder(NULL, 0, io_source, spec);
 }
 
-void Decoder_DR_FLAC_Destroy(void *decoder)
+void Decoder_DR_FLAC_Destroy(void *decoder_void)
 {
-	drflac_close((drflac*)decoder);
+	Decoder_DR_FLAC *decoder = (Decoder_DR_FLAC*)decoder_void;
+
+	drflac_close(decoder->backend);
+	free(decoder);
 }
 
-void Decoder_DR_FLAC_Rewind(void *decoder)
+void Decoder_DR_FLAC_Rewind(void *decoder_void)
 {
-	drflac_seek_to_pcm_frame((drflac*)decoder, 0);
+	Decoder_DR_FLAC *decoder = (Decoder_DR_FLAC*)decoder_void;
+
+	drflac_seek_to_pcm_frame(decoder->backend, 0);
 }
 
-size_t Decoder_DR_FLAC_GetSamples(void *decoder, short *buffer, size_t frames_to_do)
+size_t Decoder_DR_FLAC_GetSamples(void *decoder_void, short *buffer, size_t frames_to_do)
 {
-	return (size_t)drflac_read_pcm_frames_s16((drflac*)decoder, frames_to_do, buffer);
+	Decoder_DR_FLAC *decoder = (Decoder_DR_FLAC*)decoder_void;
+
+	return (size_t)drflac_read_pcm_frames_s16(decoder->backend, frames_to_do, buffer);
+}
+
+bool Decoder_DR_FLAC_Seek(void *decoder_void, size_t frame)
+{
+	Decoder_DR_FLAC *decoder = (Decoder_DR_FLAC*)decoder_void;
+
+	return drflac_seek_to_pcm_frame(decoder->backend, frame);
+}
+
+size_t Decoder_DR_FLAC_GetLength(void *decoder_void)
+{
+	Decoder_DR_FLAC *decoder = (Decoder_DR_FLAC*)decoder_void;
+
+	return (size_t)decoder->backend->totalPCMFrameCount;	// 0 if the header does not say
+}
+
+void Decoder_DR_FLAC_GetLoopPoints(void *decoder_void, LoopPoints *loop_points)
+{
+	Decoder_DR_FLAC *decoder = (Decoder_DR_FLAC*)decoder_void;
+
+	*loop_points = decoder->loop_points;
 }
@@ -25,10 +25,16 @@
 #include <stddef.h>
 
 #include "common.h"
+#include "io_stream.h"
+#include "loop_points.h"
 
 void* Decoder_DR_FLAC_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
+void* Decoder_DR_FLAC_CreateFromIO(IOSource *io_source, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
 void Decoder_DR_FLAC_Destroy(void *decoder);
 void Decoder_DR_FLAC_Rewind(void *decoder);
 size_t Decoder_DR_FLAC_GetSamples(void *decoder, short *buffer, size_t frames_to_do);
+bool Decoder_DR_FLAC_Seek(void *decoder, size_t frame);
+size_t Decoder_DR_FLAC_GetLength(void *decoder);
+void Decoder_DR_FLAC_GetLoopPoints(void *decoder, LoopPoints *loop_points);
 
 #endif // DECODER_DR_FLAC_H
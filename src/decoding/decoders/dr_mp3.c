@@ -31,6 +31,23 @@
 #include "libs/dr_mp3.h"
 
 #include "common.h"
+#include "io_stream.h"
+
+typedef struct StreamingDecoder
+{
+	drmp3 instance;	// Must be first, so that the other functions can treat this as a plain `drmp3`
+	IOStream io_stream;
+} StreamingDecoder;
+
+static size_t ReadCallback(void *user_data, void *output, size_t bytes_to_read)
+{
+	return IOStream_Read((IOStream*)user_data, output, 1, bytes_to_read);
+}
+
+static drmp3_bool32 SeekCallback(void *user_data, int offset, drmp3_seek_origin origin)
+{
+	return IOStream_SetPosition((IOStream*)user_data, offset, origin == drmp3_seek_origin_start ? IOSTREAM_START : IOSTREAM_CURRENT);
+}
 
 void* Decoder_DR_MP3_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
 {
@@ -59,6 +76,40 @@ void* Decoder_DR_MP3_Create(const unsigned char *data, size_t data_size, bool lo
 	return NULL;
 }
 
+void* Decoder_DR_MP3_CreateFromIO(IOSource *io_source, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+{
+	(void)loop;	// This is ignored in simple decoders
+	(void)wanted_spec;
+
+	StreamingDecoder *decoder = (StreamingDecoder*)malloc(sizeof(StreamingDecoder));
+
+	if (decoder != NULL)
+	{
+		IOStream_CreateFromSource(&decoder->io_stream, io_source);
+
+		// Same check as `Decoder_DR_MP3_Create`
+		unsigned char data[3];
+
+		if (IOStream_Read(&decoder->io_stream, data, 1, 3) == 3 && ((data[0] == 0xFF && data[1] == 0xFB) || (data[0] == 0x49 && data[1] == 0x44 && data[2] == 0x33)))
+		{
+			IOStream_SetPosition(&decoder->io_stream, 0, IOSTREAM_START);
+
+			if (drmp3_init(&decoder->instance, ReadCallback, SeekCallback, &decoder->io_stream, NULL))
+			{
+				spec->sample_rate = decoder->instance.sampleRate;
+				spec->channel_count = decoder->instance.channels;
+				spec->is_complex = false;
+
+				return decoder;
+			}
+		}
+
+		free(decoder);
+	}
+
+	return NULL;
+}
+
 void Decoder_DR_MP3_Destroy(void *decoder)
 {
 	drmp3 *instance = (drmp3*)decoder;
@@ -31,26 +31,96 @@
 #include "libs/dr_wav.h"
 
 #include "common.h"
+#include "io_stream.h"
+#include "loop_points.h"
+
+typedef struct Decoder_DR_WAV
+{
+	drwav instance;	// Must be first, so that the other functions can treat this as a plain `drwav`
+	IOStream io_stream;	// Only used when streaming
+	LoopPoints loop_points;
+} Decoder_DR_WAV;
+
+static size_t ReadCallback(void *user_data, void *output, size_t bytes_to_read)
+{
+	return IOStream_Read((IOStream*)user_data, output, 1, bytes_to_read);
+}
+
+static drwav_bool32 SeekCallback(void *user_data, int offset, drwav_seek_origin origin)
+{
+	return IOStream_SetPosition((IOStream*)user_data, offset, origin == drwav_seek_origin_start ? IOSTREAM_START : IOSTREAM_CURRENT);
+}
+
+// Called for every chunk in the file, so that the loop points can be picked out of the `smpl` chunk
+static drwav_uint64 ChunkCallback(void *user_data, drwav_read_proc read_callback, drwav_seek_proc seek_callback, void *read_seek_user_data, const drwav_chunk_header *chunk_header, drwav_container container, const drwav_fmt *format)
+{
+	(void)seek_callback;
+	(void)format;
+
+	if (container != drwav_container_riff && container != drwav_container_rf64)
+		return 0;
+
+	if (!drwav_fourcc_equal(chunk_header->id.fourcc, "smpl"))
+		return 0;
+
+	// Only the first few loops are looked at, which is plenty
+	unsigned char buffer[36 + 24 * 8];
+	const size_t bytes_to_read = chunk_header->sizeInBytes < sizeof(buffer) ? (size_t)chunk_header->sizeInBytes : sizeof(buffer);
+	const size_t bytes_read = read_callback(read_seek_user_data, buffer, bytes_to_read);
+
+	LoopPoints_ParseSmplChunk(&((Decoder_DR_WAV*)user_data)->loop_points, buffer, bytes_read);
+
+	return bytes_read;
+}
 
 void* Decoder_DR_WAV_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
 {
 	(void)loop;	// This is ignored in simple decoders
 	(void)wanted_spec;
 
-	drwav *instance = (drwav*)malloc(sizeof(drwav));
+	Decoder_DR_WAV *decoder = (Decoder_DR_WAV*)malloc(sizeof(Decoder_DR_WAV));
 
-	if (instance != NULL)
+	if (decoder != NULL)
 	{
-		if (drwav_init_memory(instance, data, data_size, NULL))
+		LoopPoints_Init(&decoder->loop_points);
+
+		if (drwav_init_memory_ex(&decoder->instance, data, data_size, ChunkCallback, decoder, 0, NULL))
 		{
-			spec->sample_rate = instance->sampleRate;
-			spec->channel_count = instance->channels;
+			spec->sample_rate = decoder->instance.sampleRate;
+			spec->channel_count = decoder->instance.channels;
 			spec->is_complex = false;
 
-			return instance;
+			return decoder;
 		}
 
-		free(instance);
+		free(decoder);
+	}
+
+	return NULL;
+}
+
+void* Decoder_DR_WAV_CreateFromIO(IOSource *io_source, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+{
+	(void)loop;	// This is ignored in simple decoders
+	(void)wanted_spec;
+
+	Decoder_DR_WAV *decoder = (Decoder_DR_WAV*)malloc(sizeof(Decoder_DR_WAV));
+
+	if (decoder != NULL)
+	{
+		IOStream_CreateFromSource(&decoder->io_stream, io_source);
+		LoopPoints_Init(&decoder->loop_points);
+
+		if (drwav_init_ex(&decoder->instance, ReadCallback, SeekCallback, ChunkCallback, &decoder->io_stream, decoder, 0, NULL))
+		{
+			spec->sample_rate = decoder->instance.sampleRate;
+			spec->channel_count = decoder->instance.channels;
+			spec->is_complex = false;
+
+			return decoder;
+		}
+
+		free(decoder);
 	}
 
 	return NULL;
@@ -73,3 +143,18 @@ size_t Decoder_DR_WAV_GetSamples(void *decoder, short *buffer, size_t frames_to_
 {
 	return (size_t)drwav_read_pcm_frames_s16((drwav*)decoder, frames_to_do, buffer);
 }
+
+bool Decoder_DR_WAV_Seek(void *decoder, size_t frame)
+{
+	return drwav_seek_to_pcm_frame((drwav*)decoder, frame);
+}
+
+size_t Decoder_DR_WAV_GetLength(void *decoder)
+{
+	return (size_t)((drwav*)decoder)->totalPCMFrameCount;
+}
+
+void Decoder_DR_WAV_GetLoopPoints(void *decoder, LoopPoints *loop_points)
+{
+	*loop_points = ((Decoder_DR_WAV*)decoder)->loop_points;
+}
@@ -25,10 +25,16 @@
 #include <stddef.h>
 
 #include "common.h"
+#include "io_stream.h"
+#include "loop_points.h"
 
 void* Decoder_DR_WAV_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
+void* Decoder_DR_WAV_CreateFromIO(IOSource *io_source, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
 void Decoder_DR_WAV_Destroy(void *decoder);
 void Decoder_DR_WAV_Rewind(void *decoder);
 size_t Decoder_DR_WAV_GetSamples(void *decoder, short *buffer, size_t frames_to_do);
+bool Decoder_DR_WAV_Seek(void *decoder, size_t frame);
+size_t Decoder_DR_WAV_GetLength(void *decoder);
+void Decoder_DR_WAV_GetLoopPoints(void *decoder, LoopPoints *loop_points);
 
 #endif // DECODER_DR_WAV_H
@@ -0,0 +1,176 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#include "io_stream.h"
+
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "clownaudio/mixer.h"
+
+#include "../../threading.h"
+
+struct IOSource
+{
+	ClownAudio_IO io;
+	Mutex *mutex;	// The callbacks only have one read position, so the streams have to take turns with it
+	size_t position;	// Where the callbacks are up to, so that they are only told to seek when they need to
+	size_t size;
+};
+
+IOSource* IOSource_Create(const ClownAudio_IO *io)
+{
+	IOSource *io_source = (IOSource*)malloc(sizeof(IOSource));
+
+	if (io_source != NULL)
+	{
+		io_source->mutex = Mutex_Create();
+
+		if (io_source->mutex != NULL)
+		{
+			io_source->io = *io;
+			io_source->position = io->tell(io->user_data);
+			io_source->size = io->size(io->user_data);
+
+			return io_source;
+		}
+
+		free(io_source);
+	}
+
+	return NULL;
+}
+
+void IOSource_Destroy(IOSource *io_source)
+{
+	Mutex_Destroy(io_source->mutex);
+	free(io_source);
+}
+
+void IOStream_CreateFromMemory(IOStream *io_stream, const unsigned char *buffer, size_t size)
+{
+	io_stream->io_source = NULL;
+	io_stream->buffer = buffer;
+	io_stream->size = size;
+	io_stream->position = 0;
+}
+
+void IOStream_CreateFromSource(IOStream *io_stream, IOSource *io_source)
+{
+	io_stream->io_source = io_source;
+	io_stream->buffer = NULL;
+	io_stream->size = io_source->size;
+	io_stream->position = 0;
+}
+
+size_t IOStream_Read(IOStream *io_stream, void *output, size_t size, size_t count)
+{
+	if (size == 0 || io_stream->position >= io_stream->size)
+		return 0;
+
+	const size_t count_remaining = (io_stream->size - io_stream->position) / size;
+	const size_t bytes_to_do = (count < count_remaining ? count : count_remaining) * size;
+
+	size_t bytes_done;
+
+	if (io_stream->io_source == NULL)
+	{
+		memcpy(output, &io_stream->buffer[io_stream->position], bytes_to_do);
+		bytes_done = bytes_to_do;
+	}
+	else
+	{
+		IOSource *io_source = io_stream->io_source;
+
+		Mutex_Lock(io_source->mutex);
+
+		bytes_done = 0;
+
+		if (io_source->position == io_stream->position || io_source->io.seek(io_source->io.user_data, io_stream->position))
+		{
+			// Callbacks are allowed to return less than was asked for, without it meaning that the end of the file has been reached
+			while (bytes_done != bytes_to_do)
+			{
+				const size_t bytes = io_source->io.read(io_source->io.user_data, (unsigned char*)output + bytes_done, bytes_to_do - bytes_done);
+
+				if (bytes == 0)
+					break;
+
+				bytes_done += bytes;
+			}
+
+			io_source->position = io_stream->position + bytes_done;
+		}
+		else
+		{
+			// Nobody knows where the callbacks are now
+			io_source->position = (size_t)-1;
+		}
+
+		Mutex_Unlock(io_source->mutex);
+	}
+
+	io_stream->position += bytes_done;
+
+	return bytes_done / size;
+}
+
+bool IOStream_SetPosition(IOStream *io_stream, ptrdiff_t offset, enum IOStream_Origin origin)
+{
+	size_t base;
+
+	switch (origin)
+	{
+		case IOSTREAM_START:
+			base = 0;
+			break;
+
+		case IOSTREAM_CURRENT:
+			base = io_stream->position;
+			break;
+
+		case IOSTREAM_END:
+			base = io_stream->size;
+			break;
+
+		default:
+			return false;
+	}
+
+	if (offset < 0 ? (size_t)-offset > base : (size_t)offset > io_stream->size - base)
+		return false;
+
+	io_stream->position = base + (size_t)offset;
+
+	return true;
+}
+
+size_t IOStream_GetPosition(IOStream *io_stream)
+{
+	return io_stream->position;
+}
+
+size_t IOStream_GetSize(IOStream *io_stream)
+{
+	return io_stream->size;
+}
@@ -0,0 +1,60 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#ifndef IO_STREAM_H
+#define IO_STREAM_H
+
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+#include <stddef.h>
+
+#include "clownaudio/mixer.h"
+
+// A file that is read through a set of `ClownAudio_IO` callbacks.
+// Every decoder of the file gets an `IOStream` of its own, and these can be read from any thread.
+typedef struct IOSource IOSource;
+
+IOSource* IOSource_Create(const ClownAudio_IO *io);
+void IOSource_Destroy(IOSource *io_source);
+
+enum IOStream_Origin
+{
+	IOSTREAM_START,
+	IOSTREAM_CURRENT,
+	IOSTREAM_END
+};
+
+// Lets decoders that read their files through callbacks work with both files in memory and files from an `IOSource`
+typedef struct IOStream
+{
+	IOSource *io_source;	// NULL if the file is in memory
+	const unsigned char *buffer;
+	size_t size;
+	size_t position;
+} IOStream;
+
+void IOStream_CreateFromMemory(IOStream *io_stream, const unsigned char *buffer, size_t size);
+void IOStream_CreateFromSource(IOStream *io_stream, IOSource *io_source);
+size_t IOStream_Read(IOStream *io_stream, void *output, size_t size, size_t count);
+bool IOStream_SetPosition(IOStream *io_stream, ptrdiff_t offset, enum IOStream_Origin origin); // Fails if the position would be outside of the file
+size_t IOStream_GetPosition(IOStream *io_stream);
+size_t IOStream_GetSize(IOStream *io_stream);
+
+#endif // IO_STREAM_H
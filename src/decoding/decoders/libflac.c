@@ -28,14 +28,14 @@
 #include <FLAC/stream_decoder.h>
 
 #include "common.h"
-#include "memory_stream.h"
+#include "io_stream.h"
 
 #undef MIN
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 
 typedef struct Decoder_libFLAC
 {
-	ROMemoryStream ro_memory_stream;
+	IOStream io_stream;
 	FLAC__StreamDecoder *flac_stream_decoder;
 	DecoderSpec *spec;
 
@@ -58,7 +58,7 @@ static FLAC__StreamDecoderReadStatus fread_wrapper(const FLAC__StreamDecoder *fl
 
 	FLAC__StreamDecoderReadStatus status = FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
 
-	*count = ROMemoryStream_Read(&decoder->ro_memory_stream, output, sizeof(FLAC__byte), *count);
+	*count = IOStream_Read(&decoder->io_stream, output, sizeof(FLAC__byte), *count);
 
 	if (*count == 0)
 		status = FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
@@ -72,7 +72,7 @@ static FLAC__StreamDecoderSeekStatus fseek_wrapper(const FLAC__StreamDecoder *fl
 
 	Decoder_libFLAC *decoder = (Decoder_libFLAC*)user;
 
-	return ROMemoryStream_SetPosition(&decoder->ro_memory_stream, offset, MEMORYSTREAM_START) ? FLAC__STREAM_DECODER_SEEK_STATUS_OK : FLAC__STREAM_DECODER_SEEK_STATUS_ERROR;
+	return IOStream_SetPosition(&decoder->io_stream, offset, IOSTREAM_START) ? FLAC__STREAM_DECODER_SEEK_STATUS_OK : FLAC__STREAM_DECODER_SEEK_STATUS_ERROR;
 }
 
 static FLAC__StreamDecoderTellStatus ftell_wrapper(const FLAC__StreamDecoder *flac_stream_decoder, FLAC__uint64 *offset, void *user)
@@ -81,7 +81,7 @@ static FLAC__StreamDecoderTellStatus ftell_wrapper(const FLAC__StreamDecoder *fl
 
 	Decoder_libFLAC *decoder = (Decoder_libFLAC*)user;
 
-	*offset = ROMemoryStream_GetPosition(&decoder->ro_memory_stream);
+	*offset = IOStream_GetPosition(&decoder->io_stream);
 
 	return FLAC__STREAM_DECODER_TELL_STATUS_OK;
 }
@@ -92,12 +92,7 @@ static FLAC__StreamDecoderLengthStatus GetSize(const FLAC__StreamDecoder *flac_s
 
 	Decoder_libFLAC *decoder = (Decoder_libFLAC*)user;
 
-	const size_t old_offset = ROMemoryStream_GetPosition(&decoder->ro_memory_stream);
-
-	ROMemoryStream_SetPosition(&decoder->ro_memory_stream, 0, MEMORYSTREAM_END);
-	*length = ROMemoryStream_GetPosition(&decoder->ro_memory_stream);
-
-	ROMemoryStream_SetPosition(&decoder->ro_memory_stream, old_offset, MEMORYSTREAM_START);
+	*length = IOStream_GetSize(&decoder->io_stream);
 
 	return FLAC__STREAM_DECODER_LENGTH_STATUS_OK;
 }
@@ -108,14 +103,7 @@ static FLAC__bool CheckEOF(const FLAC__StreamDecoder *flac_stream_decoder, void
 
 	Decoder_libFLAC *decoder = (Decoder_libFLAC*)user;
 
-	const size_t offset = ROMemoryStream_GetPosition(&decoder->ro_memory_stream);
-
-	ROMemoryStream_SetPosition(&decoder->ro_memory_stream, 0, MEMORYSTREAM_END);
-	const size_t size = ROMemoryStream_GetPosition(&decoder->ro_memory_stream);
-
-	ROMemoryStream_SetPosition(&decoder->ro_memory_stream, offset, MEMORYSTREAM_START);
-
-	return (offset == size);
+	return IOStream_GetPosition(&decoder->io_stream) >= IOStream_GetSize(&decoder->io_stream);
 }
 
 static FLAC__StreamDecoderWriteStatus WriteCallback(const FLAC__StreamDecoder *flac_stream_decoder, const FLAC__Frame *frame, const FLAC__int32* const buffer[], void *user)
@@ -175,11 +163,8 @@ static void ErrorCallback(const FLAC__StreamDecoder *flac_stream_decoder, FLAC__
 	decoder->error = true;
 }
 
-void* Decoder_libFLAC_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+static void* CreateDecoder(const IOStream *io_stream, DecoderSpec *spec)
 {
-	(void)loop;	// This is ignored in simple decoders
-	(void)wanted_spec;
-
 	Decoder_libFLAC *decoder = (Decoder_libFLAC*)malloc(sizeof(Decoder_libFLAC));
 
 	if (decoder != NULL)
@@ -188,7 +173,7 @@ void* Decoder_libFLAC_Create(const unsigned char *data, size_t data_size, bool l
 
 		if (decoder->flac_stream_decoder != NULL)
 		{
-			ROMemoryStream_Create(&decoder->ro_memory_stream, data, data_size);
+			decoder->io_stream = *io_stream;
 
 			if (FLAC__stream_decoder_init_stream(decoder->flac_stream_decoder, fread_wrapper, fseek_wrapper, ftell_wrapper, GetSize, CheckEOF, WriteCallback, MetadataCallback, ErrorCallback, decoder) == FLAC__STREAM_DECODER_INIT_STATUS_OK)
 			{
@@ -202,8 +187,6 @@ void* Decoder_libFLAC_Create(const unsigned char *data, size_t data_size, bool l
 				FLAC__stream_decoder_finish(decoder->flac_stream_decoder);
 			}
 
-			ROMemoryStream_Destroy(&decoder->ro_memory_stream);
-
 			FLAC__stream_decoder_delete(decoder->flac_stream_decoder);
 		}
 
@@ -213,13 +196,34 @@ void* Decoder_libFLAC_Create(const unsigned char *data, size_t data_size, bool l
 	return NULL;
 }
 
+void* Decoder_libFLAC_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+{
+	(void)loop;	// This is ignored in simple decoders
+	(void)wanted_spec;
+
+	IOStream io_stream;
+	IOStream_CreateFromMemory(&io_stream, data, data_size);
+
+	return CreateDecoder(&io_stream, spec);
+}
+
+void* Decoder_libFLAC_CreateFromIO(IOSource *io_source, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+{
+	(void)loop;	// This is ignored in simple decoders
+	(void)wanted_spec;
+
+	IOStream io_stream;
+	IOStream_CreateFromSource(&io_stream, io_source);
+
+	return CreateDecoder(&io_stream, spec);
+}
+
 void Decoder_libFLAC_Destroy(void *decoder_void)
 {
 	Decoder_libFLAC *decoder = (Decoder_libFLAC*)decoder_void;
 
 	FLAC__stream_decoder_finish(decoder->flac_stream_decoder);
 	FLAC__stream_decoder_delete(decoder->flac_stream_decoder);
-	ROMemoryStream_Destroy(&decoder->ro_memory_stream);
 	free(decoder->block_buffer);
 	free(decoder);
 }
@@ -251,3 +255,21 @@ size_t Decoder_libFLAC_GetSamples(void *decoder_void, short *buffer, size_t fram
 
 	return block_frames_to_do;
 }
+
+bool Decoder_libFLAC_Seek(void *decoder_void, size_t frame)
+{
+	Decoder_libFLAC *decoder = (Decoder_libFLAC*)decoder_void;
+
+	// The frame that the seek lands in is delivered to `WriteCallback`, starting at the requested sample
+	decoder->block_buffer_index = 0;
+	decoder->block_buffer_size = 0;
+
+	return FLAC__stream_decoder_seek_absolute(decoder->flac_stream_decoder, frame);
+}
+
+size_t Decoder_libFLAC_GetLength(void *decoder_void)
+{
+	Decoder_libFLAC *decoder = (Decoder_libFLAC*)decoder_void;
+
+	return (size_t)FLAC__stream_decoder_get_total_samples(decoder->flac_stream_decoder);	// 0 if the header does not say
+}
@@ -25,10 +25,14 @@
 #include <stddef.h>
 
 #include "common.h"
+#include "io_stream.h"
 
 void* Decoder_libFLAC_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
+void* Decoder_libFLAC_CreateFromIO(IOSource *io_source, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
 void Decoder_libFLAC_Destroy(void *decoder);
 void Decoder_libFLAC_Rewind(void *decoder);
 size_t Decoder_libFLAC_GetSamples(void *decoder, short *buffer, size_t frames_to_do);
+bool Decoder_libFLAC_Seek(void *decoder, size_t frame);
+size_t Decoder_libFLAC_GetLength(void *decoder);
 
 #endif // DECODER_LIBFLAC_H
@@ -101,3 +101,10 @@ size_t Decoder_libOpenMPT_GetSamples(void *decoder_void, short *buffer, size_t f
 
 	return frames_done;
 }
+
+void Decoder_libOpenMPT_SetLoop(void *decoder_void, bool loop)
+{
+	Decoder_libOpenMPT *decoder = (Decoder_libOpenMPT*)decoder_void;
+
+	openmpt_module_set_repeat_count(decoder->module, loop ? -1 : 0);
+}
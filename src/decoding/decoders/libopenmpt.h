@@ -30,5 +30,6 @@ void* Decoder_libOpenMPT_Create(const unsigned char *data, size_t data_size, boo
 void Decoder_libOpenMPT_Destroy(void *decoder);
 void Decoder_libOpenMPT_Rewind(void *decoder);
 size_t Decoder_libOpenMPT_GetSamples(void *decoder, short *buffer, size_t frames_to_do);
+void Decoder_libOpenMPT_SetLoop(void *decoder, bool loop);
 
 #endif // DECODER_LIBOPENMPT_H
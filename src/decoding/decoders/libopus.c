@@ -26,6 +26,7 @@
 #include <opus/opusfile.h>
 
 #include "common.h"
+#include "loop_points.h"
 
 void* Decoder_libOpus_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
 {
@@ -58,3 +59,18 @@ size_t Decoder_libOpus_GetSamples(void *decoder, short *buffer, size_t frames_to
 {
 	return op_read_stereo((OggOpusFile*)decoder, buffer, frames_to_do * 2);	// You tell *me* why that last parameter is in samples and not frames
 }
+
+bool Decoder_libOpus_Seek(void *decoder, size_t frame)
+{
+	return op_pcm_seek((OggOpusFile*)decoder, (ogg_int64_t)frame) == 0;
+}
+
+void Decoder_libOpus_GetLoopPoints(void *decoder, LoopPoints *loop_points)
+{
+	// Opus loop points are always at 48kHz, which is what libopusfile outputs
+	const OpusTags *tags = op_tags((OggOpusFile*)decoder, -1);
+
+	if (tags != NULL)
+		for (int i = 0; i < tags->comments; ++i)
+			LoopPoints_ParseComment(loop_points, tags->user_comments[i], (size_t)tags->comment_lengths[i]);
+}
@@ -25,10 +25,13 @@
 #include <stddef.h>
 
 #include "common.h"
+#include "loop_points.h"
 
 void* Decoder_libOpus_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
 void Decoder_libOpus_Destroy(void *decoder);
 void Decoder_libOpus_Rewind(void *decoder);
 size_t Decoder_libOpus_GetSamples(void *decoder, short *buffer, size_t frames_to_do);
+bool Decoder_libOpus_Seek(void *decoder, size_t frame);
+void Decoder_libOpus_GetLoopPoints(void *decoder, LoopPoints *loop_points);
 
 #endif // DECODER_LIBOPUS_H
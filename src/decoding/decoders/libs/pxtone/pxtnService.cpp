@@ -98,6 +98,8 @@ pxtnService::pxtnService()
 	_ovdrvs       = NULL; _ovdrv_max = _ovdrv_num = 0;
 	_woices       = NULL; _woice_max = _woice_num = 0;
 	_units        = NULL; _unit_max  = _unit_num  = 0;
+
+	_b_woices_borrowed = false;
 			     
 	_ptn_bldr     = NULL;
 
@@ -120,7 +122,7 @@ bool pxtnService::_release()
 	SAFE_DELETE( _ptn_bldr );
 	if( _delays ){ for( int32_t i = 0; i < _delay_num; i++ ) SAFE_DELETE( _delays[ i ] ); free( _delays ); _delays = NULL; }
 	if( _ovdrvs ){ for( int32_t i = 0; i < _ovdrv_num; i++ ) SAFE_DELETE( _ovdrvs[ i ] ); free( _ovdrvs ); _ovdrvs = NULL; }
-	if( _woices ){ for( int32_t i = 0; i < _woice_num; i++ ) SAFE_DELETE( _woices[ i ] ); free( _woices ); _woices = NULL; }
+	if( _woices ){ if( !_b_woices_borrowed ){ for( int32_t i = 0; i < _woice_num; i++ ) SAFE_DELETE( _woices[ i ] ); } free( _woices ); _woices = NULL; }
 	if( _units  ){ for( int32_t i = 0; i < _unit_num ; i++ ) SAFE_DELETE( _units [ i ] ); free( _units  ); _units  = NULL; }
 	return true;
 }
@@ -228,6 +230,34 @@ pxtnERR pxtnService::tones_ready()
 	return pxtnOK;
 }
 
+pxtnERR pxtnService::tones_ready_shared( const pxtnService *src )
+{
+	if( !_b_init || !src->_b_init ) return pxtnERR_INIT;
+	if( _woice_num != src->_woice_num || _dst_sps != src->_dst_sps ) return pxtnERR_param;
+
+	pxtnERR res        = pxtnERR_VOID;
+	int32_t beat_num   = master->get_beat_num  ();
+	float   beat_tempo = master->get_beat_tempo();
+
+	// delays and overdrives hold playback state, so each service still needs its own.
+	for( int32_t i = 0; i < _delay_num; i++ )
+	{
+		res = _delays[ i ]->Tone_Ready( beat_num, beat_tempo, _dst_sps );
+		if( res != pxtnOK ) return res;
+	}
+	for( int32_t i = 0; i < _ovdrv_num; i++ )
+	{
+		_ovdrvs[ i ]->Tone_Ready();
+	}
+	if( !_b_woices_borrowed )
+	{
+		for( int32_t i = 0; i < _woice_num; i++ ) SAFE_DELETE( _woices[ i ] );
+		_b_woices_borrowed = true;
+	}
+	for( int32_t i = 0; i < _woice_num; i++ ) _woices[ i ] = src->_woices[ i ];
+	return pxtnOK;
+}
+
 bool pxtnService::tones_clear()
 {
 	if( !_b_init ) return false;
@@ -365,6 +395,7 @@ pxtnERR pxtnService::Woice_read( int32_t idx, pxtnDescriptor* desc, pxtnWOICETYP
 	if( !_b_init ) return pxtnERR_INIT;
 	if( idx < 0 || idx >= _woice_max ) return pxtnERR_param;
 	if( idx > _woice_num             ) return pxtnERR_param;
+	if( _b_woices_borrowed           ) return pxtnERR_anti_opreation;
 	if( idx == _woice_num ){ _woices[ idx ] = new pxtnWoice(); _woice_num++; }
 
 	pxtnERR res = pxtnERR_VOID;
@@ -375,6 +406,7 @@ pxtnERR pxtnService::Woice_read( int32_t idx, pxtnDescriptor* desc, pxtnWOICETYP
 pxtnERR pxtnService::Woice_ReadyTone( int32_t idx )
 {
 	if( !_b_init ) return pxtnERR_INIT;
+	if( _b_woices_borrowed ) return pxtnERR_anti_opreation;
 	if( idx < 0 || idx >= _woice_num ) return pxtnERR_param;
 	return _woices[ idx ]->Tone_Ready( _ptn_bldr, _dst_sps );
 }
@@ -383,6 +415,7 @@ bool pxtnService::Woice_Remove( int32_t idx )
 {
 	if( !_b_init ) return false;
 	if( idx < 0 || idx >= _woice_num ) return false;
+	if( _b_woices_borrowed ) return false;
 	SAFE_DELETE( _woices[ idx ] );
 	_woice_num--;
 	for( int32_t i = idx; i < _woice_num; i++ ) _woices[ i ] = _woices[ i + 1 ];
@@ -575,6 +608,7 @@ bool pxtnService::clear()
 
 	for( int32_t i = 0; i < _delay_num; i++ ) SAFE_DELETE( _delays[ i ] ); _delay_num = 0;
 	for( int32_t i = 0; i < _delay_num; i++ ) SAFE_DELETE( _ovdrvs[ i ] ); _ovdrv_num = 0;
+	if( _b_woices_borrowed ){ for( int32_t i = 0; i < _woice_num; i++ ) _woices[ i ] = NULL; _b_woices_borrowed = false; }
 	for( int32_t i = 0; i < _woice_num; i++ ) SAFE_DELETE( _woices[ i ] ); _woice_num = 0;
 	for( int32_t i = 0; i < _unit_num ; i++ ) SAFE_DELETE( _units [ i ] ); _unit_num  = 0;
 
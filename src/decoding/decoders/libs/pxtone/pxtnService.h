@@ -70,6 +70,8 @@ private:
 
 	int32_t _group_num;
 
+	bool _b_woices_borrowed; // clownaudio: set by tones_ready_shared, so the woices are not freed twice
+
 	pxtnERR _ReadVersion      ( pxtnDescriptor *p_doc, _enum_FMTVER *p_fmt_ver, uint16_t *p_exe_ver );
 	pxtnERR _ReadTuneItems    ( pxtnDescriptor *p_doc );
 	bool    _x1x_Project_Read ( pxtnDescriptor *p_doc );
@@ -167,6 +169,9 @@ public :
 	int32_t get_last_error_id() const;
 
 	pxtnERR tones_ready();
+	// clownaudio: like tones_ready, but borrows the already-readied woices of a service that read the same
+	// data at the same quality, instead of building them again. 'src' must outlive this service.
+	pxtnERR tones_ready_shared( const pxtnService *src );
 	bool    tones_clear();
 
 	int32_t Group_Num () const;
@@ -9,6 +9,7 @@
 pxtoneNoise::pxtoneNoise()
 {
 	_bldr   = NULL ;
+	_b_bldr_borrowed = false;
 	_sps    = 44100;
 	_ch_num =     2;
 	_bps    =    16;
@@ -16,7 +17,7 @@ pxtoneNoise::pxtoneNoise()
 
 pxtoneNoise::~pxtoneNoise()
 {
-	if( _bldr ){delete (pxtnPulse_NoiseBuilder*)_bldr; _bldr = NULL; }
+	if( _bldr ){ if( !_b_bldr_borrowed ) delete (pxtnPulse_NoiseBuilder*)_bldr; _bldr = NULL; }
 }
 
 bool pxtoneNoise::init()
@@ -27,6 +28,15 @@ bool pxtoneNoise::init()
 	return true;
 }
 
+// uses src's builder instead of making another. src must outlive this.
+bool pxtoneNoise::init_shared( const pxtoneNoise *src )
+{
+	if( _bldr || !src->_bldr ) return false;
+	_bldr = src->_bldr;
+	_b_bldr_borrowed = true;
+	return true;
+}
+
 bool pxtoneNoise::quality_set( int32_t ch_num, int32_t sps, int32_t bps )
 {
 	switch( ch_num )
@@ -14,6 +14,7 @@ private:
 	pxtoneNoise     (const pxtoneNoise& src);
 
 	void *_bldr ;
+	bool _b_bldr_borrowed;
 	int32_t  _ch_num;
 	int32_t  _sps   ;
 	int32_t  _bps   ;
@@ -23,6 +24,7 @@ public:
 	~pxtoneNoise();
 
 	bool init       ();
+	bool init_shared( const pxtoneNoise *src );
 
 	bool quality_set( int32_t    ch_num, int32_t    sps, int32_t    bps );
 	void quality_get( int32_t *p_ch_num, int32_t *p_sps, int32_t *p_bps ) const;
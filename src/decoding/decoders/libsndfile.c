@@ -28,68 +28,58 @@
 #include <sndfile.h>
 
 #include "common.h"
-#include "memory_stream.h"
+#include "io_stream.h"
 
 typedef struct Decoder_libSndfile
 {
-	ROMemoryStream memory_stream;
+	IOStream io_stream;
 	SNDFILE *sndfile;
 } Decoder_libSndfile;
 
 static sf_count_t fread_wrapper(void *output, sf_count_t count, void *user)
 {
-	return ROMemoryStream_Read((ROMemoryStream*)user, output, 1, count);
+	return IOStream_Read((IOStream*)user, output, 1, count);
 }
 
 static sf_count_t fseek_wrapper(sf_count_t offset, int origin, void *user)
 {
-	enum MemoryStream_Origin memory_stream_origin;
+	enum IOStream_Origin io_stream_origin;
 	switch (origin)
 	{
 		case SF_SEEK_SET:
-			memory_stream_origin = MEMORYSTREAM_START;
+			io_stream_origin = IOSTREAM_START;
 			break;
 
 		case SF_SEEK_CUR:
-			memory_stream_origin = MEMORYSTREAM_CURRENT;
+			io_stream_origin = IOSTREAM_CURRENT;
 			break;
 
 		case SF_SEEK_END:
-			memory_stream_origin = MEMORYSTREAM_END;
+			io_stream_origin = IOSTREAM_END;
 			break;
 
 		default:
 			return -1;
 	}
 
-	if (!ROMemoryStream_SetPosition((ROMemoryStream*)user, offset, memory_stream_origin))
+	if (!IOStream_SetPosition((IOStream*)user, offset, io_stream_origin))
 		return -1;
 
-	return ROMemoryStream_GetPosition((ROMemoryStream*)user);
+	return IOStream_GetPosition((IOStream*)user);
 }
 
 static sf_count_t ftell_wrapper(void *user)
 {
-	return ROMemoryStream_GetPosition((ROMemoryStream*)user);
+	return IOStream_GetPosition((IOStream*)user);
 }
 
 static sf_count_t GetStreamSize(void *user)
 {
-	const sf_count_t old_offset = ftell_wrapper(user);
-
-	fseek_wrapper(0, SEEK_END, user);
-	const sf_count_t size = ftell_wrapper(user);
-
-	fseek_wrapper(old_offset, SEEK_SET, user);
-
-	return size;
+	return IOStream_GetSize((IOStream*)user);
 }
 
-void* Decoder_libSndfile_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+static void* CreateDecoder(const IOStream *io_stream, DecoderSpec *spec)
 {
-	(void)loop;	// This is ignored in simple decoders
-	(void)wanted_spec;
-
 	Decoder_libSndfile *decoder = (Decoder_libSndfile*)malloc(sizeof(Decoder_libSndfile));
 
 	if (decoder != NULL)
@@ -102,12 +92,12 @@ void* Decoder_libSndfile_Create(const unsigned char *data, size_t data_size, boo
 			ftell_wrapper
 		};
 
-		ROMemoryStream_Create(&decoder->memory_stream, data, data_size);
+		decoder->io_stream = *io_stream;
 
 		SF_INFO sf_info;
 		memset(&sf_info, 0, sizeof(SF_INFO));
 
-		SNDFILE *sndfile = sf_open_virtual(&sfvirtual, SFM_READ, &sf_info, &decoder->memory_stream);
+		SNDFILE *sndfile = sf_open_virtual(&sfvirtual, SFM_READ, &sf_info, &decoder->io_stream);
 
 		if (sndfile != NULL)
 		{
@@ -128,12 +118,33 @@ void* Decoder_libSndfile_Create(const unsigned char *data, size_t data_size, boo
 	return NULL;
 }
 
+void* Decoder_libSndfile_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+{
+	(void)loop;	// This is ignored in simple decoders
+	(void)wanted_spec;
+
+	IOStream io_stream;
+	IOStream_CreateFromMemory(&io_stream, data, data_size);
+
+	return CreateDecoder(&io_stream, spec);
+}
+
+void* Decoder_libSndfile_CreateFromIO(IOSource *io_source, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+{
+	(void)loop;	// This is ignored in simple decoders
+	(void)wanted_spec;
+
+	IOStream io_stream;
+	IOStream_CreateFromSource(&io_stream, io_source);
+
+	return CreateDecoder(&io_stream, spec);
+}
+
 void Decoder_libSndfile_Destroy(void *decoder_void)
 {
 	Decoder_libSndfile *decoder = (Decoder_libSndfile*)decoder_void;
 
 	sf_close(decoder->sndfile);
-	ROMemoryStream_Destroy(&decoder->memory_stream);
 	free(decoder);
 }
 
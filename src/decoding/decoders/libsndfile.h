@@ -25,8 +25,10 @@
 #include <stddef.h>
 
 #include "common.h"
+#include "io_stream.h"
 
 void* Decoder_libSndfile_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
+void* Decoder_libSndfile_CreateFromIO(IOSource *io_source, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
 void Decoder_libSndfile_Destroy(void *decoder);
 void Decoder_libSndfile_Rewind(void *decoder);
 size_t Decoder_libSndfile_GetSamples(void *decoder, short *buffer, size_t frames_to_do);
@@ -27,6 +27,7 @@
 #include <vorbis/vorbisfile.h>
 
 #include "common.h"
+#include "loop_points.h"
 #include "memory_stream.h"
 
 typedef struct Decoder_libVorbis
@@ -144,3 +145,21 @@ size_t Decoder_libVorbis_GetSamples(void *decoder_void, short *buffer, size_t fr
 
 	return ov_read(&decoder->vorbis_file, (char*)buffer, frames_to_do * size_of_frame, is_big_endian, sizeof(ogg_int16_t), 1, NULL) / size_of_frame;
 }
+
+bool Decoder_libVorbis_Seek(void *decoder_void, size_t frame)
+{
+	Decoder_libVorbis *decoder = (Decoder_libVorbis*)decoder_void;
+
+	return ov_pcm_seek(&decoder->vorbis_file, (ogg_int64_t)frame) == 0;
+}
+
+void Decoder_libVorbis_GetLoopPoints(void *decoder_void, LoopPoints *loop_points)
+{
+	Decoder_libVorbis *decoder = (Decoder_libVorbis*)decoder_void;
+
+	const vorbis_comment *comments = ov_comment(&decoder->vorbis_file, -1);
+
+	if (comments != NULL)
+		for (int i = 0; i < comments->comments; ++i)
+			LoopPoints_ParseComment(loop_points, comments->user_comments[i], (size_t)comments->comment_lengths[i]);
+}
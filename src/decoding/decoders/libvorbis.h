@@ -25,10 +25,13 @@
 #include <stddef.h>
 
 #include "common.h"
+#include "loop_points.h"
 
 void* Decoder_libVorbis_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
 void Decoder_libVorbis_Destroy(void *decoder);
 void Decoder_libVorbis_Rewind(void *decoder);
 size_t Decoder_libVorbis_GetSamples(void *decoder, short *buffer, size_t frames_to_do);
+bool Decoder_libVorbis_Seek(void *decoder, size_t frame);
+void Decoder_libVorbis_GetLoopPoints(void *decoder, LoopPoints *loop_points);
 
 #endif // DECODER_LIBVORBIS_H
@@ -133,3 +133,10 @@ size_t Decoder_libXMP_GetSamples(void *decoder_void, short *buffer, size_t frame
 
 	return frames_to_do;
 }
+
+void Decoder_libXMP_SetLoop(void *decoder_void, bool loop)
+{
+	Decoder_libXMP *decoder = (Decoder_libXMP*)decoder_void;
+
+	decoder->loop = loop;
+}
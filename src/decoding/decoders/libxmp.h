@@ -30,5 +30,6 @@ void* Decoder_libXMP_Create(const unsigned char *data, size_t data_size, bool lo
 void Decoder_libXMP_Destroy(void *decoder);
 void Decoder_libXMP_Rewind(void *decoder);
 size_t Decoder_libXMP_GetSamples(void *decoder, short *buffer, size_t frames_to_do);
+void Decoder_libXMP_SetLoop(void *decoder, bool loop);
 
 #endif // DECODER_LIBXMP_H
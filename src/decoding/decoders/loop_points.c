@@ -0,0 +1,129 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#include "loop_points.h"
+
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+#include <stddef.h>
+
+// Case-insensitive, since that is how Vorbis comment field names are compared
+static bool MatchFieldName(const char *comment, size_t name_length, const char *wanted_name)
+{
+	for (size_t i = 0; i < name_length; ++i)
+	{
+		const char character = comment[i] >= 'a' && comment[i] <= 'z' ? comment[i] - 'a' + 'A' : comment[i];
+
+		if (character != wanted_name[i])
+			return false;
+	}
+
+	return wanted_name[name_length] == '\0';
+}
+
+// Returns false if the value is not a plain decimal number, or if it does not fit in a `size_t`
+static bool ParseNumber(const char *string, size_t length, size_t *value)
+{
+	*value = 0;
+
+	if (length == 0)
+		return false;
+
+	for (size_t i = 0; i < length; ++i)
+	{
+		if (string[i] < '0' || string[i] > '9')
+			return false;
+
+		const size_t digit = (size_t)(string[i] - '0');
+
+		if (*value > ((size_t)-1 - digit) / 10)
+			return false;
+
+		*value = *value * 10 + digit;
+	}
+
+	return true;
+}
+
+static unsigned long ReadU32LE(const unsigned char *buffer)
+{
+	return (unsigned long)buffer[0] << 0 | (unsigned long)buffer[1] << 8 | (unsigned long)buffer[2] << 16 | (unsigned long)buffer[3] << 24;
+}
+
+void LoopPoints_Init(LoopPoints *loop_points)
+{
+	loop_points->start = 0;
+	loop_points->length = 0;
+}
+
+void LoopPoints_ParseComment(LoopPoints *loop_points, const char *comment, size_t comment_length)
+{
+	size_t name_length = 0;
+
+	while (name_length < comment_length && comment[name_length] != '=')
+		++name_length;
+
+	if (name_length == comment_length)
+		return;	// Not a valid comment
+
+	const char *value_string = &comment[name_length + 1];
+	const size_t value_length = comment_length - name_length - 1;
+
+	size_t value;
+
+	if (MatchFieldName(comment, name_length, "LOOPSTART"))
+	{
+		if (ParseNumber(value_string, value_length, &value))
+			loop_points->start = value;
+	}
+	else if (MatchFieldName(comment, name_length, "LOOPLENGTH"))
+	{
+		if (ParseNumber(value_string, value_length, &value))
+			loop_points->length = value;
+	}
+}
+
+void LoopPoints_ParseSmplChunk(LoopPoints *loop_points, const unsigned char *chunk, size_t chunk_size)
+{
+	// The chunk starts with 36 bytes of sampler information, the last 8 of which say how many loops there are (and how
+	// much extra data follows them). Each loop is then 24 bytes: an ID, its type, its first and last frames, and two
+	// things that do not matter here.
+	if (chunk_size < 36)
+		return;
+
+	const unsigned long total_loops = ReadU32LE(&chunk[28]);
+
+	for (unsigned long i = 0; i < total_loops && 36 + (i + 1) * 24 <= chunk_size; ++i)
+	{
+		const unsigned char *loop = &chunk[36 + i * 24];
+
+		const unsigned long type = ReadU32LE(&loop[4]);
+		const unsigned long start = ReadU32LE(&loop[8]);
+		const unsigned long end = ReadU32LE(&loop[12]);	// Inclusive
+
+		// Ping-pong and backward loops cannot be done by seeking, so they are skipped
+		if (type == 0 && end >= start)
+		{
+			loop_points->start = start;
+			loop_points->length = end - start + 1;
+			return;
+		}
+	}
+}
@@ -0,0 +1,40 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#ifndef LOOP_POINTS_H
+#define LOOP_POINTS_H
+
+#include <stddef.h>
+
+// Where a sound's loop starts, and how long it is, in frames. These come from the file's own metadata, which lets
+// a single file have an intro, instead of needing a second file for it. A `length` of 0 means that the loop runs
+// until the end of the sound.
+typedef struct LoopPoints
+{
+	size_t start;
+	size_t length;
+} LoopPoints;
+
+void LoopPoints_Init(LoopPoints *loop_points);
+// Picks out the `LOOPSTART` and `LOOPLENGTH` Vorbis comments. Any other comment is ignored.
+void LoopPoints_ParseComment(LoopPoints *loop_points, const char *comment, size_t comment_length);
+// Uses the first forward loop of a RIFF `smpl` chunk. `chunk` points to the chunk's contents, after its header.
+void LoopPoints_ParseSmplChunk(LoopPoints *loop_points, const unsigned char *chunk, size_t chunk_size);
+
+#endif // LOOP_POINTS_H
@@ -27,28 +27,39 @@
 
 #include "clowncommon.h"
 
+static cc_bool Resize(MemoryStream *memory_stream, size_t new_size)
+{
+	unsigned char *buffer = (unsigned char*)realloc(memory_stream->buffer, new_size);
+
+	if (buffer == NULL)
+		return cc_false;
+
+	memory_stream->buffer = buffer;
+	memory_stream->size = new_size;
+
+	return cc_true;
+}
+
 static cc_bool ResizeIfNeeded(MemoryStream *memory_stream, size_t minimum_needed_size)
 {
 	if (minimum_needed_size > memory_stream->size)
 	{
-		unsigned char *buffer;
-
 		size_t new_size = 1;
 		while (new_size < minimum_needed_size)
 			new_size <<= 1;
 
-		buffer = (unsigned char*)realloc(memory_stream->buffer, new_size);
-
-		if (buffer == NULL)
+		if (!Resize(memory_stream, new_size))
 			return cc_false;
-
-		memory_stream->buffer = buffer;
-		memset(memory_stream->buffer + memory_stream->size, 0, new_size - memory_stream->size);
-		memory_stream->size = new_size;
 	}
 
 	if (minimum_needed_size > memory_stream->end)
+	{
+		/* Anything that was skipped over by seeking past the end reads back as zero */
+		if (memory_stream->position > memory_stream->end)
+			memset(memory_stream->buffer + memory_stream->end, 0, memory_stream->position - memory_stream->end);
+
 		memory_stream->end = minimum_needed_size;
+	}
 
 	return cc_true;
 }
@@ -104,6 +115,21 @@ size_t MemoryStream_Read(MemoryStream *memory_stream, void *output, size_t size,
 	return count;
 }
 
+cc_bool MemoryStream_Reserve(MemoryStream *memory_stream, size_t size)
+{
+	if (size <= memory_stream->size)
+		return cc_true;
+
+	return Resize(memory_stream, size);
+}
+
+void MemoryStream_ShrinkToFit(MemoryStream *memory_stream)
+{
+	/* Failing to shrink is harmless, since the buffer is just left as it was */
+	if (memory_stream->end != 0 && memory_stream->end < memory_stream->size)
+		Resize(memory_stream, memory_stream->end);
+}
+
 unsigned char* MemoryStream_GetBuffer(MemoryStream *memory_stream)
 {
 	return memory_stream->buffer;
@@ -161,6 +187,21 @@ size_t ROMemoryStream_Read(ROMemoryStream *ro_memory_stream, void *output, size_
 	return MemoryStream_Read(&ro_memory_stream->memory_stream, output, size, count);
 }
 
+const void* ROMemoryStream_ReadDirect(ROMemoryStream *ro_memory_stream, size_t size, size_t *count)
+{
+	MemoryStream *memory_stream = &ro_memory_stream->memory_stream;
+
+	const size_t elements_remaining = (memory_stream->end - memory_stream->position) / size;
+	const unsigned char *data = &memory_stream->buffer[memory_stream->position];
+
+	if (*count > elements_remaining)
+		*count = elements_remaining;
+
+	memory_stream->position += size * *count;
+
+	return data;
+}
+
 size_t ROMemoryStream_GetPosition(ROMemoryStream *ro_memory_stream)
 {
 	return MemoryStream_GetPosition(&ro_memory_stream->memory_stream);
@@ -55,6 +55,8 @@ void MemoryStream_Destroy(MemoryStream *memory_stream);
 cc_bool MemoryStream_WriteByte(MemoryStream *memory_stream, unsigned int byte);
 cc_bool MemoryStream_Write(MemoryStream *memory_stream, const void *data, size_t size, size_t count);
 size_t MemoryStream_Read(MemoryStream *memory_stream, void *output, size_t size, size_t count);
+cc_bool MemoryStream_Reserve(MemoryStream *memory_stream, size_t size); /* Avoids repeatedly growing the buffer when the final size is known in advance */
+void MemoryStream_ShrinkToFit(MemoryStream *memory_stream); /* Frees whatever part of the buffer is beyond the end of the data */
 unsigned char* MemoryStream_GetBuffer(MemoryStream *memory_stream);
 size_t MemoryStream_GetPosition(MemoryStream *memory_stream);
 cc_bool MemoryStream_SetPosition(MemoryStream *memory_stream, ptrdiff_t offset, enum MemoryStream_Origin origin);
@@ -63,6 +65,7 @@ void MemoryStream_Rewind(MemoryStream *memory_stream);
 void ROMemoryStream_Create(ROMemoryStream *ro_memory_stream, const void *data, size_t size);
 void ROMemoryStream_Destroy(ROMemoryStream *ro_memory_stream);
 size_t ROMemoryStream_Read(ROMemoryStream *ro_memory_stream, void *output, size_t size, size_t count);
+const void* ROMemoryStream_ReadDirect(ROMemoryStream *ro_memory_stream, size_t size, size_t *count); /* Like `ROMemoryStream_Read`, but returns a pointer to the data instead of copying it */
 size_t ROMemoryStream_GetPosition(ROMemoryStream *ro_memory_stream);
 cc_bool ROMemoryStream_SetPosition(ROMemoryStream *ro_memory_stream, ptrdiff_t offset, enum MemoryStream_Origin origin);
 void ROMemoryStream_Rewind(ROMemoryStream *ro_memory_stream);
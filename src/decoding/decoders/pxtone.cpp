@@ -35,12 +35,13 @@ typedef struct Decoder_PxTone
 {
 	pxtnService *pxtn;
 	bool loop;
+	const unsigned char *data;
+	size_t data_size;
 } Decoder_PxTone;
 
-void* Decoder_PxTone_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+// If `prototype` is not NULL, then its woices are shared instead of being built again
+static Decoder_PxTone* CreateDecoder(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec, const pxtnService *prototype)
 {
-	(void)wanted_spec;
-
 	pxtnService *pxtn = new pxtnService();
 
 	if (pxtn->init() == pxtnOK)
@@ -51,7 +52,7 @@ void* Decoder_PxTone_Create(const unsigned char *data, size_t data_size, bool lo
 		{
 			pxtnDescriptor desc;
 
-			if (desc.set_memory_r((void*)data, data_size) && pxtn->read(&desc) == pxtnOK && pxtn->tones_ready() == pxtnOK)
+			if (desc.set_memory_r((void*)data, data_size) && pxtn->read(&desc) == pxtnOK && (prototype != NULL ? pxtn->tones_ready_shared(prototype) : pxtn->tones_ready()) == pxtnOK)
 			{
 				pxtnVOMITPREPARATION prep = pxtnVOMITPREPARATION();
 				if (loop)
@@ -67,6 +68,8 @@ void* Decoder_PxTone_Create(const unsigned char *data, size_t data_size, bool lo
 					{
 						decoder->pxtn = pxtn;
 						decoder->loop = loop;
+						decoder->data = data;
+						decoder->data_size = data_size;
 
 						spec->sample_rate = sample_rate;
 						spec->channel_count = CHANNEL_COUNT;
@@ -86,6 +89,20 @@ void* Decoder_PxTone_Create(const unsigned char *data, size_t data_size, bool lo
 	return NULL;
 }
 
+void* Decoder_PxTone_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+{
+	return CreateDecoder(data, data_size, loop, wanted_spec, spec, NULL);
+}
+
+void* Decoder_PxTone_Clone(void *prototype_void, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+{
+	Decoder_PxTone *prototype = (Decoder_PxTone*)prototype_void;
+
+	// The song still has to be parsed again, but the woices - which are by far the slowest part to make - can be shared.
+	// This fails if the prototype was made for a different sample rate, in which case the woices have to be built from scratch.
+	return CreateDecoder(prototype->data, prototype->data_size, loop, wanted_spec, spec, prototype->pxtn);
+}
+
 void Decoder_PxTone_Destroy(void *decoder_void)
 {
 	Decoder_PxTone *decoder = (Decoder_PxTone*)decoder_void;
@@ -118,3 +135,11 @@ size_t Decoder_PxTone_GetSamples(void *decoder_void, short *buffer, size_t frame
 
 	return decoder->pxtn->Moo(buffer, bytes_to_do);
 }
+
+void Decoder_PxTone_SetLoop(void *decoder_void, bool loop)
+{
+	Decoder_PxTone *decoder = (Decoder_PxTone*)decoder_void;
+
+	decoder->loop = loop;
+	decoder->pxtn->moo_set_loop(loop);
+}
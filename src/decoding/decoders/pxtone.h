@@ -31,9 +31,11 @@ extern "C" {
 #endif
 
 void* Decoder_PxTone_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
+void* Decoder_PxTone_Clone(void *prototype, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
 void Decoder_PxTone_Destroy(void *decoder);
 void Decoder_PxTone_Rewind(void *decoder);
 size_t Decoder_PxTone_GetSamples(void *decoder, short *buffer, size_t frames_to_do);
+void Decoder_PxTone_SetLoop(void *decoder, bool loop);
 
 #ifdef __cplusplus
 }
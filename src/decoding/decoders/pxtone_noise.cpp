@@ -24,73 +24,285 @@
 
 #include "libs/pxtone/pxtoneNoise.h"
 
+#include "../../atomic.h"
+#include "../../threading.h"
+
 #include "common.h"
 #include "memory_stream.h"
 
 #define SAMPLE_RATE 48000
 #define CHANNEL_COUNT 2
 
+typedef struct NoiseBuffer
+{
+	struct NoiseBuffer *next;
+	unsigned long sample_rate;
+	void *buffer;
+	int32_t buffer_size;
+} NoiseBuffer;
+
 typedef struct Decoder_PxToneNoise
 {
 	ROMemoryStream ro_memory_stream;
-	void *buffer;
+	NoiseBuffer *noise_buffer;	// Belongs to the prototype if this is a clone
+	bool is_clone;
+
+	// Only used by prototypes
+	pxtoneNoise *shared_pxtn;	// Each prototype holds a reference, so that its clones can still generate noise
+	const unsigned char *data;
+	size_t data_size;
+	void *volatile other_noise_buffers;	// Made for clones that wanted a different sample rate
 } Decoder_PxToneNoise;
 
-void* Decoder_PxToneNoise_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+// The noise builder's tables take a while to make, and never change afterwards, so only one is shared by every
+// prototype. It is freed when the last prototype is destroyed.
+static pxtoneNoise *shared_pxtn;
+static unsigned long shared_pxtn_references;
+static void *volatile shared_pxtn_mutex;	// Made on first use, since there is nowhere to make it beforehand, and kept for good
+
+static bool LockSharedPxtn(void)
 {
-	(void)loop;	// This is ignored in simple decoders
-	(void)wanted_spec;
+	Mutex *mutex = (Mutex*)Atomic_LoadPointer(&shared_pxtn_mutex);
+
+	if (mutex == NULL)
+	{
+		mutex = Mutex_Create();
+
+		if (mutex == NULL)
+			return false;
+
+		// Another thread may have beaten us to it
+		if (!Atomic_CompareExchangePointer(&shared_pxtn_mutex, NULL, mutex))
+		{
+			Mutex_Destroy(mutex);
+			mutex = (Mutex*)Atomic_LoadPointer(&shared_pxtn_mutex);
+		}
+	}
+
+	Mutex_Lock(mutex);
+
+	return true;
+}
+
+static void UnlockSharedPxtn(void)
+{
+	Mutex_Unlock((Mutex*)Atomic_LoadPointer(&shared_pxtn_mutex));
+}
+
+static pxtoneNoise* AcquireSharedPxtn(void)
+{
+	if (!LockSharedPxtn())
+		return NULL;
+
+	pxtoneNoise *pxtn = shared_pxtn;
 
-	pxtoneNoise *pxtn = new pxtoneNoise();
+	if (pxtn != NULL)
+		++shared_pxtn_references;
 
-	if (pxtn->init())
+	UnlockSharedPxtn();
+
+	if (pxtn == NULL)
 	{
-		unsigned long sample_rate = wanted_spec->sample_rate == 0 ? SAMPLE_RATE : wanted_spec->sample_rate;
+		// This is made outside of the lock, since it is slow
+		pxtn = new pxtoneNoise();
 
-		if (pxtn->quality_set(CHANNEL_COUNT, sample_rate, 16))
+		if (!pxtn->init())
 		{
-			pxtnDescriptor desc;
+			delete pxtn;
+			return NULL;
+		}
 
-			if (desc.set_memory_r((void*)data, data_size))
-			{
-				void *buffer;
-				int32_t buffer_size;
+		// The mutex already exists by now, so this cannot fail
+		LockSharedPxtn();
 
-				if (pxtn->generate(&desc, &buffer, &buffer_size))
-				{
-					Decoder_PxToneNoise *decoder = (Decoder_PxToneNoise*)malloc(sizeof(Decoder_PxToneNoise));
+		// Another thread may have beaten us to it
+		pxtoneNoise *unneeded_pxtn = NULL;
+
+		if (shared_pxtn == NULL)
+		{
+			shared_pxtn = pxtn;
+		}
+		else
+		{
+			unneeded_pxtn = pxtn;
+			pxtn = shared_pxtn;
+		}
+
+		++shared_pxtn_references;
+
+		UnlockSharedPxtn();
+
+		delete unneeded_pxtn;
+	}
+
+	return pxtn;
+}
+
+static void ReleaseSharedPxtn(void)
+{
+	// The mutex was made when the reference was acquired, so this cannot fail
+	LockSharedPxtn();
 
-					if (decoder != NULL)
-					{
-						ROMemoryStream_Create(&decoder->ro_memory_stream, buffer, buffer_size);
-						decoder->buffer = buffer;
+	pxtoneNoise *unused_pxtn = NULL;
 
-						spec->sample_rate = sample_rate;
-						spec->channel_count = CHANNEL_COUNT;
-						spec->is_complex = false;
+	if (--shared_pxtn_references == 0)
+	{
+		unused_pxtn = shared_pxtn;
+		shared_pxtn = NULL;
+	}
+
+	UnlockSharedPxtn();
+
+	delete unused_pxtn;
+}
+
+static NoiseBuffer* GenerateNoise(const pxtoneNoise *shared_pxtn, const unsigned char *data, size_t data_size, unsigned long sample_rate)
+{
+	pxtoneNoise pxtn;
 
-						delete pxtn;
+	if (pxtn.init_shared(shared_pxtn) && pxtn.quality_set(CHANNEL_COUNT, sample_rate, 16))
+	{
+		pxtnDescriptor desc;
 
-						return decoder;
-					}
+		if (desc.set_memory_r((void*)data, data_size))
+		{
+			NoiseBuffer *noise_buffer = (NoiseBuffer*)malloc(sizeof(NoiseBuffer));
 
-					free(buffer);
+			if (noise_buffer != NULL)
+			{
+				if (pxtn.generate(&desc, &noise_buffer->buffer, &noise_buffer->buffer_size))
+				{
+					noise_buffer->next = NULL;
+					noise_buffer->sample_rate = sample_rate;
+
+					return noise_buffer;
 				}
+
+				free(noise_buffer);
 			}
 		}
 	}
 
-	delete pxtn;
+	return NULL;
+}
+
+static void FreeNoiseBuffers(NoiseBuffer *noise_buffer)
+{
+	while (noise_buffer != NULL)
+	{
+		NoiseBuffer *next = noise_buffer->next;
+
+		free(noise_buffer->buffer);
+		free(noise_buffer);
+
+		noise_buffer = next;
+	}
+}
+
+static Decoder_PxToneNoise* CreateDecoder(NoiseBuffer *noise_buffer, bool is_clone, DecoderSpec *spec)
+{
+	Decoder_PxToneNoise *decoder = (Decoder_PxToneNoise*)malloc(sizeof(Decoder_PxToneNoise));
+
+	if (decoder != NULL)
+	{
+		ROMemoryStream_Create(&decoder->ro_memory_stream, noise_buffer->buffer, noise_buffer->buffer_size);
+		decoder->noise_buffer = noise_buffer;
+		decoder->is_clone = is_clone;
+		decoder->shared_pxtn = NULL;
+		decoder->data = NULL;
+		decoder->data_size = 0;
+		decoder->other_noise_buffers = NULL;
+
+		spec->sample_rate = noise_buffer->sample_rate;
+		spec->channel_count = CHANNEL_COUNT;
+		spec->is_complex = false;
+	}
+
+	return decoder;
+}
+
+void* Decoder_PxToneNoise_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+{
+	(void)loop;	// This is ignored in simple decoders
+
+	unsigned long sample_rate = wanted_spec->sample_rate == 0 ? SAMPLE_RATE : wanted_spec->sample_rate;
+
+	pxtoneNoise *shared_pxtn = AcquireSharedPxtn();
+
+	if (shared_pxtn != NULL)
+	{
+		NoiseBuffer *noise_buffer = GenerateNoise(shared_pxtn, data, data_size, sample_rate);
+
+		if (noise_buffer != NULL)
+		{
+			Decoder_PxToneNoise *decoder = CreateDecoder(noise_buffer, false, spec);
+
+			if (decoder != NULL)
+			{
+				decoder->shared_pxtn = shared_pxtn;
+				decoder->data = data;
+				decoder->data_size = data_size;
+
+				return decoder;
+			}
+
+			FreeNoiseBuffers(noise_buffer);
+		}
+
+		ReleaseSharedPxtn();
+	}
 
 	return NULL;
 }
 
+void* Decoder_PxToneNoise_Clone(void *prototype_void, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+{
+	(void)loop;	// This is ignored in simple decoders
+
+	Decoder_PxToneNoise *prototype = (Decoder_PxToneNoise*)prototype_void;
+
+	unsigned long sample_rate = wanted_spec->sample_rate == 0 ? SAMPLE_RATE : wanted_spec->sample_rate;
+
+	// The noise is only ever generated once for each sample rate: clones just read the prototype's buffers
+	NoiseBuffer *noise_buffer = prototype->noise_buffer;
+
+	if (noise_buffer->sample_rate != sample_rate)
+	{
+		for (noise_buffer = (NoiseBuffer*)Atomic_LoadPointer(&prototype->other_noise_buffers); noise_buffer != NULL; noise_buffer = noise_buffer->next)
+			if (noise_buffer->sample_rate == sample_rate)
+				break;
+
+		if (noise_buffer == NULL)
+		{
+			noise_buffer = GenerateNoise(prototype->shared_pxtn, prototype->data, prototype->data_size, sample_rate);
+
+			if (noise_buffer == NULL)
+				return NULL;
+
+			// If two clones race to generate the same sample rate, then both buffers are kept, which is harmless
+			do
+			{
+				noise_buffer->next = (NoiseBuffer*)Atomic_LoadPointer(&prototype->other_noise_buffers);
+			} while (!Atomic_CompareExchangePointer(&prototype->other_noise_buffers, noise_buffer->next, noise_buffer));
+		}
+	}
+
+	return CreateDecoder(noise_buffer, true, spec);
+}
+
 void Decoder_PxToneNoise_Destroy(void *decoder_void)
 {
 	Decoder_PxToneNoise *decoder = (Decoder_PxToneNoise*)decoder_void;
 
 	ROMemoryStream_Destroy(&decoder->ro_memory_stream);
-	free(decoder->buffer);
+
+	if (!decoder->is_clone)
+	{
+		FreeNoiseBuffers(decoder->noise_buffer);
+		FreeNoiseBuffers((NoiseBuffer*)decoder->other_noise_buffers);
+		ReleaseSharedPxtn();
+	}
+
 	free(decoder);
 }
 
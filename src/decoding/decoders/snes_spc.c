@@ -104,3 +104,9 @@ size_t Decoder_SNES_SPC_GetSamples(void *decoder_void, short *buffer, size_t fra
 
 	return frames_to_do;
 }
+
+void Decoder_SNES_SPC_SetLoop(void *decoder, bool loop)
+{
+	(void)decoder;
+	(void)loop;	// Unusable, sadly - looping is up to the music file
+}
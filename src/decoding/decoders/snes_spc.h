@@ -30,5 +30,6 @@ void* Decoder_SNES_SPC_Create(const unsigned char *data, size_t data_size, bool
 void Decoder_SNES_SPC_Destroy(void *decoder);
 void Decoder_SNES_SPC_Rewind(void *decoder);
 size_t Decoder_SNES_SPC_GetSamples(void *decoder, short *buffer, size_t frames_to_do);
+void Decoder_SNES_SPC_SetLoop(void *decoder, bool loop);
 
 #endif // DECODER_SNES_SPC_H
@@ -22,6 +22,8 @@
 #include <stdbool.h>
 #endif
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define STB_VORBIS_NO_STDIO
 #define STB_VORBIS_NO_PUSHDATA_API
@@ -36,39 +38,140 @@
 #endif
 
 #include "common.h"
+#include "loop_points.h"
+
+typedef struct Decoder_STB_Vorbis
+{
+	stb_vorbis *instance;
+	bool is_clone;	// Clones share the prototype's setup data, so they must not free it
+} Decoder_STB_Vorbis;
 
 void* Decoder_STB_Vorbis_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
 {
 	(void)loop;	// This is ignored in simple decoders
 	(void)wanted_spec;
 
-	stb_vorbis *instance = stb_vorbis_open_memory(data, data_size, NULL, NULL);
+	Decoder_STB_Vorbis *decoder = (Decoder_STB_Vorbis*)malloc(sizeof(Decoder_STB_Vorbis));
+
+	if (decoder != NULL)
+	{
+		decoder->instance = stb_vorbis_open_memory(data, data_size, NULL, NULL);
+
+		if (decoder->instance != NULL)
+		{
+			const stb_vorbis_info vorbis_info = stb_vorbis_get_info(decoder->instance);
+
+			spec->sample_rate = vorbis_info.sample_rate;
+			spec->channel_count = vorbis_info.channels;
+			spec->is_complex = false;
+
+			decoder->is_clone = false;
+
+			return decoder;
+		}
+
+		free(decoder);
+	}
+
+	return NULL;
+}
+
+void* Decoder_STB_Vorbis_Clone(void *prototype, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+{
+	(void)loop;	// This is ignored in simple decoders
+	(void)wanted_spec;
+
+	const stb_vorbis *original = ((Decoder_STB_Vorbis*)prototype)->instance;
+
+	// The codebooks, floor/residue/mapping configuration, and the per-blocksize tables are never written to
+	// after the setup headers are parsed, so only the per-channel decode buffers need to be duplicated.
+	int longest_floorlist = 0;
+
+	for (int i = 0; i < original->floor_count; ++i)
+		if (original->floor_types[i] == 1 && original->floor_config[i].floor1.values > longest_floorlist)
+			longest_floorlist = original->floor_config[i].floor1.values;
 
-	if (instance != NULL)
+	const size_t channel_buffer_length = original->blocksize_1;
+	const size_t previous_window_length = original->blocksize_1 / 2;
+	const size_t final_y_length = longest_floorlist;
+
+	// Floats go before the 16-bit arrays, to keep them aligned
+	Decoder_STB_Vorbis *decoder = (Decoder_STB_Vorbis*)malloc(sizeof(Decoder_STB_Vorbis) + sizeof(stb_vorbis) + original->channels * ((channel_buffer_length + previous_window_length) * sizeof(float) + final_y_length * sizeof(int16)));
+
+	if (decoder != NULL)
 	{
-		const stb_vorbis_info vorbis_info = stb_vorbis_get_info(instance);
+		stb_vorbis *instance = (stb_vorbis*)(decoder + 1);
+		float *float_buffers = (float*)(instance + 1);
+		int16 *int16_buffers = (int16*)(float_buffers + original->channels * (channel_buffer_length + previous_window_length));
+
+		// Copying the prototype's state, rather than rewinding, avoids decoding the first frame again
+		*instance = *original;
+
+		for (int i = 0; i < original->channels; ++i)
+		{
+			instance->channel_buffers[i] = float_buffers;
+			float_buffers += channel_buffer_length;
+			instance->previous_window[i] = float_buffers;
+			float_buffers += previous_window_length;
+			instance->finalY[i] = int16_buffers;
+			int16_buffers += final_y_length;
+
+			memcpy(instance->channel_buffers[i], original->channel_buffers[i], channel_buffer_length * sizeof(float));
+			memcpy(instance->previous_window[i], original->previous_window[i], previous_window_length * sizeof(float));
+			memcpy(instance->finalY[i], original->finalY[i], final_y_length * sizeof(int16));
 
-		spec->sample_rate = vorbis_info.sample_rate;
-		spec->channel_count = vorbis_info.channels;
+			if (original->outputs[i] != NULL)
+				instance->outputs[i] = instance->channel_buffers[i] + (original->outputs[i] - original->channel_buffers[i]);
+		}
+
+		spec->sample_rate = instance->sample_rate;
+		spec->channel_count = instance->channels;
 		spec->is_complex = false;
+
+		decoder->instance = instance;
+		decoder->is_clone = true;
 	}
 
-	return instance;
+	return decoder;
 }
 
-void Decoder_STB_Vorbis_Destroy(void *decoder)
+void Decoder_STB_Vorbis_Destroy(void *decoder_void)
 {
-	stb_vorbis_close((stb_vorbis*)decoder);
+	Decoder_STB_Vorbis *decoder = (Decoder_STB_Vorbis*)decoder_void;
+
+	// A clone's decode buffers are part of the same allocation as the decoder itself
+	if (!decoder->is_clone)
+		stb_vorbis_close(decoder->instance);
+
+	free(decoder);
 }
 
 void Decoder_STB_Vorbis_Rewind(void *decoder)
 {
-	stb_vorbis_seek_start((stb_vorbis*)decoder);
+	stb_vorbis_seek_start(((Decoder_STB_Vorbis*)decoder)->instance);
 }
 
 size_t Decoder_STB_Vorbis_GetSamples(void *decoder, short *buffer, size_t frames_to_do)
 {
-	stb_vorbis *instance = (stb_vorbis*)decoder;
+	stb_vorbis *instance = ((Decoder_STB_Vorbis*)decoder)->instance;
 
 	return stb_vorbis_get_samples_short_interleaved(instance, instance->channels, buffer, frames_to_do * instance->channels);
 }
+
+bool Decoder_STB_Vorbis_Seek(void *decoder, size_t frame)
+{
+	return stb_vorbis_seek(((Decoder_STB_Vorbis*)decoder)->instance, (unsigned int)frame) != 0;
+}
+
+size_t Decoder_STB_Vorbis_GetLength(void *decoder)
+{
+	return stb_vorbis_stream_length_in_samples(((Decoder_STB_Vorbis*)decoder)->instance);
+}
+
+void Decoder_STB_Vorbis_GetLoopPoints(void *decoder, LoopPoints *loop_points)
+{
+	const stb_vorbis_comment comments = stb_vorbis_get_comment(((Decoder_STB_Vorbis*)decoder)->instance);
+
+	for (int i = 0; i < comments.comment_list_length; ++i)
+		LoopPoints_ParseComment(loop_points, comments.comment_list[i], strlen(comments.comment_list[i]));
+}
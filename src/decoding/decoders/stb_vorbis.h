@@ -25,10 +25,15 @@
 #include <stddef.h>
 
 #include "common.h"
+#include "loop_points.h"
 
 void* Decoder_STB_Vorbis_Create(const unsigned char *data, size_t data_size, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
+void* Decoder_STB_Vorbis_Clone(void *prototype, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
 void Decoder_STB_Vorbis_Destroy(void *decoder);
 void Decoder_STB_Vorbis_Rewind(void *decoder);
 size_t Decoder_STB_Vorbis_GetSamples(void *decoder, short *buffer, size_t frames_to_do);
+bool Decoder_STB_Vorbis_Seek(void *decoder, size_t frame);
+size_t Decoder_STB_Vorbis_GetLength(void *decoder);
+void Decoder_STB_Vorbis_GetLoopPoints(void *decoder, LoopPoints *loop_points);
 
 #endif // DECODER_STB_VORBIS_H
@@ -0,0 +1,276 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#include "predecode_cache.h"
+
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "decoders/common.h"
+#include "decoders/loop_points.h"
+#include "predecoder.h"
+
+#include "../file_mapping.h"
+
+// Bump this whenever a decoder or the resampler starts producing different output, so that old entries get rebuilt
+#define CACHE_VERSION 3
+
+#ifdef CLOWNAUDIO_CLOWNRESAMPLER
+ #define RESAMPLER_ID 1
+ #define RESAMPLER_NAME "clownresampler"
+#else
+ #define RESAMPLER_ID 0
+ #define RESAMPLER_NAME "miniaudio"
+#endif
+
+// An entry is a header, followed by the decoded data exactly as it is kept in memory.
+// The first `KEY_SIZE` bytes of the header must match the key that is being looked up.
+// The rest is the sample rate, the size of the decoded data, and the loop points.
+#define HEADER_SIZE 0x60
+#define KEY_SIZE 0x40
+
+#define DECODER_NAME_SIZE 0x10	// Including the null terminator
+
+static const unsigned char magic[8] = {'C', 'L', 'O', 'W', 'N', 'P', 'C', 'M'};
+
+static void WriteU32(unsigned char *buffer, unsigned long value)
+{
+	buffer[0] = (unsigned char)(value >> 0);
+	buffer[1] = (unsigned char)(value >> 8);
+	buffer[2] = (unsigned char)(value >> 16);
+	buffer[3] = (unsigned char)(value >> 24);
+}
+
+static unsigned long ReadU32(const unsigned char *buffer)
+{
+	return (unsigned long)buffer[0] << 0 | (unsigned long)buffer[1] << 8 | (unsigned long)buffer[2] << 16 | (unsigned long)buffer[3] << 24;
+}
+
+// `size_t` may be 64-bit, so it is stored in two halves. The shift is split in two, since shifting a 32-bit `size_t` by 32 is undefined.
+static void WriteSize(unsigned char *buffer, size_t value)
+{
+	WriteU32(&buffer[0], (unsigned long)(value & 0xFFFFFFFF));
+	WriteU32(&buffer[4], (unsigned long)((value >> 16 >> 16) & 0xFFFFFFFF));
+}
+
+// Returns false if the value does not fit in a `size_t`
+static bool ReadSize(const unsigned char *buffer, size_t *value)
+{
+	const size_t low = ReadU32(&buffer[0]);
+	const size_t high = ReadU32(&buffer[4]);
+
+	*value = high << 16 << 16 | low;
+
+	return *value >> 16 >> 16 == high;
+}
+
+static void WriteKey(unsigned char *header, const PredecodeCacheKey *key)
+{
+	// The PCM is stored in the machine's own byte order, so that it can be used without being converted. This records what that order was.
+	const unsigned short byte_order = 0x0102;
+
+	memset(header, 0, HEADER_SIZE);
+	memcpy(&header[0], magic, sizeof(magic));
+	WriteU32(&header[8], CACHE_VERSION);
+	memcpy(&header[12], &byte_order, sizeof(byte_order));
+	WriteU32(&header[16], RESAMPLER_ID);
+	WriteU32(&header[20], key->hash_high);
+	WriteU32(&header[24], key->hash_low);
+	WriteSize(&header[28], key->source_size);
+	WriteU32(&header[36], key->sample_rate);
+	WriteU32(&header[40], key->channel_count);
+
+	const size_t decoder_name_length = strlen(key->decoder_name);
+	memcpy(&header[44], key->decoder_name, decoder_name_length < DECODER_NAME_SIZE - 1 ? decoder_name_length : DECODER_NAME_SIZE - 1);
+}
+
+// Returns NULL if memory could not be allocated
+static char* GetEntryPath(const char *directory, const PredecodeCacheKey *key)
+{
+	const size_t directory_length = strlen(directory);
+	const bool needs_separator = directory_length != 0 && directory[directory_length - 1] != '/' && directory[directory_length - 1] != '\\';
+
+	// Everything that tells entries apart goes in the filename, so that an entry never has to replace one that is merely out of date
+	char *path = (char*)malloc(directory_length + strlen(key->decoder_name) + 96);
+
+	if (path != NULL)
+	{
+		memcpy(path, directory, directory_length);
+		sprintf(&path[directory_length], "%s%08lx%08lx-%lu-%u-%s-" RESAMPLER_NAME "-v%d.pcm", needs_separator ? "/" : "", key->hash_high, key->hash_low, key->sample_rate, key->channel_count, key->decoder_name, CACHE_VERSION);
+	}
+
+	return path;
+}
+
+void PredecodeCache_InitKey(PredecodeCacheKey *key, const DecoderSpec *wanted_spec, const char *decoder_name)
+{
+	// FNV-1a's 64-bit offset basis
+	key->hash_high = 0xCBF29CE4;
+	key->hash_low = 0x84222325;
+	key->source_size = 0;
+	key->sample_rate = wanted_spec->sample_rate;
+	key->channel_count = wanted_spec->channel_count;
+	key->decoder_name = decoder_name;
+}
+
+void PredecodeCache_HashData(PredecodeCacheKey *key, const unsigned char *data, size_t size)
+{
+	// This is 64-bit FNV-1a. Neither C99 nor C++98 can be relied on for a 64-bit integer, so the hash is
+	// kept in two 32-bit halves, and the multiplication by the prime (2^40 + 0x1B3) is done in pieces.
+	unsigned long high = key->hash_high;
+	unsigned long low = key->hash_low;
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		low ^= data[i];
+
+		const unsigned long product_low = (low & 0xFFFF) * 0x1B3;
+		const unsigned long product_high = (low >> 16) * 0x1B3 + (product_low >> 16);
+
+		high = (high * 0x1B3 + (product_high >> 16) + (low << 8)) & 0xFFFFFFFF;
+		low = (product_high & 0xFFFF) << 16 | (product_low & 0xFFFF);
+	}
+
+	key->hash_high = high;
+	key->hash_low = low;
+	key->source_size += size;
+}
+
+PredecoderData* PredecodeCache_Load(const char *directory, const PredecodeCacheKey *key)
+{
+	PredecoderData *data = NULL;
+
+	char *path = GetEntryPath(directory, key);
+
+	if (path != NULL)
+	{
+		const unsigned char *file_buffer;
+		size_t file_size;
+		FileMapping *file_mapping = FileMapping_Open(path, &file_buffer, &file_size);
+
+		if (file_mapping != NULL)
+		{
+			unsigned char expected_header[HEADER_SIZE];
+			WriteKey(expected_header, key);
+
+			size_t decoded_data_size;
+			LoopPoints loop_points;
+			bool damaged = true;
+
+			// Anything that does not add up means that the entry was made by a different version of clownaudio, or has been damaged
+			if (file_size >= HEADER_SIZE
+			 && memcmp(file_buffer, expected_header, KEY_SIZE) == 0
+			 && ReadSize(&file_buffer[KEY_SIZE + 4], &decoded_data_size)
+			 && decoded_data_size == file_size - HEADER_SIZE
+			 && decoded_data_size % (key->channel_count * sizeof(short)) == 0
+			 && ReadSize(&file_buffer[KEY_SIZE + 12], &loop_points.start)
+			 && ReadSize(&file_buffer[KEY_SIZE + 20], &loop_points.length))
+			{
+				const unsigned long sample_rate = ReadU32(&file_buffer[KEY_SIZE]);
+
+				damaged = sample_rate == 0 || (key->sample_rate != 0 && sample_rate != key->sample_rate);
+
+				if (!damaged)
+					data = Predecoder_CreateDataFromMapping(file_mapping, &file_buffer[HEADER_SIZE], decoded_data_size, sample_rate);
+
+				// These were saved at the data's own sample rate, so they are only checked, not converted
+				if (data != NULL)
+					Predecoder_SetLoopPoints(data, &loop_points, sample_rate);
+			}
+
+			if (data == NULL)
+				FileMapping_Close(file_mapping);
+
+			// Get a damaged entry out of the way of the one that is about to be saved in its place
+			if (damaged)
+				remove(path);
+		}
+
+		free(path);
+	}
+
+	return data;
+}
+
+void PredecodeCache_Save(const char *directory, const PredecodeCacheKey *key, PredecoderData *data)
+{
+	size_t decoded_data_size;
+	unsigned long sample_rate;
+	const unsigned char *decoded_data = Predecoder_GetDecodedData(data, &decoded_data_size, &sample_rate);
+
+	LoopPoints loop_points;
+	Predecoder_GetLoopPoints(data, &loop_points);
+
+	char *path = GetEntryPath(directory, key);
+
+	if (path != NULL)
+	{
+		// The entry is written to a temporary file first, and then renamed, so that a half-written entry can never be seen.
+		// Its name has to differ from any other thread or program that is saving the same entry at the same time.
+		char *temporary_path = (char*)malloc(strlen(path) + 32);
+
+		if (temporary_path != NULL)
+		{
+			sprintf(temporary_path, "%s.%lx%lx.tmp", path, (unsigned long)(size_t)data, (unsigned long)time(NULL));
+
+			FILE *file = fopen(temporary_path, "wb");
+
+			if (file != NULL)
+			{
+				unsigned char header[HEADER_SIZE];
+				WriteKey(header, key);
+				WriteU32(&header[KEY_SIZE], sample_rate);
+				WriteSize(&header[KEY_SIZE + 4], decoded_data_size);
+				WriteSize(&header[KEY_SIZE + 12], loop_points.start);
+				WriteSize(&header[KEY_SIZE + 20], loop_points.length);
+
+				bool success = fwrite(header, 1, HEADER_SIZE, file) == HEADER_SIZE && fwrite(decoded_data, 1, decoded_data_size, file) == decoded_data_size;
+
+				if (fclose(file) != 0)
+					success = false;
+
+				if (success)
+				{
+					// Windows' `rename` will not replace a file, so any existing entry has to go first
+					remove(path);
+
+					// On Windows, that fails if another program has the entry mapped, and then so does this. That is not an error:
+					// since entries only share a filename if they hold the same data, that entry is just as good as this one.
+					// This one is thrown away rather than kept, since nothing would ever look for it.
+					if (rename(temporary_path, path) != 0)
+						remove(temporary_path);
+				}
+				else
+				{
+					remove(temporary_path);
+				}
+			}
+
+			free(temporary_path);
+		}
+
+		free(path);
+	}
+}
@@ -0,0 +1,48 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#ifndef PREDECODE_CACHE_H
+#define PREDECODE_CACHE_H
+
+#include <stddef.h>
+
+#include "decoders/common.h"
+#include "predecoder.h"
+
+// Stores predecoded sound-data in files, so that it can be mapped into memory
+// the next time it is loaded, instead of being decoded all over again.
+
+// Identifies the file that the sound-data was decoded from, the decoder that decoded it, and what it was decoded to.
+// The file is identified by its size and a hash of its contents, so changing it gives a new key.
+typedef struct PredecodeCacheKey
+{
+	unsigned long hash_high;
+	unsigned long hash_low;
+	size_t source_size;
+	unsigned long sample_rate;	// 0 if the sample rate was left alone
+	unsigned int channel_count;
+	const char *decoder_name;	// Must be safe to put in a filename. Only the first 15 characters are recorded in the entry's header.
+} PredecodeCacheKey;
+
+void PredecodeCache_InitKey(PredecodeCacheKey *key, const DecoderSpec *wanted_spec, const char *decoder_name);
+void PredecodeCache_HashData(PredecodeCacheKey *key, const unsigned char *data, size_t size); // Can be called repeatedly, to hash a file in pieces
+PredecoderData* PredecodeCache_Load(const char *directory, const PredecodeCacheKey *key); // Returns NULL if there is no entry, or if it is stale or damaged
+void PredecodeCache_Save(const char *directory, const PredecodeCacheKey *key, PredecoderData *data); // Failure is not an error: the sound-data just gets decoded again next time
+
+#endif // PREDECODE_CACHE_H
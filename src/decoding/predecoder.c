@@ -23,6 +23,7 @@
 #endif
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define MA_NO_DECODING
 #define MA_NO_ENCODING
@@ -32,85 +33,423 @@
 #endif
 
 #include "decoders/common.h"
+#include "decoders/loop_points.h"
 #include "decoders/memory_stream.h"
 
 #include "resampled_decoder.h"
 
+#include "../file_mapping.h"
+#include "../pool.h"
+#include "../threading.h"
+
 #define CHANNEL_COUNT 2
+#define SIZE_OF_FRAME (sizeof(short) * CHANNEL_COUNT)
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+// Splitting a file only pays off if each thread gets a decent amount of it to decode
+#define MIN_SEGMENT_FRAMES 0x40000
+#define MAX_SEGMENTS 0x10
+
+// Every segment but the first starts decoding this many frames early, and the result is checked against the end of the
+// previous segment. If a decoder's seeking is not sample-accurate, or its output depends on more than it has decoded since
+// the seek, then this catches it, and the file is decoded in one go instead.
+#define OVERLAP_FRAMES 0x1000
 
 typedef struct Predecoder
 {
 	ROMemoryStream ro_memory_stream;
 	bool loop;
+	size_t loop_start;	// In bytes
+	size_t loop_end;	// In bytes. This is the end of the data, unless the loop points say otherwise.
 } Predecoder;
 
 struct PredecoderData
 {
+	FileMapping *file_mapping;	// If this is not NULL, then `decoded_data` points into it, rather than being allocated
 	void *decoded_data;
 	size_t decoded_data_size;
 	unsigned long sample_rate;
+	LoopPoints loop_points;	// In frames of the decoded data
 };
 
-PredecoderData* Predecoder_DecodeData(const DecoderSpec *in_spec, const DecoderSpec *out_spec, DecoderStage *stage)
+typedef struct Segment
 {
-	PredecoderData *predecoder_data = (PredecoderData*)malloc(sizeof(PredecoderData));
+	DecoderStage stage;	// The first segment uses the caller's decoder, and the others create their own
+	size_t first_frame;
+	size_t overlap_frames;	// How many frames before `first_frame` are decoded too
+	size_t total_frames;	// Not including the overlap. The last segment ignores this, and decodes until the end of the file.
+	size_t size_of_frame;
+	bool is_last;
+	bool success;
+	MemoryStream memory_stream;
+	Thread *thread;
+} Segment;
+
+// A decoder stage that reads the segments back-to-back, skipping their overlaps
+typedef struct SegmentReader
+{
+	Segment *segments;
+	size_t total_segments;
+	size_t current_segment;
+	ROMemoryStream ro_memory_stream;
+} SegmentReader;
 
-	if (predecoder_data != NULL)
+static size_t DecodeFrames(DecoderStage *stage, MemoryStream *memory_stream, size_t size_of_frame, size_t frames_to_do)
+{
+	size_t frames_done = 0;
+
+	while (frames_done != frames_to_do)
 	{
-		void *resampled_decoder = ResampledDecoder_Create(stage, false, out_spec, in_spec);
+		short buffer[0x1000];
+
+		const size_t frames = stage->GetSamples(stage->decoder, buffer, MIN(frames_to_do - frames_done, sizeof(buffer) / size_of_frame), NULL);
+
+		if (frames == 0 || !MemoryStream_Write(memory_stream, buffer, size_of_frame, frames))
+			break;
+
+		frames_done += frames;
+	}
+
+	return frames_done;
+}
+
+static void DecodeSegment(void *user_data)
+{
+	Segment *segment = (Segment*)user_data;
 
-		if (resampled_decoder != NULL)
+	const size_t frames_wanted = segment->overlap_frames + segment->total_frames;
+	const size_t frames_done = DecodeFrames(&segment->stage, &segment->memory_stream, segment->size_of_frame, segment->is_last ? (size_t)-1 : frames_wanted);
+
+	// The file's header cannot be trusted, so make sure that the segments really were as long as it said
+	segment->success = segment->is_last ? frames_done >= segment->overlap_frames : frames_done == frames_wanted;
+}
+
+// Returns false if the segments did not decode properly, or if they do not match up
+static bool DecodeSegments(const PredecoderSegmenter *segmenter, Segment *segments, size_t total_segments)
+{
+	// Some decoder libraries write to global tables when they are created, so that is done here rather than on the threads
+	for (size_t i = 1; i < total_segments; ++i)
+		if (!segmenter->CreateStage(segmenter->user_data, segments[i].first_frame - segments[i].overlap_frames, &segments[i].stage))
+			return false;
+
+	// The first segment is decoded on this thread, while the others are decoded on their own
+	for (size_t i = 1; i < total_segments; ++i)
+		segments[i].thread = Thread_Create(DecodeSegment, &segments[i]);
+
+	DecodeSegment(&segments[0]);
+
+	bool success = true;
+
+	for (size_t i = 0; i < total_segments; ++i)
+	{
+		if (i != 0)
+		{
+			if (segments[i].thread != NULL)
+				Thread_Join(segments[i].thread);
+			else
+				DecodeSegment(&segments[i]);	// Make do without the thread
+		}
+
+		if (!segments[i].success)
 		{
-			MemoryStream memory_stream;
-			MemoryStream_Create(&memory_stream, false);
+			success = false;
+		}
+		else if (i != 0)
+		{
+			const size_t overlap_size = segments[i].overlap_frames * segments[i].size_of_frame;
+			const unsigned char *previous_segment_end = MemoryStream_GetBuffer(&segments[i - 1].memory_stream) + MemoryStream_GetPosition(&segments[i - 1].memory_stream);
+
+			if (success && memcmp(MemoryStream_GetBuffer(&segments[i].memory_stream), previous_segment_end - overlap_size, overlap_size) != 0)
+				success = false;
+		}
+	}
 
-			size_t size_of_frame = sizeof(short) * out_spec->channel_count;
+	return success;
+}
 
-			for (;;)
-			{
-				short buffer[0x1000];
+static void SegmentReader_Destroy(void *segment_reader)
+{
+	(void)segment_reader;	// The segments belong to `Predecoder_DecodeData`
+}
+
+static void SegmentReader_Rewind(void *segment_reader)
+{
+	(void)segment_reader;	// Never needed, since predecoding only reads the file once
+}
+
+static size_t SegmentReader_GetSamples(void *segment_reader_void, short *buffer, size_t frames_to_do, short *scratch)
+{
+	(void)scratch;
+
+	SegmentReader *segment_reader = (SegmentReader*)segment_reader_void;
+
+	size_t frames_done = 0;
+
+	while (frames_done != frames_to_do && segment_reader->current_segment != segment_reader->total_segments)
+	{
+		Segment *segment = &segment_reader->segments[segment_reader->current_segment];
 
-				size_t frames_done = ResampledDecoder_GetSamples(resampled_decoder, buffer, sizeof(buffer) / size_of_frame);
+		frames_done += ROMemoryStream_Read(&segment_reader->ro_memory_stream, &buffer[frames_done * (segment->size_of_frame / sizeof(short))], segment->size_of_frame, frames_to_do - frames_done);
 
-				if (frames_done == 0)
-					break;
+		if (frames_done != frames_to_do && ++segment_reader->current_segment != segment_reader->total_segments)
+		{
+			Segment *next_segment = &segment_reader->segments[segment_reader->current_segment];
+			const size_t overlap_size = next_segment->overlap_frames * next_segment->size_of_frame;
+
+			ROMemoryStream_Destroy(&segment_reader->ro_memory_stream);
+			ROMemoryStream_Create(&segment_reader->ro_memory_stream, MemoryStream_GetBuffer(&next_segment->memory_stream) + overlap_size, MemoryStream_GetPosition(&next_segment->memory_stream) - overlap_size);
+		}
+	}
+
+	return frames_done;
+}
+
+static void BorrowedStage_Destroy(void *decoder)
+{
+	(void)decoder;	// The stage belongs to whoever called `Resample`
+}
 
-				MemoryStream_Write(&memory_stream, buffer, size_of_frame, frames_done);
+// Runs `stage` through a resampler, and stores the output in `predecoder_data`. `stage` is not destroyed, so that
+// the caller can still fall back on it if this fails. `total_frames` is the length of `stage`, or 0 if it is unknown.
+static bool Resample(const DecoderSpec *in_spec, const DecoderSpec *out_spec, const DecoderStage *stage, size_t total_frames, PredecoderData *predecoder_data)
+{
+	DecoderStage borrowed_stage = *stage;
+	borrowed_stage.Destroy = BorrowedStage_Destroy;
+
+	void *resampled_decoder = ResampledDecoder_Create(&borrowed_stage, false, out_spec, in_spec, NULL);
+
+	if (resampled_decoder != NULL)
+	{
+		MemoryStream memory_stream;
+		MemoryStream_Create(&memory_stream, false);
+
+		size_t size_of_frame = sizeof(short) * out_spec->channel_count;
+		const unsigned long sample_rate = out_spec->sample_rate == 0 ? in_spec->sample_rate : out_spec->sample_rate;
+
+		// Allocate the whole output up-front, rather than letting the buffer keep doubling as it fills.
+		// A little extra is added in case the resampler rounds up, and the rest is trimmed off at the end.
+		if (total_frames != 0 && in_spec->sample_rate != 0)
+		{
+			const double expected_frames = (double)total_frames * sample_rate / in_spec->sample_rate + 0x10;
+
+			if (expected_frames < (double)((size_t)-1 / size_of_frame))
+				MemoryStream_Reserve(&memory_stream, (size_t)expected_frames * size_of_frame);
+		}
+
+		bool success = true;
+
+		short scratch[DECODER_SCRATCH_SIZE];
+
+		for (;;)
+		{
+			short buffer[0x1000];
+
+			size_t frames_done = ResampledDecoder_GetSamples(resampled_decoder, buffer, sizeof(buffer) / size_of_frame, scratch);
+
+			if (frames_done == 0)
+				break;
+
+			if (!MemoryStream_Write(&memory_stream, buffer, size_of_frame, frames_done))
+			{
+				success = false;
+				break;
 			}
+		}
+
+		if (success)
+		{
+			MemoryStream_ShrinkToFit(&memory_stream);
 
 			predecoder_data->decoded_data = MemoryStream_GetBuffer(&memory_stream);
 			predecoder_data->decoded_data_size = MemoryStream_GetPosition(&memory_stream);
-			predecoder_data->sample_rate = out_spec->sample_rate == 0 ? in_spec->sample_rate : out_spec->sample_rate;
+			predecoder_data->sample_rate = sample_rate;
+		}
+		else
+		{
+			free(MemoryStream_GetBuffer(&memory_stream));
+		}
+
+		MemoryStream_Destroy(&memory_stream);
+		ResampledDecoder_Destroy(resampled_decoder);
+
+		return success;
+	}
+
+	return false;
+}
+
+// Decodes the file in segments on several threads, and then resamples them in one go. The resampler's low-pass filter
+// depends on everything that came before it, so resampling the segments separately would not match the serial output.
+// Returns false if the file cannot be split, in which case `stage` is left at the start of the file.
+static bool DecodeInSegments(const DecoderSpec *in_spec, const DecoderSpec *out_spec, DecoderStage *stage, const PredecoderSegmenter *segmenter, PredecoderData *predecoder_data)
+{
+	bool success = false;
+
+	const size_t total_frames = segmenter->GetLength(stage->decoder);
+	const size_t total_segments = MIN(MIN(Thread_GetProcessorCount(), MAX_SEGMENTS), total_frames / MIN_SEGMENT_FRAMES);
+
+	Segment *segments = total_segments > 1 ? (Segment*)malloc(sizeof(Segment) * total_segments) : NULL;
+
+	if (segments != NULL)
+	{
+		for (size_t i = 0; i < total_segments; ++i)
+		{
+			Segment *segment = &segments[i];
+
+			segment->stage.decoder = NULL;
+			segment->first_frame = total_frames / total_segments * i;
+			segment->overlap_frames = i == 0 ? 0 : OVERLAP_FRAMES;
+			segment->total_frames = total_frames / total_segments;
+			segment->size_of_frame = sizeof(short) * in_spec->channel_count;
+			segment->is_last = i == total_segments - 1;
+			MemoryStream_Create(&segment->memory_stream, true);
+			MemoryStream_Reserve(&segment->memory_stream, (segment->overlap_frames + (segment->is_last ? total_frames - segment->first_frame : segment->total_frames)) * segment->size_of_frame);
+		}
+
+		segments[0].stage = *stage;
+
+		if (DecodeSegments(segmenter, segments, total_segments))
+		{
+			SegmentReader segment_reader;
+			segment_reader.segments = segments;
+			segment_reader.total_segments = total_segments;
+			segment_reader.current_segment = 0;
+			ROMemoryStream_Create(&segment_reader.ro_memory_stream, MemoryStream_GetBuffer(&segments[0].memory_stream), MemoryStream_GetPosition(&segments[0].memory_stream));
+
+			DecoderStage segment_stage;
+			segment_stage.decoder = &segment_reader;
+			segment_stage.Destroy = SegmentReader_Destroy;
+			segment_stage.Rewind = SegmentReader_Rewind;
+			segment_stage.GetSamples = SegmentReader_GetSamples;
+			segment_stage.SetLoop = NULL;
+			segment_stage.ReadDirect = NULL;
+
+			success = Resample(in_spec, out_spec, &segment_stage, total_frames, predecoder_data);
+
+			ROMemoryStream_Destroy(&segment_reader.ro_memory_stream);
+		}
 
-			MemoryStream_Destroy(&memory_stream);
-			ResampledDecoder_Destroy(resampled_decoder);
+		for (size_t i = 1; i < total_segments; ++i)
+			if (segments[i].stage.decoder != NULL)
+				segments[i].stage.Destroy(segments[i].stage.decoder);
 
+		for (size_t i = 0; i < total_segments; ++i)
+			MemoryStream_Destroy(&segments[i].memory_stream);
+
+		free(segments);
+
+		// The caller's decoder was used by the first segment
+		if (success)
+			stage->Destroy(stage->decoder);
+		else
+			stage->Rewind(stage->decoder);
+	}
+
+	return success;
+}
+
+PredecoderData* Predecoder_DecodeData(const DecoderSpec *in_spec, const DecoderSpec *out_spec, DecoderStage *stage, const PredecoderSegmenter *segmenter)
+{
+	PredecoderData *predecoder_data = (PredecoderData*)malloc(sizeof(PredecoderData));
+
+	if (predecoder_data != NULL)
+	{
+		predecoder_data->file_mapping = NULL;
+		LoopPoints_Init(&predecoder_data->loop_points);
+
+		if (segmenter != NULL && DecodeInSegments(in_spec, out_spec, stage, segmenter, predecoder_data))
+			return predecoder_data;
+
+		if (Resample(in_spec, out_spec, stage, segmenter != NULL ? segmenter->GetLength(stage->decoder) : 0, predecoder_data))
+		{
+			stage->Destroy(stage->decoder);
 			return predecoder_data;
 		}
 
+		stage->Rewind(stage->decoder);
 		free(predecoder_data);
 	}
 
 	return NULL;
 }
 
+PredecoderData* Predecoder_CreateDataFromMapping(FileMapping *file_mapping, const unsigned char *decoded_data, size_t decoded_data_size, unsigned long sample_rate)
+{
+	PredecoderData *predecoder_data = (PredecoderData*)malloc(sizeof(PredecoderData));
+
+	if (predecoder_data != NULL)
+	{
+		predecoder_data->file_mapping = file_mapping;
+		predecoder_data->decoded_data = (void*)decoded_data;	// Never written to
+		predecoder_data->decoded_data_size = decoded_data_size;
+		predecoder_data->sample_rate = sample_rate;
+		LoopPoints_Init(&predecoder_data->loop_points);
+	}
+
+	return predecoder_data;
+}
+
+void Predecoder_SetLoopPoints(PredecoderData *data, const LoopPoints *loop_points, unsigned long sample_rate)
+{
+	const size_t total_frames = data->decoded_data_size / SIZE_OF_FRAME;
+
+	// The decoded data has probably been resampled, so the loop points have to be too. The start and the end are
+	// converted separately, rather than the start and the length, so that rounding cannot make the loop drift.
+	const double ratio = sample_rate != 0 ? (double)data->sample_rate / sample_rate : 1.0;
+	const double start = (double)loop_points->start * ratio + 0.5;
+	double end = loop_points->length != 0 ? ((double)loop_points->start + (double)loop_points->length) * ratio + 0.5 : (double)total_frames;
+
+	// The resampler may have rounded the length of the data down
+	if (end > (double)total_frames)
+		end = (double)total_frames;
+
+	LoopPoints_Init(&data->loop_points);
+
+	// Loop points that do not fit are thrown away, leaving the whole sound to loop
+	if (start < end && (size_t)start < (size_t)end)
+	{
+		data->loop_points.start = (size_t)start;
+		data->loop_points.length = loop_points->length != 0 ? (size_t)end - (size_t)start : 0;
+	}
+}
+
+void Predecoder_GetLoopPoints(PredecoderData *data, LoopPoints *loop_points)
+{
+	*loop_points = data->loop_points;
+}
+
+const unsigned char* Predecoder_GetDecodedData(PredecoderData *data, size_t *decoded_data_size, unsigned long *sample_rate)
+{
+	*decoded_data_size = data->decoded_data_size;
+	*sample_rate = data->sample_rate;
+
+	return (const unsigned char*)data->decoded_data;
+}
+
 void Predecoder_UnloadData(PredecoderData *data)
 {
-	free(data->decoded_data);
+	if (data->file_mapping != NULL)
+		FileMapping_Close(data->file_mapping);
+	else
+		free(data->decoded_data);
+
 	free(data);
 }
 
-void* Predecoder_Create(PredecoderData *data, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec)
+void* Predecoder_Create(PredecoderData *data, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec, Pool *pool)
 {
 	(void)wanted_spec;
 
-	Predecoder *predecoder = (Predecoder*)malloc(sizeof(Predecoder));
+	Predecoder *predecoder = (Predecoder*)Pool_Alloc(pool, sizeof(Predecoder));
 
 	if (predecoder != NULL)
 	{
 		ROMemoryStream_Create(&predecoder->ro_memory_stream, data->decoded_data, data->decoded_data_size);
 
 		predecoder->loop = loop;
+		predecoder->loop_start = data->loop_points.start * SIZE_OF_FRAME;
+		predecoder->loop_end = data->loop_points.length != 0 ? (data->loop_points.start + data->loop_points.length) * SIZE_OF_FRAME : data->decoded_data_size;
 
 		spec->sample_rate = data->sample_rate;
 		spec->channel_count = CHANNEL_COUNT;
@@ -125,7 +464,7 @@ void Predecoder_Destroy(void *predecoder_void)
 
 	ROMemoryStream_Destroy(&predecoder->ro_memory_stream);
 
-	free(predecoder);
+	Pool_Free(predecoder);
 }
 
 void Predecoder_Rewind(void *predecoder_void)
@@ -135,6 +474,22 @@ void Predecoder_Rewind(void *predecoder_void)
 	ROMemoryStream_Rewind(&predecoder->ro_memory_stream);
 }
 
+// Limits `frames` to however many are left before the end of the loop, unless the sound is not looping, or has already passed that point
+static size_t FramesBeforeLoopEnd(Predecoder *predecoder, size_t frames)
+{
+	const size_t position = ROMemoryStream_GetPosition(&predecoder->ro_memory_stream);
+
+	if (predecoder->loop && position <= predecoder->loop_end)
+		frames = MIN(frames, (predecoder->loop_end - position) / SIZE_OF_FRAME);
+
+	return frames;
+}
+
+static void Loop(Predecoder *predecoder)
+{
+	ROMemoryStream_SetPosition(&predecoder->ro_memory_stream, (ptrdiff_t)predecoder->loop_start, MEMORYSTREAM_START);
+}
+
 size_t Predecoder_GetSamples(void *predecoder_void, short *buffer, size_t frames_to_do)
 {
 	Predecoder *predecoder = (Predecoder*)predecoder_void;
@@ -143,10 +498,10 @@ size_t Predecoder_GetSamples(void *predecoder_void, short *buffer, size_t frames
 
 	for (;;)
 	{
-		frames_done += ROMemoryStream_Read(&predecoder->ro_memory_stream, &buffer[frames_done * CHANNEL_COUNT], sizeof(short) * CHANNEL_COUNT, frames_to_do - frames_done);
+		frames_done += ROMemoryStream_Read(&predecoder->ro_memory_stream, &buffer[frames_done * CHANNEL_COUNT], SIZE_OF_FRAME, FramesBeforeLoopEnd(predecoder, frames_to_do - frames_done));
 
 		if (frames_done != frames_to_do && predecoder->loop)
-			Predecoder_Rewind(predecoder);
+			Loop(predecoder);
 		else
 			break;
 	}
@@ -154,6 +509,25 @@ size_t Predecoder_GetSamples(void *predecoder_void, short *buffer, size_t frames
 	return frames_done;
 }
 
+size_t Predecoder_ReadDirect(void *predecoder_void, const short **buffer, size_t frames_to_do)
+{
+	Predecoder *predecoder = (Predecoder*)predecoder_void;
+
+	size_t frames_done = FramesBeforeLoopEnd(predecoder, frames_to_do);
+	*buffer = (const short*)ROMemoryStream_ReadDirect(&predecoder->ro_memory_stream, SIZE_OF_FRAME, &frames_done);
+
+	// The data is not contiguous across the loop point, so the start of the loop is handed out separately
+	if (frames_done == 0 && predecoder->loop)
+	{
+		Loop(predecoder);
+
+		frames_done = FramesBeforeLoopEnd(predecoder, frames_to_do);
+		*buffer = (const short*)ROMemoryStream_ReadDirect(&predecoder->ro_memory_stream, SIZE_OF_FRAME, &frames_done);
+	}
+
+	return frames_done;
+}
+
 void Predecoder_SetLoop(void *predecoder_void, bool loop)
 {
 	Predecoder *predecoder = (Predecoder*)predecoder_void;
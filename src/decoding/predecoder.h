@@ -25,15 +25,32 @@
 #include <stddef.h>
 
 #include "decoders/common.h"
+#include "decoders/loop_points.h"
+
+#include "../file_mapping.h"
+#include "../pool.h"
 
 typedef struct PredecoderData PredecoderData;
 
-PredecoderData* Predecoder_DecodeData(const DecoderSpec *in_spec, const DecoderSpec *out_spec, DecoderStage *stage);
+// Lets `Predecoder_DecodeData` split a file into segments, and decode them on several threads at once
+typedef struct PredecoderSegmenter
+{
+	void *user_data;
+	size_t (*GetLength)(void *decoder); // Returns the length of the file in frames, or 0 if it is unknown
+	bool (*CreateStage)(void *user_data, size_t frame, DecoderStage *stage); // Creates another decoder for the file, starting at `frame`
+} PredecoderSegmenter;
+
+PredecoderData* Predecoder_DecodeData(const DecoderSpec *in_spec, const DecoderSpec *out_spec, DecoderStage *stage, const PredecoderSegmenter *segmenter); // `segmenter` can be NULL
+PredecoderData* Predecoder_CreateDataFromMapping(FileMapping *file_mapping, const unsigned char *decoded_data, size_t decoded_data_size, unsigned long sample_rate); // `decoded_data` must point into `file_mapping`, which is closed when the data is unloaded
+const unsigned char* Predecoder_GetDecodedData(PredecoderData *data, size_t *decoded_data_size, unsigned long *sample_rate);
+void Predecoder_SetLoopPoints(PredecoderData *data, const LoopPoints *loop_points, unsigned long sample_rate); // `sample_rate` is the one that the loop points were made for
+void Predecoder_GetLoopPoints(PredecoderData *data, LoopPoints *loop_points);
 void Predecoder_UnloadData(PredecoderData *data);
-void* Predecoder_Create(PredecoderData *data, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec);
+void* Predecoder_Create(PredecoderData *data, bool loop, const DecoderSpec *wanted_spec, DecoderSpec *spec, Pool *pool);
 void Predecoder_Destroy(void *predecoder);
 void Predecoder_Rewind(void *predecoder);
 size_t Predecoder_GetSamples(void *predecoder, short *buffer, size_t frames_to_do);
+size_t Predecoder_ReadDirect(void *predecoder, const short **buffer, size_t frames_to_do);
 void Predecoder_SetLoop(void *predecoder, bool loop);
 
 #endif // PREDECODER_H
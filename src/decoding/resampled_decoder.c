@@ -47,10 +47,9 @@
 
 #include "decoders/common.h"
 
-#ifdef CLOWNAUDIO_CLOWNRESAMPLER
-#else
-#define RESAMPLE_BUFFER_SIZE 0x1000
-#endif
+#include "../pool.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
 
 typedef struct ResampledDecoder
 {
@@ -64,10 +63,8 @@ typedef struct ResampledDecoder
 #ifdef CLOWNAUDIO_CLOWNRESAMPLER
 	ClownResampler_HighLevel_State clownresampler_state;
 #else
+	ma_allocation_callbacks allocation_callbacks;
 	ma_data_converter converter;
-	short buffer[RESAMPLE_BUFFER_SIZE];
-	size_t buffer_end;
-	size_t buffer_done;
 #endif
 } ResampledDecoder;
 
@@ -77,9 +74,30 @@ typedef struct ResamplerCallbackData
 	ResampledDecoder *resampled_decoder;
 	short *output_pointer;
 	size_t output_buffer_frames_remaining;
+	short *scratch;
 } ResamplerCallbackData;
 #endif
 
+#ifndef CLOWNAUDIO_CLOWNRESAMPLER
+// These let miniaudio allocate its resampler state from the same pool as everything else
+static void* PoolMallocCallback(size_t size, void *user_data)
+{
+	return Pool_Alloc((Pool*)user_data, size);
+}
+
+static void* PoolReallocCallback(void *pointer, size_t size, void *user_data)
+{
+	return Pool_Realloc((Pool*)user_data, pointer, size);
+}
+
+static void PoolFreeCallback(void *pointer, void *user_data)
+{
+	(void)user_data;
+
+	Pool_Free(pointer);
+}
+#endif
+
 #ifdef CLOWNAUDIO_CLOWNRESAMPLER
 static ClownResampler_Precomputed clownresampler_precomputed;
 static bool clownresampler_precomputed_done;
@@ -89,8 +107,6 @@ static size_t ResamplerInputCallback(void* const user_data, cc_s16l* const buffe
 	const ResamplerCallbackData* const callback_data = (ResamplerCallbackData*)user_data;
 	ResampledDecoder* const resampled_decoder = callback_data->resampled_decoder;
 
-	short temporary_buffer[0x400];
-
 	short *selected_buffer;
 	size_t selected_buffer_size;
 
@@ -101,11 +117,11 @@ static size_t ResamplerInputCallback(void* const user_data, cc_s16l* const buffe
 	}
 	else
 	{
-		selected_buffer = temporary_buffer;
-		selected_buffer_size = CLOWNRESAMPLER_MIN(buffer_size, CLOWNRESAMPLER_COUNT_OF(temporary_buffer) / resampled_decoder->in_channel_count);
+		selected_buffer = callback_data->scratch;
+		selected_buffer_size = CLOWNRESAMPLER_MIN(buffer_size, DECODER_SCRATCH_SIZE / resampled_decoder->in_channel_count);
 	}
 
-	const size_t frames_read = resampled_decoder->next_stage.GetSamples(resampled_decoder->next_stage.decoder, selected_buffer, selected_buffer_size);
+	const size_t frames_read = resampled_decoder->next_stage.GetSamples(resampled_decoder->next_stage.decoder, selected_buffer, selected_buffer_size, NULL);
 
 	const short *in_buffer_pointer = selected_buffer;
 	short *out_buffer_pointer = buffer;
@@ -159,9 +175,31 @@ static cc_bool ResamplerOutputCallback(void* const user_data, const cc_s32f* con
 	return --callback_data->output_buffer_frames_remaining != 0;
 }
 
+static bool InitResampler(ResampledDecoder *resampled_decoder, bool dynamic_sample_rate)
+{
+	if (dynamic_sample_rate)
+	{
+		/* Set a wide sample rate ratio so that the low-pass filter can be wildly-adjusted. */
+		if (ClownResampler_HighLevel_Init(&resampled_decoder->clownresampler_state, resampled_decoder->out_channel_count, 0x100, 1, resampled_decoder->low_pass_filter_sample_rate))
+		{
+			/* Apply the actual sample rates. */
+			if (ClownResampler_HighLevel_Adjust(&resampled_decoder->clownresampler_state, resampled_decoder->in_sample_rate_scaled, resampled_decoder->out_sample_rate, resampled_decoder->low_pass_filter_sample_rate))
+				return true;
+		}
+	}
+	else
+	{
+		/* Just do things the normal way. */
+		if (ClownResampler_HighLevel_Init(&resampled_decoder->clownresampler_state, resampled_decoder->out_channel_count, resampled_decoder->in_sample_rate_scaled, resampled_decoder->out_sample_rate, resampled_decoder->low_pass_filter_sample_rate))
+			return true;
+	}
+
+	return false;
+}
+
 #endif
 
-void* ResampledDecoder_Create(DecoderStage *next_stage, bool dynamic_sample_rate, const DecoderSpec *wanted_spec, const DecoderSpec *child_spec)
+void* ResampledDecoder_Create(DecoderStage *next_stage, bool dynamic_sample_rate, const DecoderSpec *wanted_spec, const DecoderSpec *child_spec, Pool *pool)
 {
 #ifdef CLOWNAUDIO_CLOWNRESAMPLER
 	if (!clownresampler_precomputed_done)
@@ -177,7 +215,7 @@ void* ResampledDecoder_Create(DecoderStage *next_stage, bool dynamic_sample_rate
 
 //	if (decoder != NULL)
 	{
-		ResampledDecoder *resampled_decoder = (ResampledDecoder*)malloc(sizeof(ResampledDecoder));
+		ResampledDecoder *resampled_decoder = (ResampledDecoder*)Pool_Alloc(pool, sizeof(ResampledDecoder));
 
 		if (resampled_decoder != NULL)
 		{
@@ -190,38 +228,24 @@ void* ResampledDecoder_Create(DecoderStage *next_stage, bool dynamic_sample_rate
 			resampled_decoder->out_channel_count = wanted_spec->channel_count;
 
 		#ifdef CLOWNAUDIO_CLOWNRESAMPLER
-			if (dynamic_sample_rate)
-			{
-				/* Set a wide sample rate ratio so that the low-pass filter can be wildly-adjusted. */
-				if (ClownResampler_HighLevel_Init(&resampled_decoder->clownresampler_state, resampled_decoder->out_channel_count, 0x100, 1, resampled_decoder->low_pass_filter_sample_rate))
-				{
-					/* Apply the actual sample rates. */
-					if (ClownResampler_HighLevel_Adjust(&resampled_decoder->clownresampler_state, resampled_decoder->in_sample_rate_scaled, resampled_decoder->out_sample_rate, resampled_decoder->low_pass_filter_sample_rate))
-						return resampled_decoder;
-				}
-			}
-			else
-			{
-				/* Just do things the normal way. */
-				if (ClownResampler_HighLevel_Init(&resampled_decoder->clownresampler_state, resampled_decoder->out_channel_count, resampled_decoder->in_sample_rate_scaled, resampled_decoder->out_sample_rate, resampled_decoder->low_pass_filter_sample_rate))
-					return resampled_decoder;
-			}
+			if (InitResampler(resampled_decoder, dynamic_sample_rate))
+				return resampled_decoder;
 		#else
 			ma_data_converter_config config = ma_data_converter_config_init(ma_format_s16, ma_format_s16, child_spec->channel_count, wanted_spec->channel_count, resampled_decoder->in_sample_rate, resampled_decoder->out_sample_rate);
 
 			if (dynamic_sample_rate)
 				config.allowDynamicSampleRate = MA_TRUE;
 
-			if (ma_data_converter_init(&config, NULL, &resampled_decoder->converter) == MA_SUCCESS)
-			{
-				resampled_decoder->buffer_end = 0;
-				resampled_decoder->buffer_done = 0;
+			resampled_decoder->allocation_callbacks.pUserData = pool;
+			resampled_decoder->allocation_callbacks.onMalloc = PoolMallocCallback;
+			resampled_decoder->allocation_callbacks.onRealloc = PoolReallocCallback;
+			resampled_decoder->allocation_callbacks.onFree = PoolFreeCallback;
 
+			if (ma_data_converter_init(&config, &resampled_decoder->allocation_callbacks, &resampled_decoder->converter) == MA_SUCCESS)
 				return resampled_decoder;
-			}
 		#endif
 
-			free(resampled_decoder);
+			Pool_Free(resampled_decoder);
 		}
 	}
 
@@ -234,10 +258,10 @@ void ResampledDecoder_Destroy(void *resampled_decoder_void)
 
 #ifdef CLOWNAUDIO_CLOWNRESAMPLER
 #else
-	ma_data_converter_uninit(&resampled_decoder->converter, NULL);
+	ma_data_converter_uninit(&resampled_decoder->converter, &resampled_decoder->allocation_callbacks);
 #endif
 	resampled_decoder->next_stage.Destroy(resampled_decoder->next_stage.decoder);
-	free(resampled_decoder);
+	Pool_Free(resampled_decoder);
 }
 
 void ResampledDecoder_Rewind(void *resampled_decoder_void)
@@ -247,7 +271,7 @@ void ResampledDecoder_Rewind(void *resampled_decoder_void)
 	resampled_decoder->next_stage.Rewind(resampled_decoder->next_stage.decoder);
 }
 
-size_t ResampledDecoder_GetSamples(void *resampled_decoder_void, short *buffer, size_t frames_to_do)
+size_t ResampledDecoder_GetSamples(void *resampled_decoder_void, short *buffer, size_t frames_to_do, short *scratch)
 {
 	ResampledDecoder *resampled_decoder = (ResampledDecoder*)resampled_decoder_void;
 
@@ -256,6 +280,7 @@ size_t ResampledDecoder_GetSamples(void *resampled_decoder_void, short *buffer,
 	callback_data.resampled_decoder = resampled_decoder;
 	callback_data.output_pointer = buffer;
 	callback_data.output_buffer_frames_remaining = frames_to_do;
+	callback_data.scratch = scratch;
 
 	ClownResampler_HighLevel_Resample(&resampled_decoder->clownresampler_state, &clownresampler_precomputed, ResamplerInputCallback, ResamplerOutputCallback, &callback_data);
 
@@ -265,22 +290,29 @@ size_t ResampledDecoder_GetSamples(void *resampled_decoder_void, short *buffer,
 
 	while (frames_done != frames_to_do)
 	{
-		if (resampled_decoder->buffer_done == resampled_decoder->buffer_end)
-		{
-			resampled_decoder->buffer_done = 0;
+		// The input is staged in the caller's scratch, which is gone once this returns, so only as much is read as the
+		// resampler needs for the output that is left. The resampler consumes all of it, keeping its history internally.
+		ma_uint64 frames_required;
+		ma_data_converter_get_required_input_frame_count(&resampled_decoder->converter, (ma_uint64)(frames_to_do - frames_done), &frames_required);
+
+		size_t frames_read = (size_t)MIN(frames_required, (ma_uint64)(DECODER_SCRATCH_SIZE / resampled_decoder->in_channel_count));
 
-			resampled_decoder->buffer_end = resampled_decoder->next_stage.GetSamples(resampled_decoder->next_stage.decoder, resampled_decoder->buffer, RESAMPLE_BUFFER_SIZE / resampled_decoder->in_channel_count);
+		if (frames_read != 0)
+		{
+			frames_read = resampled_decoder->next_stage.GetSamples(resampled_decoder->next_stage.decoder, scratch, frames_read, NULL);
 
-			if (resampled_decoder->buffer_end == 0)
+			if (frames_read == 0)
 				break;	// Sample end
 		}
 
-		ma_uint64 frames_in = (ma_uint64)(resampled_decoder->buffer_end - resampled_decoder->buffer_done);
+		ma_uint64 frames_in = (ma_uint64)frames_read;
 		ma_uint64 frames_out = (ma_uint64)(frames_to_do - frames_done);
-		ma_data_converter_process_pcm_frames(&resampled_decoder->converter, &resampled_decoder->buffer[resampled_decoder->buffer_done * resampled_decoder->in_channel_count], &frames_in, &buffer[frames_done * resampled_decoder->out_channel_count], &frames_out);
+		ma_data_converter_process_pcm_frames(&resampled_decoder->converter, scratch, &frames_in, &buffer[frames_done * resampled_decoder->out_channel_count], &frames_out);
 
-		resampled_decoder->buffer_done += (size_t)frames_in;
 		frames_done += (size_t)frames_out;
+
+		if (frames_in == 0 && frames_out == 0)
+			break;	// The resampler has nothing more to give
 	}
 
 	return frames_done;
@@ -26,10 +26,12 @@
 
 #include "decoders/common.h"
 
-void* ResampledDecoder_Create(DecoderStage *next_stage, bool dynamic_sample_rate, const DecoderSpec *wanted_spec, const DecoderSpec *child_spec);
+#include "../pool.h"
+
+void* ResampledDecoder_Create(DecoderStage *next_stage, bool dynamic_sample_rate, const DecoderSpec *wanted_spec, const DecoderSpec *child_spec, Pool *pool);
 void ResampledDecoder_Destroy(void *resampled_decoder);
 void ResampledDecoder_Rewind(void *resampled_decoder);
-size_t ResampledDecoder_GetSamples(void *resampled_decoder, short *buffer, size_t frames_to_do);
+size_t ResampledDecoder_GetSamples(void *resampled_decoder, short *buffer, size_t frames_to_do, short *scratch);
 void ResampledDecoder_SetLoop(void *resampled_decoder, bool loop);
 void ResampledDecoder_SetSpeed(void *resampled_decoder, unsigned long speed);
 void ResampledDecoder_SetLowPassFilter(void *resampled_decoder, unsigned long low_pass_filter_sample_rate);
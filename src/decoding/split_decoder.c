@@ -27,6 +27,8 @@
 
 #include "decoders/common.h"
 
+#include "../pool.h"
+
 typedef struct SplitDecoder
 {
 	DecoderStage next_stage[2];
@@ -35,11 +37,11 @@ typedef struct SplitDecoder
 	bool last_decoder;
 } SplitDecoder;
 
-void* SplitDecoder_Create(DecoderStage *next_stage_intro, DecoderStage *next_stage_loop, unsigned int channel_count)
+void* SplitDecoder_Create(DecoderStage *next_stage_intro, DecoderStage *next_stage_loop, unsigned int channel_count, Pool *pool)
 {
 	assert(next_stage_intro != NULL && next_stage_loop != NULL);
 
-	SplitDecoder *split_decoder = (SplitDecoder*)malloc(sizeof(SplitDecoder));
+	SplitDecoder *split_decoder = (SplitDecoder*)Pool_Alloc(pool, sizeof(SplitDecoder));
 
 	if (split_decoder != NULL)
 	{
@@ -61,7 +63,7 @@ void SplitDecoder_Destroy(void *split_decoder_void)
 	split_decoder->next_stage[0].Destroy(split_decoder->next_stage[0].decoder);
 	split_decoder->next_stage[1].Destroy(split_decoder->next_stage[1].decoder);
 
-	free(split_decoder);
+	Pool_Free(split_decoder);
 }
 
 void SplitDecoder_Rewind(void *split_decoder_void)
@@ -75,7 +77,7 @@ void SplitDecoder_Rewind(void *split_decoder_void)
 	split_decoder->next_stage[1].Rewind(split_decoder->next_stage[1].decoder);
 }
 
-size_t SplitDecoder_GetSamples(void *split_decoder_void, short *buffer, size_t frames_to_do)
+size_t SplitDecoder_GetSamples(void *split_decoder_void, short *buffer, size_t frames_to_do, short *scratch)
 {
 	SplitDecoder *split_decoder = (SplitDecoder*)split_decoder_void;
 
@@ -83,7 +85,7 @@ size_t SplitDecoder_GetSamples(void *split_decoder_void, short *buffer, size_t f
 
 	for (;;)
 	{
-		frames_done += split_decoder->next_stage[split_decoder->current_decoder].GetSamples(split_decoder->next_stage[split_decoder->current_decoder].decoder, &buffer[frames_done * split_decoder->channel_count], frames_to_do - frames_done);
+		frames_done += split_decoder->next_stage[split_decoder->current_decoder].GetSamples(split_decoder->next_stage[split_decoder->current_decoder].decoder, &buffer[frames_done * split_decoder->channel_count], frames_to_do - frames_done, scratch);
 
 		if (frames_done != frames_to_do && !split_decoder->last_decoder)
 		{
@@ -99,6 +101,26 @@ size_t SplitDecoder_GetSamples(void *split_decoder_void, short *buffer, size_t f
 	return frames_done;
 }
 
+size_t SplitDecoder_ReadDirect(void *split_decoder_void, const short **buffer, size_t frames_to_do)
+{
+	SplitDecoder *split_decoder = (SplitDecoder*)split_decoder_void;
+
+	for (;;)
+	{
+		const size_t frames_done = split_decoder->next_stage[split_decoder->current_decoder].ReadDirect(split_decoder->next_stage[split_decoder->current_decoder].decoder, buffer, frames_to_do);
+
+		if (frames_done == 0 && !split_decoder->last_decoder)
+		{
+			split_decoder->current_decoder = 1;
+			split_decoder->last_decoder = true;
+		}
+		else
+		{
+			return frames_done;
+		}
+	}
+}
+
 void SplitDecoder_SetLoop(void *split_decoder_void, bool loop)
 {
 	SplitDecoder *split_decoder = (SplitDecoder*)split_decoder_void;
@@ -27,10 +27,13 @@
 
 #include "decoders/common.h"
 
-void* SplitDecoder_Create(DecoderStage *next_stage_intro, DecoderStage *next_stage_loop, unsigned int channel_count);
+#include "../pool.h"
+
+void* SplitDecoder_Create(DecoderStage *next_stage_intro, DecoderStage *next_stage_loop, unsigned int channel_count, Pool *pool);
 void SplitDecoder_Destroy(void *split_decoder);
 void SplitDecoder_Rewind(void *split_decoder);
-size_t SplitDecoder_GetSamples(void *split_decoder, short *buffer, size_t frames_to_do);
+size_t SplitDecoder_GetSamples(void *split_decoder, short *buffer, size_t frames_to_do, short *scratch);
+size_t SplitDecoder_ReadDirect(void *split_decoder, const short **buffer, size_t frames_to_do); // Only usable if both of the next stages support `ReadDirect`
 void SplitDecoder_SetLoop(void *split_decoder, bool loop);
 void SplitDecoder_SetSampleRate(void *split_decoder, unsigned long sample_rate);
 
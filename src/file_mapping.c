@@ -0,0 +1,172 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+ #define _POSIX_C_SOURCE 200112L	// For `posix_madvise`
+#endif
+
+#include "file_mapping.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+ #define FILE_MAPPING_WINDOWS
+ #define WIN32_LEAN_AND_MEAN
+ #include <windows.h>
+#elif defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+ #define FILE_MAPPING_POSIX
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+#endif
+
+struct FileMapping
+{
+	void *data;
+	size_t size;
+#if defined(FILE_MAPPING_WINDOWS)
+	HANDLE file;
+	HANDLE mapping;
+#endif
+};
+
+FileMapping* FileMapping_Open(const char *path, const unsigned char **data, size_t *size)
+{
+	FileMapping *file_mapping = (FileMapping*)malloc(sizeof(FileMapping));
+
+	if (file_mapping != NULL)
+	{
+	#if defined(FILE_MAPPING_WINDOWS)
+		file_mapping->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+		if (file_mapping->file != INVALID_HANDLE_VALUE)
+		{
+			LARGE_INTEGER file_size;
+
+			if (GetFileSizeEx(file_mapping->file, &file_size) && file_size.QuadPart > 0 && (LONGLONG)(size_t)file_size.QuadPart == file_size.QuadPart)
+			{
+				file_mapping->mapping = CreateFileMappingA(file_mapping->file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+				if (file_mapping->mapping != NULL)
+				{
+					file_mapping->data = MapViewOfFile(file_mapping->mapping, FILE_MAP_READ, 0, 0, 0);
+
+					if (file_mapping->data != NULL)
+					{
+						file_mapping->size = (size_t)file_size.QuadPart;
+
+						*data = (const unsigned char*)file_mapping->data;
+						*size = file_mapping->size;
+
+						return file_mapping;
+					}
+
+					CloseHandle(file_mapping->mapping);
+				}
+			}
+
+			CloseHandle(file_mapping->file);
+		}
+	#elif defined(FILE_MAPPING_POSIX)
+		int file = open(path, O_RDONLY);
+
+		if (file != -1)
+		{
+			struct stat file_status;
+
+			// The size check makes sure that the file is not too big to fit in the address space
+			if (fstat(file, &file_status) == 0 && file_status.st_size > 0 && (off_t)(size_t)file_status.st_size == file_status.st_size)
+			{
+				file_mapping->size = (size_t)file_status.st_size;
+				file_mapping->data = mmap(NULL, file_mapping->size, PROT_READ, MAP_PRIVATE, file, 0);
+
+				if (file_mapping->data != MAP_FAILED)
+				{
+					// The mapping keeps the file open by itself
+					close(file);
+
+					// Decoders mostly read their files from start to end, so have the OS read ahead of them
+					posix_madvise(file_mapping->data, file_mapping->size, POSIX_MADV_SEQUENTIAL);
+
+					*data = (const unsigned char*)file_mapping->data;
+					*size = file_mapping->size;
+
+					return file_mapping;
+				}
+			}
+
+			close(file);
+		}
+	#else
+		FILE *file = fopen(path, "rb");
+
+		if (file != NULL)
+		{
+			fseek(file, 0, SEEK_END);
+			const long file_size = ftell(file);
+			rewind(file);
+
+			if (file_size > 0)
+			{
+				file_mapping->size = (size_t)file_size;
+				file_mapping->data = malloc(file_mapping->size);
+
+				if (file_mapping->data != NULL)
+				{
+					if (fread(file_mapping->data, 1, file_mapping->size, file) == file_mapping->size)
+					{
+						fclose(file);
+
+						*data = (const unsigned char*)file_mapping->data;
+						*size = file_mapping->size;
+
+						return file_mapping;
+					}
+
+					free(file_mapping->data);
+				}
+			}
+
+			fclose(file);
+		}
+	#endif
+
+		free(file_mapping);
+	}
+
+	return NULL;
+}
+
+void FileMapping_Close(FileMapping *file_mapping)
+{
+#if defined(FILE_MAPPING_WINDOWS)
+	UnmapViewOfFile(file_mapping->data);
+	CloseHandle(file_mapping->mapping);
+	CloseHandle(file_mapping->file);
+#elif defined(FILE_MAPPING_POSIX)
+	munmap(file_mapping->data, file_mapping->size);
+#else
+	free(file_mapping->data);
+#endif
+
+	free(file_mapping);
+}
@@ -0,0 +1,33 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#ifndef FILE_MAPPING_H
+#define FILE_MAPPING_H
+
+#include <stddef.h>
+
+typedef struct FileMapping FileMapping;
+
+// Makes a whole file readable from memory. Where the OS allows it, the file is mapped rather than read,
+// so its pages are only loaded when they are used, and can be dropped again when memory is low.
+// Elsewhere, the file is just read into a buffer. Empty files cannot be opened.
+FileMapping* FileMapping_Open(const char *path, const unsigned char **data, size_t *size);
+void FileMapping_Close(FileMapping *file_mapping);
+
+#endif // FILE_MAPPING_H
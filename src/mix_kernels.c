@@ -0,0 +1,683 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "mix_kernels.h"
+
+#include <limits.h>
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+#include <stddef.h>
+
+#define CHANNEL_COUNT 2
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define CLAMP(x, min, max) (MIN((max), MAX((min), (x))))
+
+#define SCALE(x, scale) (((x) * (scale)) / 0x100)
+
+#define FLOAT_SCALE (1.0f / 0x8000)	// Float samples use a range of -1.0 to 1.0, which is -0x8000 to 0x8000 in S16 terms
+#define FLOAT_VOLUME_SCALE (FLOAT_SCALE / 0x100)	// Converts a sample to float while scaling it by a volume
+
+// `long` is 32-bit on Windows and 32-bit platforms, but 64-bit pretty much everywhere else
+#if LONG_MAX > 0x7FFFFFFFL
+ #define LONG_IS_64_BIT
+#endif
+
+#ifdef CLOWNAUDIO_SIMD
+ #if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #define MIX_KERNELS_SSE2
+
+  // AVX2 code lives alongside everything else, so the compiler needs to be able to target it on a per-function basis
+  #if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))) || (defined(_MSC_VER) && _MSC_VER >= 1800)
+   #define MIX_KERNELS_AVX2
+  #endif
+ #elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+  #define MIX_KERNELS_NEON
+ #endif
+#endif
+
+#if defined(MIX_KERNELS_SSE2) || defined(MIX_KERNELS_AVX2)
+ #ifdef _MSC_VER
+  #include <intrin.h>
+ #endif
+ #include <immintrin.h>
+
+ #ifdef __GNUC__
+  #define TARGET_SSE2 __attribute__((target("sse2")))
+  #define TARGET_AVX2 __attribute__((target("avx2")))
+ #else
+  #define TARGET_SSE2
+  #define TARGET_AVX2
+ #endif
+#endif
+
+#ifdef MIX_KERNELS_NEON
+ #include <arm_neon.h>
+ #include <stdint.h>
+#endif
+
+
+//////////
+// Scalar
+//////////
+
+static void Mix_Scalar(long *output_buffer, const short *input_buffer, size_t frames_to_do)
+{
+	for (size_t i = 0; i < frames_to_do * CHANNEL_COUNT; ++i)
+		output_buffer[i] += input_buffer[i];
+}
+
+static void MixVolume_Scalar(long *output_buffer, const short *input_buffer, size_t frames_to_do, unsigned short volume_left, unsigned short volume_right)
+{
+	for (size_t i = 0; i < frames_to_do; ++i)
+	{
+		*output_buffer++ += SCALE(*input_buffer++, volume_left);
+		*output_buffer++ += SCALE(*input_buffer++, volume_right);
+	}
+}
+
+static void MixVolumeRamp_Scalar(long *output_buffer, const short *input_buffer, size_t frames_to_do, const unsigned short *volumes)
+{
+	for (size_t i = 0; i < frames_to_do * CHANNEL_COUNT; ++i)
+		output_buffer[i] += SCALE(input_buffer[i], volumes[i]);
+}
+
+static void ClampToS16_Scalar(short *output_buffer, const long *input_buffer, size_t samples_to_do)
+{
+	for (size_t i = 0; i < samples_to_do; ++i)
+	{
+		const long mix_sample = input_buffer[i];
+
+		output_buffer[i] = (short)CLAMP(mix_sample, -0x7FFF, 0x7FFF);
+	}
+}
+
+static void MixFloat_Scalar(float *output_buffer, const short *input_buffer, size_t frames_to_do)
+{
+	for (size_t i = 0; i < frames_to_do * CHANNEL_COUNT; ++i)
+		output_buffer[i] += input_buffer[i] * FLOAT_SCALE;
+}
+
+static void MixVolumeFloat_Scalar(float *output_buffer, const short *input_buffer, size_t frames_to_do, unsigned short volume_left, unsigned short volume_right)
+{
+	const float scale_left = volume_left * FLOAT_VOLUME_SCALE;
+	const float scale_right = volume_right * FLOAT_VOLUME_SCALE;
+
+	for (size_t i = 0; i < frames_to_do; ++i)
+	{
+		*output_buffer++ += *input_buffer++ * scale_left;
+		*output_buffer++ += *input_buffer++ * scale_right;
+	}
+}
+
+static void MixVolumeRampFloat_Scalar(float *output_buffer, const short *input_buffer, size_t frames_to_do, const unsigned short *volumes)
+{
+	for (size_t i = 0; i < frames_to_do * CHANNEL_COUNT; ++i)
+		output_buffer[i] += input_buffer[i] * (volumes[i] * FLOAT_VOLUME_SCALE);
+}
+
+static const MixKernels kernels_scalar = {
+	Mix_Scalar,
+	MixVolume_Scalar,
+	MixVolumeRamp_Scalar,
+	ClampToS16_Scalar,
+	MixFloat_Scalar,
+	MixVolumeFloat_Scalar,
+	MixVolumeRampFloat_Scalar
+};
+
+
+////////
+// SSE2
+////////
+
+#ifdef MIX_KERNELS_SSE2
+
+// Adds four 32-bit samples to four `long`s
+TARGET_SSE2 static void Accumulate_SSE2(long *output_buffer, __m128i samples)
+{
+	__m128i *output_vector = (__m128i*)output_buffer;
+
+#ifdef LONG_IS_64_BIT
+	const __m128i sign = _mm_srai_epi32(samples, 31);
+
+	_mm_storeu_si128(&output_vector[0], _mm_add_epi64(_mm_loadu_si128(&output_vector[0]), _mm_unpacklo_epi32(samples, sign)));
+	_mm_storeu_si128(&output_vector[1], _mm_add_epi64(_mm_loadu_si128(&output_vector[1]), _mm_unpackhi_epi32(samples, sign)));
+#else
+	_mm_storeu_si128(output_vector, _mm_add_epi32(_mm_loadu_si128(output_vector), samples));
+#endif
+}
+
+// Divides by 0x100, rounding towards zero like C's division does
+TARGET_SSE2 static __m128i DivideBy0x100_SSE2(__m128i products)
+{
+	return _mm_srai_epi32(_mm_add_epi32(products, _mm_and_si128(_mm_srai_epi32(products, 31), _mm_set1_epi32(0xFF))), 8);
+}
+
+// Scales eight samples by eight volumes, and adds them to the output buffer
+TARGET_SSE2 static void MixVolume8_SSE2(long *output_buffer, __m128i samples, __m128i volumes)
+{
+	const __m128i low = _mm_mullo_epi16(samples, volumes);
+	// `_mm_mulhi_epi16` treats the volumes as signed, so the upper half needs correcting for volumes of 0x8000 and above
+	const __m128i high = _mm_add_epi16(_mm_mulhi_epi16(samples, volumes), _mm_and_si128(samples, _mm_srai_epi16(volumes, 15)));
+
+	Accumulate_SSE2(&output_buffer[0], DivideBy0x100_SSE2(_mm_unpacklo_epi16(low, high)));
+	Accumulate_SSE2(&output_buffer[4], DivideBy0x100_SSE2(_mm_unpackhi_epi16(low, high)));
+}
+
+TARGET_SSE2 static void Mix_SSE2(long *output_buffer, const short *input_buffer, size_t frames_to_do)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)3;
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 8)
+	{
+		const __m128i samples = _mm_loadu_si128((const __m128i*)&input_buffer[i]);
+
+		// Sign-extend to 32-bit
+		Accumulate_SSE2(&output_buffer[i + 0], _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+		Accumulate_SSE2(&output_buffer[i + 4], _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16));
+	}
+
+	Mix_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames);
+}
+
+TARGET_SSE2 static void MixVolume_SSE2(long *output_buffer, const short *input_buffer, size_t frames_to_do, unsigned short volume_left, unsigned short volume_right)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)3;
+	const __m128i volumes = _mm_set1_epi32((int)((unsigned int)volume_left | ((unsigned int)volume_right << 16)));
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 8)
+		MixVolume8_SSE2(&output_buffer[i], _mm_loadu_si128((const __m128i*)&input_buffer[i]), volumes);
+
+	MixVolume_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames, volume_left, volume_right);
+}
+
+TARGET_SSE2 static void MixVolumeRamp_SSE2(long *output_buffer, const short *input_buffer, size_t frames_to_do, const unsigned short *volumes)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)3;
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 8)
+		MixVolume8_SSE2(&output_buffer[i], _mm_loadu_si128((const __m128i*)&input_buffer[i]), _mm_loadu_si128((const __m128i*)&volumes[i]));
+
+	MixVolumeRamp_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames, &volumes[vector_frames * CHANNEL_COUNT]);
+}
+
+#ifdef LONG_IS_64_BIT
+// Saturates four 64-bit samples to 32-bit
+TARGET_SSE2 static __m128i SaturateToS32_SSE2(const long *input_buffer)
+{
+	// Separate the lower and upper halves of each sample
+	const __m128i a = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&input_buffer[0]), _MM_SHUFFLE(3, 1, 2, 0));
+	const __m128i b = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&input_buffer[2]), _MM_SHUFFLE(3, 1, 2, 0));
+	const __m128i low = _mm_unpacklo_epi64(a, b);
+	const __m128i high = _mm_unpackhi_epi64(a, b);
+
+	// If the upper half is just the sign-extension of the lower half, then the sample already fits
+	const __m128i fits = _mm_cmpeq_epi32(high, _mm_srai_epi32(low, 31));
+	const __m128i saturated = _mm_xor_si128(_mm_srai_epi32(high, 31), _mm_set1_epi32(0x7FFFFFFF));
+
+	return _mm_or_si128(_mm_and_si128(fits, low), _mm_andnot_si128(fits, saturated));
+}
+#endif
+
+TARGET_SSE2 static void ClampToS16_SSE2(short *output_buffer, const long *input_buffer, size_t samples_to_do)
+{
+	const size_t vector_samples = samples_to_do & ~(size_t)7;
+
+	for (size_t i = 0; i < vector_samples; i += 8)
+	{
+	#ifdef LONG_IS_64_BIT
+		const __m128i packed = _mm_packs_epi32(SaturateToS32_SSE2(&input_buffer[i + 0]), SaturateToS32_SSE2(&input_buffer[i + 4]));
+	#else
+		const __m128i packed = _mm_packs_epi32(_mm_loadu_si128((const __m128i*)&input_buffer[i + 0]), _mm_loadu_si128((const __m128i*)&input_buffer[i + 4]));
+	#endif
+
+		// Packing saturates to -0x8000, but we want -0x7FFF
+		_mm_storeu_si128((__m128i*)&output_buffer[i], _mm_max_epi16(packed, _mm_set1_epi16(-0x7FFF)));
+	}
+
+	ClampToS16_Scalar(&output_buffer[vector_samples], &input_buffer[vector_samples], samples_to_do - vector_samples);
+}
+
+// Converts eight samples to float, scales them, and adds them to the output buffer
+TARGET_SSE2 static void MixFloat8_SSE2(float *output_buffer, __m128i samples, __m128 scales_low, __m128 scales_high)
+{
+	// Sign-extend to 32-bit
+	const __m128 low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+	const __m128 high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16));
+
+	_mm_storeu_ps(&output_buffer[0], _mm_add_ps(_mm_loadu_ps(&output_buffer[0]), _mm_mul_ps(low, scales_low)));
+	_mm_storeu_ps(&output_buffer[4], _mm_add_ps(_mm_loadu_ps(&output_buffer[4]), _mm_mul_ps(high, scales_high)));
+}
+
+TARGET_SSE2 static void MixFloat_SSE2(float *output_buffer, const short *input_buffer, size_t frames_to_do)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)3;
+	const __m128 scales = _mm_set1_ps(FLOAT_SCALE);
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 8)
+		MixFloat8_SSE2(&output_buffer[i], _mm_loadu_si128((const __m128i*)&input_buffer[i]), scales, scales);
+
+	MixFloat_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames);
+}
+
+TARGET_SSE2 static void MixVolumeFloat_SSE2(float *output_buffer, const short *input_buffer, size_t frames_to_do, unsigned short volume_left, unsigned short volume_right)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)3;
+	const float scale_left = volume_left * FLOAT_VOLUME_SCALE;
+	const float scale_right = volume_right * FLOAT_VOLUME_SCALE;
+	const __m128 scales = _mm_setr_ps(scale_left, scale_right, scale_left, scale_right);
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 8)
+		MixFloat8_SSE2(&output_buffer[i], _mm_loadu_si128((const __m128i*)&input_buffer[i]), scales, scales);
+
+	MixVolumeFloat_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames, volume_left, volume_right);
+}
+
+TARGET_SSE2 static void MixVolumeRampFloat_SSE2(float *output_buffer, const short *input_buffer, size_t frames_to_do, const unsigned short *volumes)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)3;
+	const __m128 volume_scale = _mm_set1_ps(FLOAT_VOLUME_SCALE);
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 8)
+	{
+		// Zero-extend the volumes to 32-bit
+		const __m128i volume_vector = _mm_loadu_si128((const __m128i*)&volumes[i]);
+		const __m128 scales_low = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(volume_vector, _mm_setzero_si128())), volume_scale);
+		const __m128 scales_high = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(volume_vector, _mm_setzero_si128())), volume_scale);
+
+		MixFloat8_SSE2(&output_buffer[i], _mm_loadu_si128((const __m128i*)&input_buffer[i]), scales_low, scales_high);
+	}
+
+	MixVolumeRampFloat_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames, &volumes[vector_frames * CHANNEL_COUNT]);
+}
+
+static const MixKernels kernels_sse2 = {
+	Mix_SSE2,
+	MixVolume_SSE2,
+	MixVolumeRamp_SSE2,
+	ClampToS16_SSE2,
+	MixFloat_SSE2,
+	MixVolumeFloat_SSE2,
+	MixVolumeRampFloat_SSE2
+};
+
+#endif
+
+
+////////
+// AVX2
+////////
+
+#ifdef MIX_KERNELS_AVX2
+
+// Adds eight 32-bit samples to eight `long`s
+TARGET_AVX2 static void Accumulate_AVX2(long *output_buffer, __m256i samples)
+{
+	__m256i *output_vector = (__m256i*)output_buffer;
+
+#ifdef LONG_IS_64_BIT
+	_mm256_storeu_si256(&output_vector[0], _mm256_add_epi64(_mm256_loadu_si256(&output_vector[0]), _mm256_cvtepi32_epi64(_mm256_castsi256_si128(samples))));
+	_mm256_storeu_si256(&output_vector[1], _mm256_add_epi64(_mm256_loadu_si256(&output_vector[1]), _mm256_cvtepi32_epi64(_mm256_extracti128_si256(samples, 1))));
+#else
+	_mm256_storeu_si256(output_vector, _mm256_add_epi32(_mm256_loadu_si256(output_vector), samples));
+#endif
+}
+
+// Scales eight samples by eight volumes, and adds them to the output buffer
+TARGET_AVX2 static void MixVolume8_AVX2(long *output_buffer, const short *input_buffer, __m128i volumes)
+{
+	const __m256i products = _mm256_mullo_epi32(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)input_buffer)), _mm256_cvtepu16_epi32(volumes));
+
+	// Divide by 0x100, rounding towards zero like C's division does
+	Accumulate_AVX2(output_buffer, _mm256_srai_epi32(_mm256_add_epi32(products, _mm256_and_si256(_mm256_srai_epi32(products, 31), _mm256_set1_epi32(0xFF))), 8));
+}
+
+TARGET_AVX2 static void Mix_AVX2(long *output_buffer, const short *input_buffer, size_t frames_to_do)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)3;
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 8)
+		Accumulate_AVX2(&output_buffer[i], _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)&input_buffer[i])));
+
+	Mix_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames);
+}
+
+TARGET_AVX2 static void MixVolume_AVX2(long *output_buffer, const short *input_buffer, size_t frames_to_do, unsigned short volume_left, unsigned short volume_right)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)3;
+	const __m128i volumes = _mm_set1_epi32((int)((unsigned int)volume_left | ((unsigned int)volume_right << 16)));
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 8)
+		MixVolume8_AVX2(&output_buffer[i], &input_buffer[i], volumes);
+
+	MixVolume_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames, volume_left, volume_right);
+}
+
+TARGET_AVX2 static void MixVolumeRamp_AVX2(long *output_buffer, const short *input_buffer, size_t frames_to_do, const unsigned short *volumes)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)3;
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 8)
+		MixVolume8_AVX2(&output_buffer[i], &input_buffer[i], _mm_loadu_si128((const __m128i*)&volumes[i]));
+
+	MixVolumeRamp_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames, &volumes[vector_frames * CHANNEL_COUNT]);
+}
+
+#ifdef LONG_IS_64_BIT
+// Clamps four 64-bit samples to 16-bit range, and narrows them to 32-bit
+TARGET_AVX2 static __m128i ClampToS16Range_AVX2(const long *input_buffer)
+{
+	const __m256i minimum = _mm256_set1_epi64x(-0x7FFF);
+	const __m256i maximum = _mm256_set1_epi64x(0x7FFF);
+
+	__m256i samples = _mm256_loadu_si256((const __m256i*)input_buffer);
+	samples = _mm256_blendv_epi8(samples, maximum, _mm256_cmpgt_epi64(samples, maximum));
+	samples = _mm256_blendv_epi8(samples, minimum, _mm256_cmpgt_epi64(minimum, samples));
+
+	// Gather the lower half of each sample
+	return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(samples, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+}
+#endif
+
+TARGET_AVX2 static void ClampToS16_AVX2(short *output_buffer, const long *input_buffer, size_t samples_to_do)
+{
+#ifdef LONG_IS_64_BIT
+	const size_t vector_samples = samples_to_do & ~(size_t)7;
+
+	for (size_t i = 0; i < vector_samples; i += 8)
+		_mm_storeu_si128((__m128i*)&output_buffer[i], _mm_packs_epi32(ClampToS16Range_AVX2(&input_buffer[i + 0]), ClampToS16Range_AVX2(&input_buffer[i + 4])));
+#else
+	const size_t vector_samples = samples_to_do & ~(size_t)15;
+
+	for (size_t i = 0; i < vector_samples; i += 16)
+	{
+		// Packing interleaves the two inputs in 64-bit chunks, so put them back in order afterwards
+		__m256i packed = _mm256_packs_epi32(_mm256_loadu_si256((const __m256i*)&input_buffer[i + 0]), _mm256_loadu_si256((const __m256i*)&input_buffer[i + 8]));
+		packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+
+		// Packing saturates to -0x8000, but we want -0x7FFF
+		_mm256_storeu_si256((__m256i*)&output_buffer[i], _mm256_max_epi16(packed, _mm256_set1_epi16(-0x7FFF)));
+	}
+#endif
+
+	ClampToS16_Scalar(&output_buffer[vector_samples], &input_buffer[vector_samples], samples_to_do - vector_samples);
+}
+
+// Converts eight samples to float, scales them, and adds them to the output buffer
+TARGET_AVX2 static void MixFloat8_AVX2(float *output_buffer, const short *input_buffer, __m256 scales)
+{
+	const __m256 samples = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)input_buffer)));
+
+	_mm256_storeu_ps(output_buffer, _mm256_add_ps(_mm256_loadu_ps(output_buffer), _mm256_mul_ps(samples, scales)));
+}
+
+TARGET_AVX2 static void MixFloat_AVX2(float *output_buffer, const short *input_buffer, size_t frames_to_do)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)3;
+	const __m256 scales = _mm256_set1_ps(FLOAT_SCALE);
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 8)
+		MixFloat8_AVX2(&output_buffer[i], &input_buffer[i], scales);
+
+	MixFloat_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames);
+}
+
+TARGET_AVX2 static void MixVolumeFloat_AVX2(float *output_buffer, const short *input_buffer, size_t frames_to_do, unsigned short volume_left, unsigned short volume_right)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)3;
+	const float scale_left = volume_left * FLOAT_VOLUME_SCALE;
+	const float scale_right = volume_right * FLOAT_VOLUME_SCALE;
+	const __m256 scales = _mm256_setr_ps(scale_left, scale_right, scale_left, scale_right, scale_left, scale_right, scale_left, scale_right);
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 8)
+		MixFloat8_AVX2(&output_buffer[i], &input_buffer[i], scales);
+
+	MixVolumeFloat_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames, volume_left, volume_right);
+}
+
+TARGET_AVX2 static void MixVolumeRampFloat_AVX2(float *output_buffer, const short *input_buffer, size_t frames_to_do, const unsigned short *volumes)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)3;
+	const __m256 volume_scale = _mm256_set1_ps(FLOAT_VOLUME_SCALE);
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 8)
+		MixFloat8_AVX2(&output_buffer[i], &input_buffer[i], _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)&volumes[i]))), volume_scale));
+
+	MixVolumeRampFloat_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames, &volumes[vector_frames * CHANNEL_COUNT]);
+}
+
+static const MixKernels kernels_avx2 = {
+	Mix_AVX2,
+	MixVolume_AVX2,
+	MixVolumeRamp_AVX2,
+	ClampToS16_AVX2,
+	MixFloat_AVX2,
+	MixVolumeFloat_AVX2,
+	MixVolumeRampFloat_AVX2
+};
+
+#endif
+
+
+////////
+// NEON
+////////
+
+#ifdef MIX_KERNELS_NEON
+
+// Adds four 32-bit samples to four `long`s
+static void Accumulate_NEON(long *output_buffer, int32x4_t samples)
+{
+#ifdef LONG_IS_64_BIT
+	int64_t *output_pointer = (int64_t*)(void*)output_buffer;
+
+	vst1q_s64(&output_pointer[0], vaddw_s32(vld1q_s64(&output_pointer[0]), vget_low_s32(samples)));
+	vst1q_s64(&output_pointer[2], vaddw_s32(vld1q_s64(&output_pointer[2]), vget_high_s32(samples)));
+#else
+	int32_t *output_pointer = (int32_t*)(void*)output_buffer;
+
+	vst1q_s32(output_pointer, vaddq_s32(vld1q_s32(output_pointer), samples));
+#endif
+}
+
+// Scales four samples by four volumes, and adds them to the output buffer
+static void MixVolume4_NEON(long *output_buffer, int16x4_t samples, uint16x4_t volumes)
+{
+	const int32x4_t products = vmulq_s32(vmovl_s16(samples), vreinterpretq_s32_u32(vmovl_u16(volumes)));
+
+	// Divide by 0x100, rounding towards zero like C's division does
+	Accumulate_NEON(output_buffer, vshrq_n_s32(vaddq_s32(products, vandq_s32(vshrq_n_s32(products, 31), vdupq_n_s32(0xFF))), 8));
+}
+
+static void Mix_NEON(long *output_buffer, const short *input_buffer, size_t frames_to_do)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)1;
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 4)
+		Accumulate_NEON(&output_buffer[i], vmovl_s16(vld1_s16(&input_buffer[i])));
+
+	Mix_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames);
+}
+
+static void MixVolume_NEON(long *output_buffer, const short *input_buffer, size_t frames_to_do, unsigned short volume_left, unsigned short volume_right)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)1;
+	const uint16_t volume_array[4] = {volume_left, volume_right, volume_left, volume_right};
+	const uint16x4_t volumes = vld1_u16(volume_array);
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 4)
+		MixVolume4_NEON(&output_buffer[i], vld1_s16(&input_buffer[i]), volumes);
+
+	MixVolume_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames, volume_left, volume_right);
+}
+
+static void MixVolumeRamp_NEON(long *output_buffer, const short *input_buffer, size_t frames_to_do, const unsigned short *volumes)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)1;
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 4)
+		MixVolume4_NEON(&output_buffer[i], vld1_s16(&input_buffer[i]), vld1_u16(&volumes[i]));
+
+	MixVolumeRamp_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames, &volumes[vector_frames * CHANNEL_COUNT]);
+}
+
+// Saturates four samples to 16-bit
+static int16x4_t SaturateToS16_NEON(const long *input_buffer)
+{
+#ifdef LONG_IS_64_BIT
+	const int64_t *input_pointer = (const int64_t*)(const void*)input_buffer;
+
+	return vqmovn_s32(vcombine_s32(vqmovn_s64(vld1q_s64(&input_pointer[0])), vqmovn_s64(vld1q_s64(&input_pointer[2]))));
+#else
+	return vqmovn_s32(vld1q_s32((const int32_t*)(const void*)input_buffer));
+#endif
+}
+
+static void ClampToS16_NEON(short *output_buffer, const long *input_buffer, size_t samples_to_do)
+{
+	const size_t vector_samples = samples_to_do & ~(size_t)3;
+
+	// Saturation goes down to -0x8000, but we want -0x7FFF
+	for (size_t i = 0; i < vector_samples; i += 4)
+		vst1_s16(&output_buffer[i], vmax_s16(SaturateToS16_NEON(&input_buffer[i]), vdup_n_s16(-0x7FFF)));
+
+	ClampToS16_Scalar(&output_buffer[vector_samples], &input_buffer[vector_samples], samples_to_do - vector_samples);
+}
+
+// Converts four samples to float, scales them, and adds them to the output buffer
+static void MixFloat4_NEON(float *output_buffer, int16x4_t samples, float32x4_t scales)
+{
+	vst1q_f32(output_buffer, vaddq_f32(vld1q_f32(output_buffer), vmulq_f32(vcvtq_f32_s32(vmovl_s16(samples)), scales)));
+}
+
+static void MixFloat_NEON(float *output_buffer, const short *input_buffer, size_t frames_to_do)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)1;
+	const float32x4_t scales = vdupq_n_f32(FLOAT_SCALE);
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 4)
+		MixFloat4_NEON(&output_buffer[i], vld1_s16(&input_buffer[i]), scales);
+
+	MixFloat_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames);
+}
+
+static void MixVolumeFloat_NEON(float *output_buffer, const short *input_buffer, size_t frames_to_do, unsigned short volume_left, unsigned short volume_right)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)1;
+	const float scale_left = volume_left * FLOAT_VOLUME_SCALE;
+	const float scale_right = volume_right * FLOAT_VOLUME_SCALE;
+	const float scale_array[4] = {scale_left, scale_right, scale_left, scale_right};
+	const float32x4_t scales = vld1q_f32(scale_array);
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 4)
+		MixFloat4_NEON(&output_buffer[i], vld1_s16(&input_buffer[i]), scales);
+
+	MixVolumeFloat_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames, volume_left, volume_right);
+}
+
+static void MixVolumeRampFloat_NEON(float *output_buffer, const short *input_buffer, size_t frames_to_do, const unsigned short *volumes)
+{
+	const size_t vector_frames = frames_to_do & ~(size_t)1;
+	const float32x4_t volume_scale = vdupq_n_f32(FLOAT_VOLUME_SCALE);
+
+	for (size_t i = 0; i < vector_frames * CHANNEL_COUNT; i += 4)
+		MixFloat4_NEON(&output_buffer[i], vld1_s16(&input_buffer[i]), vmulq_f32(vcvtq_f32_u32(vmovl_u16(vld1_u16(&volumes[i]))), volume_scale));
+
+	MixVolumeRampFloat_Scalar(&output_buffer[vector_frames * CHANNEL_COUNT], &input_buffer[vector_frames * CHANNEL_COUNT], frames_to_do - vector_frames, &volumes[vector_frames * CHANNEL_COUNT]);
+}
+
+static const MixKernels kernels_neon = {
+	Mix_NEON,
+	MixVolume_NEON,
+	MixVolumeRamp_NEON,
+	ClampToS16_NEON,
+	MixFloat_NEON,
+	MixVolumeFloat_NEON,
+	MixVolumeRampFloat_NEON
+};
+
+#endif
+
+
+/////////////////
+// CPU detection
+/////////////////
+
+#if defined(MIX_KERNELS_SSE2) && !defined(__GNUC__) && defined(_MSC_VER)
+static int GetCPUFeatures(bool *sse2, bool *avx2)
+{
+	int info[4];
+
+	__cpuid(info, 0);
+	const int highest_leaf = info[0];
+
+	__cpuid(info, 1);
+	*sse2 = (info[3] & (1 << 26)) != 0;
+
+	// AVX2 needs the OS to preserve the YMM registers, which is what OSXSAVE and XGETBV tell us
+	*avx2 = false;
+
+ #ifdef MIX_KERNELS_AVX2
+	if ((info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6 && highest_leaf >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		*avx2 = (info[1] & (1 << 5)) != 0;
+	}
+ #else
+	(void)highest_leaf;
+ #endif
+
+	return 0;
+}
+#endif
+
+const MixKernels* MixKernels_Select(void)
+{
+#if defined(MIX_KERNELS_SSE2)
+ #if defined(__GNUC__)
+	__builtin_cpu_init();
+
+  #ifdef MIX_KERNELS_AVX2
+	if (__builtin_cpu_supports("avx2"))
+		return &kernels_avx2;
+  #endif
+
+	if (__builtin_cpu_supports("sse2"))
+		return &kernels_sse2;
+ #elif defined(_MSC_VER)
+	bool sse2, avx2;
+	GetCPUFeatures(&sse2, &avx2);
+
+  #ifdef MIX_KERNELS_AVX2
+	if (avx2)
+		return &kernels_avx2;
+  #endif
+
+	if (sse2)
+		return &kernels_sse2;
+ #endif
+#elif defined(MIX_KERNELS_NEON)
+	// NEON is a compile-time guarantee: it is mandatory on AArch64, and on 32-bit ARM the compiler only enables it when told to
+	return &kernels_neon;
+#endif
+
+	return &kernels_scalar;
+}
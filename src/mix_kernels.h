@@ -0,0 +1,45 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef MIX_KERNELS_H
+#define MIX_KERNELS_H
+
+#include <stddef.h>
+
+// All kernels operate on interlaced (L,R ordering) stereo frames.
+// Every implementation must produce results that are bit-identical to the scalar one.
+typedef struct MixKernels
+{
+	// Adds the samples to the output buffer
+	void (*Mix)(long *output_buffer, const short *input_buffer, size_t frames_to_do);
+	// Adds the samples to the output buffer, after scaling them by a volume (0x100 is full volume)
+	void (*MixVolume)(long *output_buffer, const short *input_buffer, size_t frames_to_do, unsigned short volume_left, unsigned short volume_right);
+	// Like `MixVolume`, but with a separate pair of volumes (L,R ordering) for every frame
+	void (*MixVolumeRamp)(long *output_buffer, const short *input_buffer, size_t frames_to_do, const unsigned short *volumes);
+	// Clamps the samples to the -0x7FFF to 0x7FFF range, and writes them to the output buffer
+	void (*ClampToS16)(short *output_buffer, const long *input_buffer, size_t samples_to_do);
+	// The same as `Mix`, `MixVolume` and `MixVolumeRamp`, but for float output buffers, where samples range from -1.0 to 1.0
+	void (*MixFloat)(float *output_buffer, const short *input_buffer, size_t frames_to_do);
+	void (*MixVolumeFloat)(float *output_buffer, const short *input_buffer, size_t frames_to_do, unsigned short volume_left, unsigned short volume_right);
+	void (*MixVolumeRampFloat)(float *output_buffer, const short *input_buffer, size_t frames_to_do, const unsigned short *volumes);
+} MixKernels;
+
+// Returns the fastest set of kernels that the current CPU supports
+const MixKernels* MixKernels_Select(void);
+
+#endif // MIX_KERNELS_H
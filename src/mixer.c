@@ -22,63 +22,175 @@
 #include <stdbool.h>
 #endif
 #include <stddef.h>
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "atomic.h"
+#include "file_mapping.h"
+#include "pool.h"
+#include "thread_pool.h"
+#include "threading.h"
+
 #include "decoding/decoders/common.h"
+#include "decoding/decoders/io_stream.h"
 
+#include "decoding/decode_ahead_decoder.h"
 #include "decoding/decoder_selector.h"
 #include "decoding/resampled_decoder.h"
 #include "decoding/split_decoder.h"
 
+#include "mix_kernels.h"
+
 #define CHANNEL_COUNT 2
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
-#define CLAMP(x, min, max) (MIN((max), MAX((min), (x))))
 
 #define SCALE(x, scale) (((x) * (scale)) / 0x100)
 
 #define COUNT_OF(array) (sizeof(array) / sizeof(*(array)))
 
+// Sound IDs are made of a slot index (lower 16 bits) and that slot's generation (upper 16 bits).
+// The generation is bumped whenever a slot is freed, so IDs of destroyed sounds are never mistaken for new ones.
+#define SOUND_SLOT_PAGE_SIZE 0x100
+#define SOUND_SLOT_PAGE_COUNT 0x100
+#define SOUND_SLOT_LIMIT (SOUND_SLOT_PAGE_SIZE * SOUND_SLOT_PAGE_COUNT - 1)	// One less, so that the free-list can store indices plus one in 16 bits
+
+// Each slot also publishes its generation and its sound's status together in one word, so that any thread can look them up.
+#define SLOT_STATE(generation, status) (((unsigned long)(generation) << 16) | (status))
+#define SLOT_STATE_GENERATION(state) ((state) >> 16)
+#define SLOT_STATE_STATUS(state) ((state) & 0xFFFF)
+
+enum
+{
+	SLOT_STATUS_NONE,	// The slot is free
+	SLOT_STATUS_PLAYING,
+	SLOT_STATUS_PAUSED	// Includes sounds whose ID has been allocated, but which have not been registered yet, since they start paused
+};
+
+// Workers mix into their own buses, which are summed afterwards, so mixing is split into chunks that fit in them
+#define WORKER_BUS_FRAMES 0x800
+
+// Voices are mixed into a bus of either `long` samples, in S16 terms, or float samples, from -1.0 to 1.0.
+// Only one of the two buffers is set.
+typedef struct MixBus
+{
+	long *long_buffer;
+	float *float_buffer;
+} MixBus;
+
+// Every playing sound has a voice, which holds the state that the mixer needs, packed into parallel arrays.
+// This lets the mixer stream through its voices without having to chase pointers.
+// Voices are kept tightly-packed: when one is removed, the last voice is moved into its place.
+typedef struct VoiceTable
+{
+	size_t count;
+	size_t capacity;
+
+	struct VoiceBlock *block;	// The allocation that the arrays below live in
+	DecoderStage *pipelines;
+	ClownAudio_Sound **sounds;	// The sound that owns each voice
+	unsigned long *fade_countdowns;
+	unsigned long *fade_volume_accumulators;	// 16.16
+	long *fade_volume_deltas;
+	unsigned short *final_volumes;	// Interlaced (L,R ordering)
+	unsigned char *finished;	// Only used when mixing with workers
+} VoiceTable;
+
+// The arrays of a voice table share a single allocation, which begins with this header
+typedef struct VoiceBlock
+{
+	size_t capacity;
+	void *next_retired;
+} VoiceBlock;
+
+typedef struct MixWorker
+{
+	ClownAudio_Mixer *mixer;
+	Thread *thread;
+	Semaphore *start_semaphore;
+	size_t voices_mixed;	// How many voices were mixed into the bus during the current job
+	union
+	{
+		long long_samples[WORKER_BUS_FRAMES * CHANNEL_COUNT];
+		float float_samples[WORKER_BUS_FRAMES * CHANNEL_COUNT];
+	} bus;	// Matches the type of the bus that the job is for
+	short scratch[DECODER_SCRATCH_SIZE];	// Lent to the pipelines of the voices that this worker mixes
+} MixWorker;
+
+typedef struct SoundSlot
+{
+	ClownAudio_Sound *sound;	// NULL if the slot is free, or its ID has been allocated but not registered yet
+	volatile unsigned long state;	// Made with `SLOT_STATE`. Only changed while the mixer is guarded with mutex, unless the slot has no sound registered to it.
+	volatile unsigned long next_free;	// Index plus one of the next slot in the free-list, or 0 if this is the last one
+} SoundSlot;
+
 struct ClownAudio_Mixer
 {
-	ClownAudio_Sound *sound_hash_table[0x100];
-	ClownAudio_Sound *playing_list_head;
+	// Slots are allocated a page at a time, so that existing slots never move
+	void *volatile sound_slot_pages[SOUND_SLOT_PAGE_COUNT];
+	volatile unsigned long sound_slot_count;	// How many slots have ever been handed out
+	volatile unsigned long sound_slot_free_list;	// Upper 16 bits are a counter to avoid the ABA problem, lower 16 bits are the index plus one of the first free slot
+
+	VoiceTable voices;
+	size_t sound_count;	// How many sounds are registered, and therefore how many voices might be needed
+
+	// The audio thread must never allocate or free memory, so bigger voice tables are allocated ahead of time
+	// by `ClownAudio_Mixer_SoundAllocateID`, and anything that the mixer is done with is retired to a list,
+	// to be freed later by `ClownAudio_Mixer_CollectGarbage`.
+	void *volatile spare_voice_block;
+	volatile unsigned long voice_capacity;	// A copy of `voices.capacity` that other threads can read
+	volatile unsigned long live_sound_ids;	// How many sound IDs are allocated, and therefore how many voices might be needed soon
+	void *volatile retired_sounds;
+	void *volatile retired_voice_blocks;
+	Mutex *garbage_mutex;	// Guards `spare_voice_block` (apart from the mixer taking it) and the freeing of retired memory
+
 	unsigned long sample_rate;
-	ClownAudio_SoundID sound_id_allocator;
+	const MixKernels *kernels;
+	short scratch[DECODER_SCRATCH_SIZE];	// Lent to the pipelines of the voices that the mixing thread mixes itself
+
+	Pool *pool;	// Sounds and their decoder pipelines are allocated from here
+
+	// Optional threads which help `ClownAudio_Mixer_MixSamples` by mixing some of the voices in parallel.
+	// Each worker claims one voice at a time by incrementing `job_next_voice`, so threads that are given
+	// cheap voices simply end up mixing more of them.
+	MixWorker **workers;
+	unsigned int worker_count;
+	Semaphore *workers_done_semaphore;
+	bool workers_quit;
+	volatile unsigned long job_next_voice;
+	size_t job_voice_count;
+	bool job_float_bus;
+	size_t job_frames;
+
+	void *volatile decode_ahead_thread;	// Created when the first sound that needs it is created
+	void *volatile load_thread_pool;	// Created when sound-data is first loaded asynchronously
 };
 
 struct ClownAudio_Sound
 {
-	// List of sounds in bucket
-	ClownAudio_Sound *prev_in_bucket;
-	ClownAudio_Sound *next_in_bucket;
-
-	// List of all currently-playing sounds
-	ClownAudio_Sound *prev_playing;
-	ClownAudio_Sound *next_playing;
-
 	// List of sounds created from a single sound data
 	ClownAudio_Sound *prev_sibling;
 	ClownAudio_Sound *next_sibling;
 
+	void *next_retired;	// Next sound in the mixer's list of sounds that are waiting to be freed
+
 	ClownAudio_SoundID id;
 	bool paused;
 	bool destroy_when_done;
 	DecoderStage pipeline;
-	void *resampled_decoders[2];
+	void *resampled_decoders[2];	// NULL where the sound did not need resampling
 
+	size_t voice_index;
+
+	// While the sound is playing, its voice holds the up-to-date copy of these
 	unsigned long fade_countdown;
 	unsigned long fade_volume_accumulator; // 16.16
 	long fade_volume_delta;
+	unsigned short final_volumes[CHANNEL_COUNT];
 
 	unsigned short volume_left;
 	unsigned short volume_right;
-
-	unsigned short final_volume_left;
-	unsigned short final_volume_right;
 };
 
 struct ClownAudio_SoundData
@@ -86,90 +198,376 @@ struct ClownAudio_SoundData
 	ClownAudio_Sound sound_list_sentinel;
 
 	DecoderSelectorData *decoder_selector_data[2];
-	unsigned char *file_buffers[2];
+	FileMapping *file_mappings[2];
+	IOSource *io_sources[2];
 };
 
-static bool LoadFileToMemory(const char *path, unsigned char **buffer, size_t *size)
+struct ClownAudio_SoundDataLoad
 {
-	bool success = false;
+	ThreadPoolJob job;
+	ClownAudio_Mixer *mixer;
+	char *paths[2];
+	char *predecode_cache_directory;
+	ClownAudio_SoundDataConfig config;
+	void (*callback)(void *user_data, ClownAudio_SoundData *sound_data);
+	void *user_data;
+
+	ClownAudio_SoundData *sound_data;
+	volatile unsigned long done;
+	Semaphore *done_semaphore;
+};
 
+static bool MapFile(const char *path, FileMapping **file_mapping, const unsigned char **buffer, size_t *size)
+{
 	if (path == NULL || path[0] == '\0')
 	{
 		// Just pretend we loaded an empty file
+		*file_mapping = NULL;
 		*buffer = NULL;
 		*size = 0;
-		success = true;
+		return true;
 	}
-	else
+
+	*file_mapping = FileMapping_Open(path, buffer, size);
+
+	return *file_mapping != NULL;
+}
+
+static VoiceBlock* AllocateVoiceBlock(size_t capacity)
+{
+	// The arrays are ordered from largest alignment to smallest
+	VoiceBlock *block = (VoiceBlock*)malloc(sizeof(VoiceBlock) + capacity * (sizeof(DecoderStage) + sizeof(ClownAudio_Sound*) + sizeof(unsigned long) + sizeof(unsigned long) + sizeof(long) + sizeof(unsigned short) * CHANNEL_COUNT + sizeof(unsigned char)));
+
+	if (block != NULL)
+		block->capacity = capacity;
+
+	return block;
+}
+
+// Safe to call from any thread
+static void PushRetired(void *volatile *list_head, void *item, void **next_pointer)
+{
+	void *head;
+
+	do
 	{
-		FILE *file = fopen(path, "rb");
+		head = Atomic_LoadPointer(list_head);
+		*next_pointer = head;
+	} while (!Atomic_CompareExchangePointer(list_head, head, item));
+}
 
-		if (file != NULL)
-		{
-			fseek(file, 0, SEEK_END);
-			*size = ftell(file);
-			rewind(file);
+// Safe to call from any thread
+static void* TakePointer(void *volatile *pointer)
+{
+	void *value;
+
+	do
+	{
+		value = Atomic_LoadPointer(pointer);
+	} while (value != NULL && !Atomic_CompareExchangePointer(pointer, value, NULL));
+
+	return value;
+}
 
-			*buffer = (unsigned char*)malloc(*size);
+static void RetireVoiceBlock(ClownAudio_Mixer *mixer, VoiceBlock *block)
+{
+	PushRetired(&mixer->retired_voice_blocks, block, &block->next_retired);
+}
 
-			if (*buffer != NULL)
+// Makes sure that the mixer will not have to allocate memory to give `total_voices` sounds a voice.
+// Must not be called on the audio thread.
+static void PrepareVoices(ClownAudio_Mixer *mixer, size_t total_voices)
+{
+	Mutex_Lock(mixer->garbage_mutex);
+
+	const size_t capacity = Atomic_Load(&mixer->voice_capacity);
+
+	if (total_voices > capacity)
+	{
+		// The mixer may take the spare at any moment, but only this function (and `ClownAudio_Mixer_CollectGarbage`,
+		// which shares the mutex) can free it, so it is safe to look at it here
+		const VoiceBlock *spare = (const VoiceBlock*)Atomic_LoadPointer(&mixer->spare_voice_block);
+
+		if (spare == NULL || spare->capacity < total_voices)
+		{
+			VoiceBlock *new_spare = AllocateVoiceBlock(MAX(total_voices, capacity * 2));
+
+			if (new_spare != NULL)
 			{
-				fread(*buffer, 1, *size, file);
+				// Swap the new spare in, freeing the old one if the mixer has not taken it already
+				void *old_spare;
+
+				do
+				{
+					old_spare = Atomic_LoadPointer(&mixer->spare_voice_block);
+				} while (!Atomic_CompareExchangePointer(&mixer->spare_voice_block, old_spare, new_spare));
 
-				success = true;
+				free(old_spare);
 			}
+		}
+	}
 
-			fclose(file);
+	Mutex_Unlock(mixer->garbage_mutex);
+}
+
+// Must be guarded with mutex
+static bool ReserveVoices(ClownAudio_Mixer *mixer, size_t total_voices)
+{
+	VoiceTable *voices = &mixer->voices;
+
+	if (total_voices > voices->capacity)
+	{
+		// `PrepareVoices` should have left a big-enough table for us
+		VoiceBlock *block = (VoiceBlock*)TakePointer(&mixer->spare_voice_block);
+
+		if (block == NULL || block->capacity < total_voices)
+		{
+			// It didn't (most likely because it ran out of memory), so allocate one here as a last resort
+			if (block != NULL)
+				RetireVoiceBlock(mixer, block);
+
+			block = AllocateVoiceBlock(MAX(total_voices, voices->capacity * 2));
+
+			if (block == NULL)
+				return false;
+		}
+
+		const size_t new_capacity = block->capacity;
+
+		VoiceTable new_voices;
+		new_voices.count = voices->count;
+		new_voices.capacity = new_capacity;
+		new_voices.block = block;
+		new_voices.pipelines = (DecoderStage*)&block[1];
+		new_voices.sounds = (ClownAudio_Sound**)&new_voices.pipelines[new_capacity];
+		new_voices.fade_countdowns = (unsigned long*)&new_voices.sounds[new_capacity];
+		new_voices.fade_volume_accumulators = &new_voices.fade_countdowns[new_capacity];
+		new_voices.fade_volume_deltas = (long*)&new_voices.fade_volume_accumulators[new_capacity];
+		new_voices.final_volumes = (unsigned short*)&new_voices.fade_volume_deltas[new_capacity];
+		new_voices.finished = (unsigned char*)&new_voices.final_volumes[new_capacity * CHANNEL_COUNT];
+
+		if (voices->count != 0)
+		{
+			memcpy(new_voices.pipelines, voices->pipelines, sizeof(*voices->pipelines) * voices->count);
+			memcpy(new_voices.sounds, voices->sounds, sizeof(*voices->sounds) * voices->count);
+			memcpy(new_voices.fade_countdowns, voices->fade_countdowns, sizeof(*voices->fade_countdowns) * voices->count);
+			memcpy(new_voices.fade_volume_accumulators, voices->fade_volume_accumulators, sizeof(*voices->fade_volume_accumulators) * voices->count);
+			memcpy(new_voices.fade_volume_deltas, voices->fade_volume_deltas, sizeof(*voices->fade_volume_deltas) * voices->count);
+			memcpy(new_voices.final_volumes, voices->final_volumes, sizeof(*voices->final_volumes) * CHANNEL_COUNT * voices->count);
 		}
+
+		if (voices->block != NULL)
+			RetireVoiceBlock(mixer, voices->block);
+
+		*voices = new_voices;
+
+		Atomic_Store(&mixer->voice_capacity, new_capacity);
 	}
 
-	return success;
+	return true;
 }
 
-static void AddSoundToPlayingList(ClownAudio_Mixer *mixer, ClownAudio_Sound *sound)
+// Copies the sound's state into its voice
+static void LoadVoiceState(ClownAudio_Mixer *mixer, ClownAudio_Sound *sound)
 {
-	sound->prev_playing = NULL;
-	sound->next_playing = mixer->playing_list_head;
+	VoiceTable *voices = &mixer->voices;
+	const size_t voice = sound->voice_index;
+
+	voices->pipelines[voice] = sound->pipeline;
+	voices->sounds[voice] = sound;
+	voices->fade_countdowns[voice] = sound->fade_countdown;
+	voices->fade_volume_accumulators[voice] = sound->fade_volume_accumulator;
+	voices->fade_volume_deltas[voice] = sound->fade_volume_delta;
+	voices->final_volumes[voice * CHANNEL_COUNT + 0] = sound->final_volumes[0];
+	voices->final_volumes[voice * CHANNEL_COUNT + 1] = sound->final_volumes[1];
+}
 
-	if (mixer->playing_list_head != NULL)
-		mixer->playing_list_head->prev_playing = sound;
+// Copies the voice's state back into its sound
+static void SaveVoiceState(ClownAudio_Mixer *mixer, ClownAudio_Sound *sound)
+{
+	VoiceTable *voices = &mixer->voices;
+	const size_t voice = sound->voice_index;
+
+	sound->fade_countdown = voices->fade_countdowns[voice];
+	sound->fade_volume_accumulator = voices->fade_volume_accumulators[voice];
+	sound->fade_volume_delta = voices->fade_volume_deltas[voice];
+	sound->final_volumes[0] = voices->final_volumes[voice * CHANNEL_COUNT + 0];
+	sound->final_volumes[1] = voices->final_volumes[voice * CHANNEL_COUNT + 1];
+}
 
-	mixer->playing_list_head = sound;
+// Space for the voice must have been reserved with `ReserveVoices`
+static void AddVoice(ClownAudio_Mixer *mixer, ClownAudio_Sound *sound)
+{
+	sound->voice_index = mixer->voices.count++;
+	LoadVoiceState(mixer, sound);
 }
 
-static void RemoveSoundFromPlayingList(ClownAudio_Mixer *mixer, ClownAudio_Sound *sound)
+static void RemoveVoice(ClownAudio_Mixer *mixer, ClownAudio_Sound *sound)
 {
-	if (sound->prev_playing != NULL)
-		sound->prev_playing->next_playing = sound->next_playing;
-	else
-		mixer->playing_list_head = sound->next_playing;
+	VoiceTable *voices = &mixer->voices;
+	const size_t voice = sound->voice_index;
+	const size_t last_voice = --voices->count;
+
+	SaveVoiceState(mixer, sound);
+
+	// Fill the gap with the last voice
+	if (voice != last_voice)
+	{
+		voices->pipelines[voice] = voices->pipelines[last_voice];
+		voices->sounds[voice] = voices->sounds[last_voice];
+		voices->fade_countdowns[voice] = voices->fade_countdowns[last_voice];
+		voices->fade_volume_accumulators[voice] = voices->fade_volume_accumulators[last_voice];
+		voices->fade_volume_deltas[voice] = voices->fade_volume_deltas[last_voice];
+		voices->final_volumes[voice * CHANNEL_COUNT + 0] = voices->final_volumes[last_voice * CHANNEL_COUNT + 0];
+		voices->final_volumes[voice * CHANNEL_COUNT + 1] = voices->final_volumes[last_voice * CHANNEL_COUNT + 1];
+
+		voices->sounds[voice]->voice_index = voice;
+	}
+}
 
-	if (sound->next_playing != NULL)
-		sound->next_playing->prev_playing = sound->prev_playing;
+static SoundSlot* GetSoundSlot(ClownAudio_Mixer *mixer, unsigned long index)
+{
+	SoundSlot *page = (SoundSlot*)Atomic_LoadPointer(&mixer->sound_slot_pages[index / SOUND_SLOT_PAGE_SIZE]);
+
+	return page == NULL ? NULL : &page[index % SOUND_SLOT_PAGE_SIZE];
+}
+
+// Safe to call from any thread
+static bool AllocateSoundSlot(ClownAudio_Mixer *mixer, unsigned long *index)
+{
+	// First, try to reuse a previously-freed slot
+	for (;;)
+	{
+		const unsigned long head = Atomic_Load(&mixer->sound_slot_free_list);
+
+		if ((head & 0xFFFF) == 0)
+			break;
+
+		*index = (head & 0xFFFF) - 1;
+
+		const unsigned long new_head = ((((head >> 16) + 1) & 0xFFFF) << 16) | Atomic_Load(&GetSoundSlot(mixer, *index)->next_free);
+
+		if (Atomic_CompareExchange(&mixer->sound_slot_free_list, head, new_head))
+		{
+			Atomic_FetchAdd(&mixer->live_sound_ids, 1);
+			return true;
+		}
+	}
+
+	// Otherwise, hand out a brand new slot
+	for (;;)
+	{
+		const unsigned long count = Atomic_Load(&mixer->sound_slot_count);
+
+		if (count == SOUND_SLOT_LIMIT)
+			return false;
+
+		if (Atomic_CompareExchange(&mixer->sound_slot_count, count, count + 1))
+		{
+			*index = count;
+			break;
+		}
+	}
+
+	// Make sure that the slot's page exists
+	void *volatile *page_pointer = &mixer->sound_slot_pages[*index / SOUND_SLOT_PAGE_SIZE];
+
+	if (Atomic_LoadPointer(page_pointer) == NULL)
+	{
+		SoundSlot *page = (SoundSlot*)malloc(sizeof(SoundSlot) * SOUND_SLOT_PAGE_SIZE);
+
+		if (page == NULL)
+			return false;	// The slot is lost, but there is not much else that can be done here
+
+		for (size_t i = 0; i < SOUND_SLOT_PAGE_SIZE; ++i)
+		{
+			page[i].sound = NULL;
+			page[i].state = SLOT_STATE(1, SLOT_STATUS_NONE);
+			page[i].next_free = 0;
+		}
+
+		// Another thread may have beaten us to it
+		if (!Atomic_CompareExchangePointer(page_pointer, NULL, page))
+			free(page);
+	}
+
+	Atomic_FetchAdd(&mixer->live_sound_ids, 1);
+
+	return true;
+}
+
+// Safe to call from any thread, as long as the slot has no sound registered to it
+static void ReleaseSoundSlot(ClownAudio_Mixer *mixer, unsigned long index)
+{
+	SoundSlot *slot = GetSoundSlot(mixer, index);
+
+	// Invalidate any IDs that still refer to this slot (0 is skipped, since IDs cannot be 0)
+	unsigned long generation = (SLOT_STATE_GENERATION(Atomic_Load(&slot->state)) + 1) & 0xFFFF;
+
+	if (generation == 0)
+		generation = 1;
+
+	Atomic_Store(&slot->state, SLOT_STATE(generation, SLOT_STATUS_NONE));
+
+	// Add the slot to the free-list
+	unsigned long head;
+
+	do
+	{
+		head = Atomic_Load(&mixer->sound_slot_free_list);
+		Atomic_Store(&slot->next_free, head & 0xFFFF);
+	} while (!Atomic_CompareExchange(&mixer->sound_slot_free_list, head, ((((head >> 16) + 1) & 0xFFFF) << 16) | (index + 1)));
+
+	Atomic_FetchAdd(&mixer->live_sound_ids, (unsigned long)-1);
+}
+
+// Must be guarded with mutex
+static void FreeSoundSlot(ClownAudio_Mixer *mixer, unsigned long index)
+{
+	GetSoundSlot(mixer, index)->sound = NULL;
+
+	ReleaseSoundSlot(mixer, index);
+}
+
+// Must be guarded with mutex
+static void SetSoundStatus(ClownAudio_Mixer *mixer, ClownAudio_Sound *sound, unsigned long status)
+{
+	SoundSlot *slot = GetSoundSlot(mixer, sound->id & 0xFFFF);
+
+	Atomic_Store(&slot->state, SLOT_STATE(SLOT_STATE_GENERATION(Atomic_Load(&slot->state)), status));
 }
 
 static ClownAudio_Sound* FindSound(ClownAudio_Mixer *mixer, ClownAudio_SoundID sound_id)
 {
-	for (ClownAudio_Sound *sound = mixer->sound_hash_table[sound_id % COUNT_OF(mixer->sound_hash_table)]; sound != NULL; sound = sound->next_in_bucket)
-		if (sound->id == sound_id)
-			return sound;
+	const unsigned long index = sound_id & 0xFFFF;
+
+	if (index < SOUND_SLOT_LIMIT)
+	{
+		SoundSlot *slot = GetSoundSlot(mixer, index);
+
+		if (slot != NULL && SLOT_STATE_GENERATION(Atomic_Load(&slot->state)) == sound_id >> 16)
+			return slot->sound;
+	}
 
 	return NULL;
 }
 
+// The sound cannot be freed on the audio thread, so it is put in a list for `ClownAudio_Mixer_CollectGarbage` to deal with later
+static void RetireSound(ClownAudio_Mixer *mixer, ClownAudio_Sound *sound)
+{
+	PushRetired(&mixer->retired_sounds, sound, &sound->next_retired);
+}
+
+// Removes the sound from the mixer straight away, but leaves freeing it to `ClownAudio_Mixer_CollectGarbage`
 static void DestroySound(ClownAudio_Mixer *mixer, ClownAudio_Sound *sound)
 {
 	if (!sound->paused)
-		RemoveSoundFromPlayingList(mixer, sound);
+		RemoveVoice(mixer, sound);
 
-	// Detach sound from sound list
-	if (sound->prev_in_bucket != NULL)
-		sound->prev_in_bucket->next_in_bucket = sound->next_in_bucket;
-	else
-		mixer->sound_hash_table[sound->id % COUNT_OF(mixer->sound_hash_table)] = sound->next_in_bucket;
+	--mixer->sound_count;
 
-	if (sound->next_in_bucket != NULL)
-		sound->next_in_bucket->prev_in_bucket = sound->prev_in_bucket;
+	// Release the sound's ID
+	FreeSoundSlot(mixer, sound->id & 0xFFFF);
 
 	// Detach sound from list of sounds derived from the same sound data
 	sound->prev_sibling->next_sibling = sound->next_sibling;
@@ -177,16 +575,16 @@ static void DestroySound(ClownAudio_Mixer *mixer, ClownAudio_Sound *sound)
 	if (sound->next_sibling != NULL)
 		sound->next_sibling->prev_sibling = sound->prev_sibling;
 
-	sound->pipeline.Destroy(sound->pipeline.decoder);
-	free(sound);
+	RetireSound(mixer, sound);
 }
 
 static void PauseSound(ClownAudio_Mixer *mixer, ClownAudio_Sound *sound)
 {
 	if (!sound->paused)
 	{
-		RemoveSoundFromPlayingList(mixer, sound);
+		RemoveVoice(mixer, sound);
 		sound->paused = true;
+		SetSoundStatus(mixer, sound, SLOT_STATUS_PAUSED);
 	}
 }
 
@@ -194,18 +592,281 @@ static void UnpauseSound(ClownAudio_Mixer *mixer, ClownAudio_Sound *sound)
 {
 	if (sound->paused)
 	{
-		AddSoundToPlayingList(mixer, sound);
+		AddVoice(mixer, sound);
 		sound->paused = false;
+		SetSoundStatus(mixer, sound, SLOT_STATUS_PLAYING);
 	}
 }
 
-static void UpdateSoundVolume(ClownAudio_Sound *sound)
+static void ComputeFinalVolumes(unsigned short *final_volumes, unsigned short volume_left, unsigned short volume_right, unsigned long fade_volume_accumulator)
 {
-	const unsigned short fade_volume_linear = (unsigned short)(sound->fade_volume_accumulator >> 16);
+	const unsigned short fade_volume_linear = (unsigned short)(fade_volume_accumulator >> 16);
 	const unsigned short fade_volume = SCALE(fade_volume_linear, fade_volume_linear);
 
-	sound->final_volume_left = SCALE(sound->volume_left, fade_volume);
-	sound->final_volume_right = SCALE(sound->volume_right, fade_volume);
+	final_volumes[0] = SCALE(volume_left, fade_volume);
+	final_volumes[1] = SCALE(volume_right, fade_volume);
+}
+
+static void UpdateSoundVolume(ClownAudio_Sound *sound)
+{
+	ComputeFinalVolumes(sound->final_volumes, sound->volume_left, sound->volume_right, sound->fade_volume_accumulator);
+}
+
+// Safe to call from any thread, but not on the audio thread
+static DecodeAheadThread* GetDecodeAheadThread(ClownAudio_Mixer *mixer)
+{
+	DecodeAheadThread *thread = (DecodeAheadThread*)Atomic_LoadPointer(&mixer->decode_ahead_thread);
+
+	if (thread == NULL)
+	{
+		thread = DecodeAheadThread_Create();
+
+		if (thread != NULL && !Atomic_CompareExchangePointer(&mixer->decode_ahead_thread, NULL, thread))
+		{
+			// Another thread beat us to it
+			DecodeAheadThread_Destroy(thread);
+			thread = (DecodeAheadThread*)Atomic_LoadPointer(&mixer->decode_ahead_thread);
+		}
+	}
+
+	return thread;
+}
+
+// Safe to call from any thread, but not on the audio thread
+static ThreadPool* GetLoadThreadPool(ClownAudio_Mixer *mixer)
+{
+	ThreadPool *pool = (ThreadPool*)Atomic_LoadPointer(&mixer->load_thread_pool);
+
+	if (pool == NULL)
+	{
+		pool = ThreadPool_Create(Thread_GetProcessorCount());
+
+		if (pool != NULL && !Atomic_CompareExchangePointer(&mixer->load_thread_pool, NULL, pool))
+		{
+			// Another thread beat us to it
+			ThreadPool_Destroy(pool);
+			pool = (ThreadPool*)Atomic_LoadPointer(&mixer->load_thread_pool);
+		}
+	}
+
+	return pool;
+}
+
+static MixBus MakeBus(void *buffer, bool is_float)
+{
+	MixBus bus;
+	bus.long_buffer = is_float ? NULL : (long*)buffer;
+	bus.float_buffer = is_float ? (float*)buffer : NULL;
+	return bus;
+}
+
+// Returns the part of the bus that starts `frames` frames in
+static MixBus OffsetBus(const MixBus *bus, size_t frames)
+{
+	if (bus->float_buffer != NULL)
+		return MakeBus(&bus->float_buffer[frames * CHANNEL_COUNT], true);
+	else
+		return MakeBus(&bus->long_buffer[frames * CHANNEL_COUNT], false);
+}
+
+static void ClearBus(const MixBus *bus, size_t frames_to_do)
+{
+	if (bus->float_buffer != NULL)
+		memset(bus->float_buffer, 0, frames_to_do * CHANNEL_COUNT * sizeof(float));
+	else
+		memset(bus->long_buffer, 0, frames_to_do * CHANNEL_COUNT * sizeof(long));
+}
+
+// Adds one bus to another of the same type
+static void SumBus(const MixBus *bus, const MixBus *other_bus, size_t frames_to_do)
+{
+	if (bus->float_buffer != NULL)
+	{
+		for (size_t i = 0; i < frames_to_do * CHANNEL_COUNT; ++i)
+			bus->float_buffer[i] += other_bus->float_buffer[i];
+	}
+	else
+	{
+		for (size_t i = 0; i < frames_to_do * CHANNEL_COUNT; ++i)
+			bus->long_buffer[i] += other_bus->long_buffer[i];
+	}
+}
+
+// Mixes a single voice into the bus, and returns true if it has reached its end.
+// Workers may be mixing other voices at the same time, so this must not modify anything but the voice itself.
+static bool MixVoice(ClownAudio_Mixer *mixer, size_t voice, const MixBus *bus, size_t frames_to_do, short *scratch)
+{
+	const MixKernels *kernels = mixer->kernels;
+	VoiceTable *voices = &mixer->voices;
+
+	const DecoderStage *pipeline = &voices->pipelines[voice];
+	unsigned short *final_volumes = &voices->final_volumes[voice * CHANNEL_COUNT];
+
+	// Loop until all requested frames have been mixed
+	size_t frames_done = 0;
+	while (frames_done != frames_to_do)
+	{
+		// We'll be reading into an intermediary (short) buffer, before mixing into the bus
+		short read_buffer[0x1000];
+
+		// Obtain samples. If the pipeline allows it, they are mixed from where it keeps them, rather than copied into the buffer.
+		const size_t sub_frames_to_do = MIN(COUNT_OF(read_buffer) / CHANNEL_COUNT, frames_to_do - frames_done);
+
+		const short *samples = read_buffer;
+		size_t sub_frames_done;
+		bool ended;
+
+		if (pipeline->ReadDirect != NULL)
+		{
+			sub_frames_done = pipeline->ReadDirect(pipeline->decoder, &samples, sub_frames_to_do);
+			ended = sub_frames_done == 0;
+		}
+		else
+		{
+			sub_frames_done = pipeline->GetSamples(pipeline->decoder, read_buffer, sub_frames_to_do, scratch);
+			ended = sub_frames_done < sub_frames_to_do;
+		}
+
+		long *long_output = bus->long_buffer != NULL ? &bus->long_buffer[frames_done * CHANNEL_COUNT] : NULL;
+		float *float_output = bus->float_buffer != NULL ? &bus->float_buffer[frames_done * CHANNEL_COUNT] : NULL;
+
+		// Choose from multiple mixing codepaths
+		if (voices->fade_countdowns[voice] != 0)
+		{
+			// Slow path which performs fading and volume adjustments.
+			// The fade is stepped here one frame at a time, and the resulting volumes are then applied in bulk.
+			unsigned short volumes[COUNT_OF(read_buffer)];
+
+			const ClownAudio_Sound *sound = voices->sounds[voice];
+			const size_t fade_frames = MIN(sub_frames_done, voices->fade_countdowns[voice]);
+
+			for (size_t i = 0; i < fade_frames; ++i)
+			{
+				--voices->fade_countdowns[voice];
+				voices->fade_volume_accumulators[voice] += voices->fade_volume_deltas[voice];
+				ComputeFinalVolumes(final_volumes, sound->volume_left, sound->volume_right, voices->fade_volume_accumulators[voice]);
+
+				volumes[i * CHANNEL_COUNT + 0] = final_volumes[0];
+				volumes[i * CHANNEL_COUNT + 1] = final_volumes[1];
+			}
+
+			// Once the fade is over, the rest of the samples are mixed at a constant volume
+			const size_t fade_samples = fade_frames * CHANNEL_COUNT;
+
+			if (float_output != NULL)
+			{
+				kernels->MixVolumeRampFloat(float_output, samples, fade_frames, volumes);
+				kernels->MixVolumeFloat(float_output + fade_samples, samples + fade_samples, sub_frames_done - fade_frames, final_volumes[0], final_volumes[1]);
+			}
+			else
+			{
+				kernels->MixVolumeRamp(long_output, samples, fade_frames, volumes);
+				kernels->MixVolume(long_output + fade_samples, samples + fade_samples, sub_frames_done - fade_frames, final_volumes[0], final_volumes[1]);
+			}
+		}
+		else if (final_volumes[0] != 0x100 || final_volumes[1] != 0x100)
+		{
+			// Fast path which bypasses fading
+			if (float_output != NULL)
+				kernels->MixVolumeFloat(float_output, samples, sub_frames_done, final_volumes[0], final_volumes[1]);
+			else
+				kernels->MixVolume(long_output, samples, sub_frames_done, final_volumes[0], final_volumes[1]);
+		}
+		else
+		{
+			// Fastest path which bypasses fading and volume adjustments
+			if (float_output != NULL)
+				kernels->MixFloat(float_output, samples, sub_frames_done);
+			else
+				kernels->Mix(long_output, samples, sub_frames_done);
+		}
+
+		frames_done += sub_frames_done;
+
+		// If the pipeline ran out of samples, then the sound has reached its end
+		if (ended)
+			return true;
+	}
+
+	return false;
+}
+
+// Deals with a voice that has reached its end. This removes the voice, and moves another into its place.
+static void FinishVoice(ClownAudio_Mixer *mixer, size_t voice)
+{
+	ClownAudio_Sound *sound = mixer->voices.sounds[voice];
+
+	if (sound->destroy_when_done)
+		DestroySound(mixer, sound);
+	else
+		PauseSound(mixer, sound);
+}
+
+// Mixes voices from the current job until there are none left. Returns how many voices were mixed.
+static size_t MixClaimedVoices(ClownAudio_Mixer *mixer, const MixBus *bus, short *scratch, bool clear_bus)
+{
+	size_t voices_mixed = 0;
+
+	for (;;)
+	{
+		const size_t voice = Atomic_FetchAdd(&mixer->job_next_voice, 1);
+
+		if (voice >= mixer->job_voice_count)
+			break;
+
+		// Buses are only cleared when they are actually going to be used
+		if (clear_bus && voices_mixed == 0)
+			ClearBus(bus, mixer->job_frames);
+
+		mixer->voices.finished[voice] = MixVoice(mixer, voice, bus, mixer->job_frames, scratch);
+		++voices_mixed;
+	}
+
+	return voices_mixed;
+}
+
+static void WorkerThread(void *user_data)
+{
+	MixWorker *worker = (MixWorker*)user_data;
+	ClownAudio_Mixer *mixer = worker->mixer;
+
+	for (;;)
+	{
+		Semaphore_Wait(worker->start_semaphore);
+
+		if (mixer->workers_quit)
+			break;
+
+		const MixBus bus = MakeBus(&worker->bus, mixer->job_float_bus);
+		worker->voices_mixed = MixClaimedVoices(mixer, &bus, worker->scratch, true);
+
+		Semaphore_Post(mixer->workers_done_semaphore);
+	}
+}
+
+static void StopWorkers(ClownAudio_Mixer *mixer)
+{
+	mixer->workers_quit = true;
+
+	for (unsigned int i = 0; i < mixer->worker_count; ++i)
+		Semaphore_Post(mixer->workers[i]->start_semaphore);
+
+	for (unsigned int i = 0; i < mixer->worker_count; ++i)
+	{
+		Thread_Join(mixer->workers[i]->thread);
+		Semaphore_Destroy(mixer->workers[i]->start_semaphore);
+		free(mixer->workers[i]);
+	}
+
+	free(mixer->workers);
+
+	if (mixer->workers_done_semaphore != NULL)
+		Semaphore_Destroy(mixer->workers_done_semaphore);
+
+	mixer->workers = NULL;
+	mixer->worker_count = 0;
+	mixer->workers_done_semaphore = NULL;
+	mixer->workers_quit = false;
 }
 
 CLOWNAUDIO_EXPORT void ClownAudio_SoundDataConfigInit(ClownAudio_SoundDataConfig *config)
@@ -213,6 +874,7 @@ CLOWNAUDIO_EXPORT void ClownAudio_SoundDataConfigInit(ClownAudio_SoundDataConfig
 	config->predecode = false;
 	config->must_predecode = false;
 	config->dynamic_sample_rate = false;
+	config->predecode_cache_directory = NULL;
 }
 
 CLOWNAUDIO_EXPORT void ClownAudio_SoundConfigInit(ClownAudio_SoundConfig *config)
@@ -220,33 +882,187 @@ CLOWNAUDIO_EXPORT void ClownAudio_SoundConfigInit(ClownAudio_SoundConfig *config
 	config->loop = false;
 	config->do_not_destroy_when_done = false;
 	config->dynamic_sample_rate = false;
+	config->decode_ahead = false;
+}
+
+CLOWNAUDIO_EXPORT ClownAudio_Mixer* ClownAudio_Mixer_Create(unsigned long sample_rate)
+{
+	ClownAudio_Mixer *mixer = (ClownAudio_Mixer*)malloc(sizeof(ClownAudio_Mixer));
+
+	if (mixer != NULL)
+	{
+		mixer->pool = Pool_Create();
+
+		if (mixer->pool == NULL)
+		{
+			free(mixer);
+			return NULL;
+		}
+
+		mixer->garbage_mutex = Mutex_Create();
+
+		if (mixer->garbage_mutex == NULL)
+		{
+			Pool_Destroy(mixer->pool);
+			free(mixer);
+			return NULL;
+		}
+
+		for (size_t i = 0; i < COUNT_OF(mixer->sound_slot_pages); ++i)
+			mixer->sound_slot_pages[i] = NULL;
+
+		mixer->sound_slot_count = 0;
+		mixer->sound_slot_free_list = 0;
+
+		mixer->voices.count = 0;
+		mixer->voices.capacity = 0;
+		mixer->voices.block = NULL;
+
+		mixer->sound_count = 0;
+
+		mixer->spare_voice_block = NULL;
+		mixer->voice_capacity = 0;
+		mixer->live_sound_ids = 0;
+		mixer->retired_sounds = NULL;
+		mixer->retired_voice_blocks = NULL;
+
+		mixer->sample_rate = sample_rate;
+
+		mixer->kernels = MixKernels_Select();
+
+		mixer->workers = NULL;
+		mixer->worker_count = 0;
+		mixer->workers_done_semaphore = NULL;
+		mixer->workers_quit = false;
+
+		mixer->decode_ahead_thread = NULL;
+		mixer->load_thread_pool = NULL;
+	}
+
+	return mixer;
+}
+
+CLOWNAUDIO_EXPORT void ClownAudio_Mixer_Destroy(ClownAudio_Mixer *mixer)
+{
+	StopWorkers(mixer);
+
+	// Destroy any sounds that are still registered, since their pipelines may be using the decode-ahead thread
+	for (unsigned long i = 0; i < mixer->sound_slot_count; ++i)
+	{
+		SoundSlot *slot = GetSoundSlot(mixer, i);
+
+		if (slot != NULL && slot->sound != NULL)
+			DestroySound(mixer, slot->sound);
+	}
+
+	ClownAudio_Mixer_CollectGarbage(mixer);
+
+	for (size_t i = 0; i < COUNT_OF(mixer->sound_slot_pages); ++i)
+		free(mixer->sound_slot_pages[i]);
+
+	if (mixer->decode_ahead_thread != NULL)
+		DecodeAheadThread_Destroy((DecodeAheadThread*)mixer->decode_ahead_thread);
+
+	if (mixer->load_thread_pool != NULL)
+		ThreadPool_Destroy((ThreadPool*)mixer->load_thread_pool);
+
+	free(mixer->spare_voice_block);
+	free(mixer->voices.block);
+	Mutex_Destroy(mixer->garbage_mutex);
+	Pool_Destroy(mixer->pool);
+	free(mixer);
+}
+
+CLOWNAUDIO_EXPORT bool ClownAudio_Mixer_SetWorkerCount(ClownAudio_Mixer *mixer, unsigned int worker_count)
+{
+	StopWorkers(mixer);
+
+	if (worker_count == 0)
+		return true;
+
+	mixer->workers_done_semaphore = Semaphore_Create(0);
+	mixer->workers = (MixWorker**)malloc(sizeof(MixWorker*) * worker_count);
+
+	if (mixer->workers_done_semaphore != NULL && mixer->workers != NULL)
+	{
+		while (mixer->worker_count < worker_count)
+		{
+			MixWorker *worker = (MixWorker*)malloc(sizeof(MixWorker));
+
+			if (worker == NULL)
+				break;
+
+			worker->mixer = mixer;
+			worker->start_semaphore = Semaphore_Create(0);
+
+			if (worker->start_semaphore != NULL)
+			{
+				worker->thread = Thread_Create(WorkerThread, worker);
+
+				if (worker->thread != NULL)
+				{
+					mixer->workers[mixer->worker_count++] = worker;
+					continue;
+				}
+
+				Semaphore_Destroy(worker->start_semaphore);
+			}
+
+			free(worker);
+			break;
+		}
+
+		if (mixer->worker_count == worker_count)
+			return true;
+	}
+
+	StopWorkers(mixer);
+
+	return false;
 }
 
-CLOWNAUDIO_EXPORT ClownAudio_Mixer* ClownAudio_Mixer_Create(unsigned long sample_rate)
+CLOWNAUDIO_EXPORT void ClownAudio_Mixer_CollectGarbage(ClownAudio_Mixer *mixer)
 {
-	ClownAudio_Mixer *mixer = (ClownAudio_Mixer*)malloc(sizeof(ClownAudio_Mixer));
+	Mutex_Lock(mixer->garbage_mutex);
 
-	if (mixer != NULL)
+	for (ClownAudio_Sound *sound = (ClownAudio_Sound*)TakePointer(&mixer->retired_sounds); sound != NULL; )
 	{
-		for (size_t i = 0; i < COUNT_OF(mixer->sound_hash_table); ++i)
-			mixer->sound_hash_table[i] = NULL;
+		ClownAudio_Sound *next_sound = (ClownAudio_Sound*)sound->next_retired;
 
-		mixer->playing_list_head = NULL;
+		sound->pipeline.Destroy(sound->pipeline.decoder);
+		Pool_Free(sound);
 
-		mixer->sample_rate = sample_rate;
+		sound = next_sound;
+	}
+
+	for (VoiceBlock *block = (VoiceBlock*)TakePointer(&mixer->retired_voice_blocks); block != NULL; )
+	{
+		VoiceBlock *next_block = (VoiceBlock*)block->next_retired;
+
+		free(block);
 
-		mixer->sound_id_allocator = 0;
+		block = next_block;
 	}
 
-	return mixer;
+	Mutex_Unlock(mixer->garbage_mutex);
 }
 
-CLOWNAUDIO_EXPORT void ClownAudio_Mixer_Destroy(ClownAudio_Mixer *mixer)
+// One of the files that sound-data is made from
+typedef struct SoundFile
 {
-	free(mixer);
+	const unsigned char *buffer;
+	size_t size;
+	IOSource *io_source;	// Used instead of `buffer` if it is not NULL
+	const char *filename;	// Optional, and only used to help identify the file's format
+} SoundFile;
+
+static DecoderSelectorData* LoadSoundFile(const SoundFile *file, ClownAudio_SoundDataConfig *config, const DecoderSpec *wanted_spec)
+{
+	return DecoderSelector_LoadData(file->buffer, file->size, file->io_source, file->filename, config->predecode, config->must_predecode, config->predecode_cache_directory, wanted_spec);
 }
 
-CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_Mixer_SoundDataLoadFromMemory(ClownAudio_Mixer *mixer, const unsigned char *file_buffer1, size_t file_size1, const unsigned char *file_buffer2, size_t file_size2, ClownAudio_SoundDataConfig *config)
+// Either file can be NULL, but not both
+static ClownAudio_SoundData* LoadSoundData(ClownAudio_Mixer *mixer, const SoundFile *file1, const SoundFile *file2, ClownAudio_SoundDataConfig *config)
 {
 	ClownAudio_SoundData *sound_data = (ClownAudio_SoundData*)malloc(sizeof(ClownAudio_SoundData));
 
@@ -259,13 +1075,15 @@ CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_Mixer_SoundDataLoadFromMemory
 
 		sound_data->sound_list_sentinel.next_sibling = NULL;
 
-		sound_data->file_buffers[0] = NULL;
-		sound_data->file_buffers[1] = NULL;
+		sound_data->file_mappings[0] = NULL;
+		sound_data->file_mappings[1] = NULL;
+		sound_data->io_sources[0] = NULL;
+		sound_data->io_sources[1] = NULL;
 
-		if (file_buffer1 != NULL && file_buffer2 != NULL)
+		if (file1 != NULL && file2 != NULL)
 		{
-			sound_data->decoder_selector_data[0] = DecoderSelector_LoadData(file_buffer1, file_size1, config->predecode, config->must_predecode, &wanted_spec);
-			sound_data->decoder_selector_data[1] = DecoderSelector_LoadData(file_buffer2, file_size2, config->predecode, config->must_predecode, &wanted_spec);
+			sound_data->decoder_selector_data[0] = LoadSoundFile(file1, config, &wanted_spec);
+			sound_data->decoder_selector_data[1] = LoadSoundFile(file2, config, &wanted_spec);
 
 			if (sound_data->decoder_selector_data[0] != NULL && sound_data->decoder_selector_data[1] != NULL)
 				return sound_data;
@@ -276,18 +1094,18 @@ CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_Mixer_SoundDataLoadFromMemory
 			if (sound_data->decoder_selector_data[1] != NULL)
 				DecoderSelector_UnloadData(sound_data->decoder_selector_data[1]);
 		}
-		else if (file_buffer1 != NULL)
+		else if (file1 != NULL)
 		{
-			sound_data->decoder_selector_data[0] = DecoderSelector_LoadData(file_buffer1, file_size1, config->predecode, config->must_predecode, &wanted_spec);
+			sound_data->decoder_selector_data[0] = LoadSoundFile(file1, config, &wanted_spec);
 			sound_data->decoder_selector_data[1] = NULL;
 
 			if (sound_data->decoder_selector_data[0] != NULL)
 				return sound_data;
 		}
-		else if (file_buffer2 != NULL)
+		else if (file2 != NULL)
 		{
 			sound_data->decoder_selector_data[0] = NULL;
-			sound_data->decoder_selector_data[1] = DecoderSelector_LoadData(file_buffer2, file_size2, config->predecode, config->must_predecode, &wanted_spec);
+			sound_data->decoder_selector_data[1] = LoadSoundFile(file2, config, &wanted_spec);
 
 			if (sound_data->decoder_selector_data[1] != NULL)
 				return sound_data;
@@ -299,50 +1117,254 @@ CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_Mixer_SoundDataLoadFromMemory
 	return NULL;
 }
 
+// Predecoded sound-data never reads its files again, so there is no point in keeping them around
+static void ReleaseUnneededFiles(ClownAudio_SoundData *sound_data)
+{
+	for (unsigned int i = 0; i < 2; ++i)
+	{
+		if (sound_data->decoder_selector_data[i] != NULL && !DecoderSelector_NeedsFile(sound_data->decoder_selector_data[i]))
+		{
+			if (sound_data->file_mappings[i] != NULL)
+			{
+				FileMapping_Close(sound_data->file_mappings[i]);
+				sound_data->file_mappings[i] = NULL;
+			}
+
+			if (sound_data->io_sources[i] != NULL)
+			{
+				IOSource_Destroy(sound_data->io_sources[i]);
+				sound_data->io_sources[i] = NULL;
+			}
+		}
+	}
+}
+
+CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_Mixer_SoundDataLoadFromMemory(ClownAudio_Mixer *mixer, const unsigned char *file_buffer1, size_t file_size1, const unsigned char *file_buffer2, size_t file_size2, ClownAudio_SoundDataConfig *config)
+{
+	SoundFile files[2];
+
+	files[0].buffer = file_buffer1;
+	files[0].size = file_size1;
+	files[0].io_source = NULL;
+	files[0].filename = NULL;
+
+	files[1].buffer = file_buffer2;
+	files[1].size = file_size2;
+	files[1].io_source = NULL;
+	files[1].filename = NULL;
+
+	return LoadSoundData(mixer, file_buffer1 != NULL ? &files[0] : NULL, file_buffer2 != NULL ? &files[1] : NULL, config);
+}
+
 CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_Mixer_SoundDataLoadFromFiles(ClownAudio_Mixer *mixer, const char *intro_path, const char *loop_path, ClownAudio_SoundDataConfig *config)
 {
 	if ((intro_path != NULL && intro_path[0] != '\0') || (loop_path != NULL && loop_path[0] != '\0'))
 	{
-		unsigned char *file_buffers[2];
-		size_t file_buffer_sizes[2];
+		// The files are mapped rather than read, so the decoders only page in the parts that they actually use
+		FileMapping *file_mappings[2];
+		SoundFile files[2];
+
+		files[0].io_source = NULL;
+		files[0].filename = intro_path;
 
-		if (LoadFileToMemory(intro_path, &file_buffers[0], &file_buffer_sizes[0]))
+		files[1].io_source = NULL;
+		files[1].filename = loop_path;
+
+		if (MapFile(intro_path, &file_mappings[0], &files[0].buffer, &files[0].size))
 		{
-			if (LoadFileToMemory(loop_path, &file_buffers[1], &file_buffer_sizes[1]))
+			if (MapFile(loop_path, &file_mappings[1], &files[1].buffer, &files[1].size))
 			{
-				ClownAudio_SoundData *sound_data = ClownAudio_Mixer_SoundDataLoadFromMemory(mixer, file_buffers[0], file_buffer_sizes[0], file_buffers[1], file_buffer_sizes[1], config);
+				ClownAudio_SoundData *sound_data = LoadSoundData(mixer, files[0].buffer != NULL ? &files[0] : NULL, files[1].buffer != NULL ? &files[1] : NULL, config);
 
 				if (sound_data != NULL)
 				{
-					sound_data->file_buffers[0] = file_buffers[0];
-					sound_data->file_buffers[1] = file_buffers[1];
+					sound_data->file_mappings[0] = file_mappings[0];
+					sound_data->file_mappings[1] = file_mappings[1];
+					ReleaseUnneededFiles(sound_data);
 
 					return sound_data;
 				}
 
-				free(file_buffers[1]);
+				if (file_mappings[1] != NULL)
+					FileMapping_Close(file_mappings[1]);
 			}
 
-			free(file_buffers[0]);
+			if (file_mappings[0] != NULL)
+				FileMapping_Close(file_mappings[0]);
 		}
 	}
 
 	return NULL;
 }
 
-CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundDataUnload(ClownAudio_Mixer *mixer, ClownAudio_SoundData *sound_data)
+CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_Mixer_SoundDataLoadFromIO(ClownAudio_Mixer *mixer, const ClownAudio_IO *io1, const ClownAudio_IO *io2, ClownAudio_SoundDataConfig *config)
 {
-	if (sound_data != NULL)
+	SoundFile files[2];
+
+	files[0].buffer = NULL;
+	files[0].size = 0;
+	files[0].io_source = io1 != NULL ? IOSource_Create(io1) : NULL;
+	files[0].filename = NULL;
+
+	files[1].buffer = NULL;
+	files[1].size = 0;
+	files[1].io_source = io2 != NULL ? IOSource_Create(io2) : NULL;
+	files[1].filename = NULL;
+
+	const bool io_sources_created = (io1 == NULL || files[0].io_source != NULL) && (io2 == NULL || files[1].io_source != NULL);
+
+	if (io_sources_created && (io1 != NULL || io2 != NULL))
 	{
-		// Destroy any sounds that use this sound data
-		for (ClownAudio_Sound *sound = sound_data->sound_list_sentinel.next_sibling; sound != NULL; )
+		ClownAudio_SoundData *sound_data = LoadSoundData(mixer, io1 != NULL ? &files[0] : NULL, io2 != NULL ? &files[1] : NULL, config);
+
+		if (sound_data != NULL)
+		{
+			sound_data->io_sources[0] = files[0].io_source;
+			sound_data->io_sources[1] = files[1].io_source;
+			ReleaseUnneededFiles(sound_data);
+
+			return sound_data;
+		}
+	}
+
+	if (files[1].io_source != NULL)
+		IOSource_Destroy(files[1].io_source);
+
+	if (files[0].io_source != NULL)
+		IOSource_Destroy(files[0].io_source);
+
+	return NULL;
+}
+
+// Returns NULL if `string` is NULL, or if memory could not be allocated
+static char* DuplicateString(const char *string)
+{
+	char *duplicate = NULL;
+
+	if (string != NULL)
+	{
+		const size_t size = strlen(string) + 1;
+
+		duplicate = (char*)malloc(size);
+
+		if (duplicate != NULL)
+			memcpy(duplicate, string, size);
+	}
+
+	return duplicate;
+}
+
+static void LoadAsyncJob(void *user_data)
+{
+	ClownAudio_SoundDataLoad *load = (ClownAudio_SoundDataLoad*)user_data;
+
+	// The load can be freed as soon as it is marked as done, so grab the callback before then
+	void (*callback)(void *user_data, ClownAudio_SoundData *sound_data) = load->callback;
+	void *callback_user_data = load->user_data;
+
+	ClownAudio_SoundData *sound_data = ClownAudio_Mixer_SoundDataLoadFromFiles(load->mixer, load->paths[0], load->paths[1], &load->config);
+
+	load->sound_data = sound_data;
+	Atomic_Store(&load->done, true);
+	Semaphore_Post(load->done_semaphore);
+
+	if (callback != NULL)
+		callback(callback_user_data, sound_data);
+}
+
+CLOWNAUDIO_EXPORT ClownAudio_SoundDataLoad* ClownAudio_Mixer_SoundDataLoadAsync(ClownAudio_Mixer *mixer, const char *intro_path, const char *loop_path, ClownAudio_SoundDataConfig *config, void (*callback)(void *user_data, ClownAudio_SoundData *sound_data), void *user_data)
+{
+	ThreadPool *pool = GetLoadThreadPool(mixer);
+
+	if (pool != NULL)
+	{
+		ClownAudio_SoundDataLoad *load = (ClownAudio_SoundDataLoad*)malloc(sizeof(ClownAudio_SoundDataLoad));
+
+		if (load != NULL)
 		{
-			ClownAudio_Sound *next_sound = sound->next_sibling; // A work-around to avoid using `sound` after it is freed
+			load->done_semaphore = Semaphore_Create(0);
+
+			if (load->done_semaphore != NULL)
+			{
+				load->paths[0] = DuplicateString(intro_path);
+				load->paths[1] = DuplicateString(loop_path);
+				load->predecode_cache_directory = DuplicateString(config->predecode_cache_directory);
+
+				if ((intro_path == NULL || load->paths[0] != NULL) && (loop_path == NULL || load->paths[1] != NULL) && (config->predecode_cache_directory == NULL || load->predecode_cache_directory != NULL))
+				{
+					load->job.function = LoadAsyncJob;
+					load->job.user_data = load;
+					load->mixer = mixer;
+					load->config = *config;
+					load->config.predecode_cache_directory = load->predecode_cache_directory;
+					load->callback = callback;
+					load->user_data = user_data;
+					load->sound_data = NULL;
+					load->done = false;
+
+					ThreadPool_Submit(pool, &load->job);
+
+					return load;
+				}
 
-			DestroySound(mixer, sound);
+				free(load->predecode_cache_directory);
+				free(load->paths[1]);
+				free(load->paths[0]);
+				Semaphore_Destroy(load->done_semaphore);
+			}
 
-			sound = next_sound;
+			free(load);
 		}
+	}
+
+	return NULL;
+}
+
+CLOWNAUDIO_EXPORT bool ClownAudio_Mixer_SoundDataLoadIsDone(ClownAudio_Mixer *mixer, ClownAudio_SoundDataLoad *load)
+{
+	(void)mixer;
+
+	return Atomic_Load(&load->done);
+}
+
+CLOWNAUDIO_EXPORT ClownAudio_SoundData* ClownAudio_Mixer_SoundDataLoadFinish(ClownAudio_Mixer *mixer, ClownAudio_SoundDataLoad *load)
+{
+	(void)mixer;
+
+	Semaphore_Wait(load->done_semaphore);
+
+	ClownAudio_SoundData *sound_data = load->sound_data;
+
+	Semaphore_Destroy(load->done_semaphore);
+	free(load->predecode_cache_directory);
+	free(load->paths[1]);
+	free(load->paths[0]);
+	free(load);
+
+	return sound_data;
+}
+
+CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundDataDestroySounds(ClownAudio_Mixer *mixer, ClownAudio_SoundData *sound_data)
+{
+	for (ClownAudio_Sound *sound = sound_data->sound_list_sentinel.next_sibling; sound != NULL; )
+	{
+		ClownAudio_Sound *next_sound = sound->next_sibling; // A work-around to avoid using `sound` after it is freed
+
+		DestroySound(mixer, sound);
+
+		sound = next_sound;
+	}
+}
+
+CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundDataUnload(ClownAudio_Mixer *mixer, ClownAudio_SoundData *sound_data)
+{
+	if (sound_data != NULL)
+	{
+		// Destroy any sounds that use this sound data
+		ClownAudio_Mixer_SoundDataDestroySounds(mixer, sound_data);
+
+		// Sounds that were destroyed earlier may still be waiting to be freed, and they need the sound data too
+		ClownAudio_Mixer_CollectGarbage(mixer);
 
 		if (sound_data->decoder_selector_data[0] != NULL)
 			DecoderSelector_UnloadData(sound_data->decoder_selector_data[0]);
@@ -350,15 +1372,48 @@ CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundDataUnload(ClownAudio_Mixer *mixer,
 		if (sound_data->decoder_selector_data[1] != NULL)
 			DecoderSelector_UnloadData(sound_data->decoder_selector_data[1]);
 
-		free(sound_data->file_buffers[0]);
-		free(sound_data->file_buffers[1]);
+		if (sound_data->file_mappings[0] != NULL)
+			FileMapping_Close(sound_data->file_mappings[0]);
+
+		if (sound_data->file_mappings[1] != NULL)
+			FileMapping_Close(sound_data->file_mappings[1]);
+
+		if (sound_data->io_sources[0] != NULL)
+			IOSource_Destroy(sound_data->io_sources[0]);
+
+		if (sound_data->io_sources[1] != NULL)
+			IOSource_Destroy(sound_data->io_sources[1]);
 
 		free(sound_data);
 	}
 }
 
+// Joins an intro stage and a loop stage into one, taking ownership of them on success
+static bool CreateSplitStage(DecoderStage *stage, DecoderStage *intro_stage, DecoderStage *loop_stage, unsigned int channel_count, Pool *pool)
+{
+	// `stage` is allowed to be one of the other two, so read from them before it is overwritten
+	const bool can_read_direct = intro_stage->ReadDirect != NULL && loop_stage->ReadDirect != NULL;
+
+	void *split_decoder = SplitDecoder_Create(intro_stage, loop_stage, channel_count, pool);
+
+	if (split_decoder == NULL)
+		return false;
+
+	stage->decoder = split_decoder;
+	stage->Destroy = SplitDecoder_Destroy;
+	stage->Rewind = SplitDecoder_Rewind;
+	stage->GetSamples = SplitDecoder_GetSamples;
+	stage->SetLoop = SplitDecoder_SetLoop;
+	stage->ReadDirect = can_read_direct ? SplitDecoder_ReadDirect : NULL;
+
+	return true;
+}
+
 CLOWNAUDIO_EXPORT ClownAudio_Sound* ClownAudio_Mixer_SoundCreate(ClownAudio_Mixer *mixer, ClownAudio_SoundData *sound_data, ClownAudio_SoundConfig *config)
 {
+	// This is never called on the audio thread, so it is a good time to free any sounds that have finished
+	ClownAudio_Mixer_CollectGarbage(mixer);
+
 	if (sound_data != NULL)
 	{
 		DecoderSpec wanted_spec;
@@ -378,7 +1433,7 @@ CLOWNAUDIO_EXPORT ClownAudio_Sound* ClownAudio_Mixer_SoundCreate(ClownAudio_Mixe
 
 		if (sound_data->decoder_selector_data[0] != NULL)
 		{
-			decoder_selectors[0] = DecoderSelector_Create(sound_data->decoder_selector_data[0], sound_data->decoder_selector_data[1] != NULL ? false : config->loop, &wanted_spec, &specs[0]);
+			decoder_selectors[0] = DecoderSelector_Create(sound_data->decoder_selector_data[0], sound_data->decoder_selector_data[1] != NULL ? false : config->loop, &wanted_spec, &specs[0], mixer->pool);
 
 			if (decoder_selectors[0] != NULL)
 			{
@@ -387,12 +1442,13 @@ CLOWNAUDIO_EXPORT ClownAudio_Sound* ClownAudio_Mixer_SoundCreate(ClownAudio_Mixe
 				selector_stages[0].Rewind = DecoderSelector_Rewind;
 				selector_stages[0].GetSamples = DecoderSelector_GetSamples;
 				selector_stages[0].SetLoop = DecoderSelector_SetLoop;
+				selector_stages[0].ReadDirect = DecoderSelector_CanReadDirect(sound_data->decoder_selector_data[0]) ? DecoderSelector_ReadDirect : NULL;
 			}
 		}
 
 		if (sound_data->decoder_selector_data[1] != NULL)
 		{
-			decoder_selectors[1] = DecoderSelector_Create(sound_data->decoder_selector_data[1], config->loop, &wanted_spec, &specs[1]);
+			decoder_selectors[1] = DecoderSelector_Create(sound_data->decoder_selector_data[1], config->loop, &wanted_spec, &specs[1], mixer->pool);
 
 			if (decoder_selectors[1] != NULL)
 			{
@@ -401,12 +1457,66 @@ CLOWNAUDIO_EXPORT ClownAudio_Sound* ClownAudio_Mixer_SoundCreate(ClownAudio_Mixe
 				selector_stages[1].Rewind = DecoderSelector_Rewind;
 				selector_stages[1].GetSamples = DecoderSelector_GetSamples;
 				selector_stages[1].SetLoop = DecoderSelector_SetLoop;
+				selector_stages[1].ReadDirect = DecoderSelector_CanReadDirect(sound_data->decoder_selector_data[1]) ? DecoderSelector_ReadDirect : NULL;
 			}
 		}
 
 		if (decoder_selectors[0] == NULL && decoder_selectors[1] == NULL)
 			return NULL;
 
+		// If requested, move the decoder-selectors off of the audio thread. Streamed files always are, since
+		// reading them means calling the user's I/O callbacks and waiting for the other streams to finish with them.
+
+		bool decode_ahead = config->decode_ahead;
+
+		for (size_t i = 0; i < 2; ++i)
+			if (decoder_selectors[i] != NULL && DecoderSelector_IsStreamed(sound_data->decoder_selector_data[i]))
+				decode_ahead = true;
+
+		if (decode_ahead)
+		{
+			DecodeAheadThread *decode_ahead_thread = GetDecodeAheadThread(mixer);
+
+			for (size_t i = 0; i < 2; ++i)
+			{
+				if (decoder_selectors[i] != NULL)
+				{
+					void *decode_ahead_decoder = decode_ahead_thread == NULL ? NULL : DecodeAheadDecoder_Create(&selector_stages[i], &specs[i], i == 1 || decoder_selectors[1] == NULL ? config->loop : false, decode_ahead_thread, mixer->pool);
+
+					if (decode_ahead_decoder == NULL)
+					{
+						for (size_t j = 0; j < 2; ++j)
+							if (decoder_selectors[j] != NULL)
+								selector_stages[j].Destroy(selector_stages[j].decoder);
+
+						return NULL;
+					}
+
+					selector_stages[i].decoder = decode_ahead_decoder;
+					selector_stages[i].Destroy = DecodeAheadDecoder_Destroy;
+					selector_stages[i].Rewind = DecodeAheadDecoder_Rewind;
+					selector_stages[i].GetSamples = DecodeAheadDecoder_GetSamples;
+					selector_stages[i].SetLoop = DecodeAheadDecoder_SetLoop;
+					selector_stages[i].ReadDirect = NULL;
+				}
+			}
+		}
+
+		// If the intro and loop share a format, then join them before resampling, so that a single
+		// resampler can handle both, and the seam between them is resampled like any other part of the sound
+
+		if (decoder_selectors[0] != NULL && decoder_selectors[1] != NULL && specs[0].sample_rate == specs[1].sample_rate && specs[0].channel_count == specs[1].channel_count)
+		{
+			if (!CreateSplitStage(&selector_stages[0], &selector_stages[0], &selector_stages[1], specs[0].channel_count, mixer->pool))
+			{
+				selector_stages[0].Destroy(selector_stages[0].decoder);
+				selector_stages[1].Destroy(selector_stages[1].decoder);
+				return NULL;
+			}
+
+			decoder_selectors[1] = NULL;	// It belongs to the split-decoder now
+		}
+
 		// Now for the resampler(s)
 
 		wanted_spec.sample_rate = mixer->sample_rate;	// Now update the sample rate, so the resampler converts to the mixer's expected rate
@@ -419,17 +1529,26 @@ CLOWNAUDIO_EXPORT ClownAudio_Sound* ClownAudio_Mixer_SoundCreate(ClownAudio_Mixe
 		{
 			if (decoder_selectors[i] != NULL)
 			{
-				resampled_decoders[i] = ResampledDecoder_Create(&selector_stages[i], config->dynamic_sample_rate, &wanted_spec, &specs[i]);
-
-				if (resampled_decoders[i] == NULL)
+				// Sounds that already match the mixer have nothing to resample, unless their sample rate can be changed later.
+				// Without the resampler, there is no low-pass filter either, which is why that needs `dynamic_sample_rate` too.
+				if (!config->dynamic_sample_rate && specs[i].sample_rate == wanted_spec.sample_rate && specs[i].channel_count == wanted_spec.channel_count)
 				{
-					DecoderSelector_Destroy(decoder_selectors[i]);
+					resampled_stages[i] = selector_stages[i];
+					continue;
+				}
 
-					if (resampled_decoders[0] != NULL)
-						ResampledDecoder_Destroy(resampled_decoders[0]);
+				resampled_decoders[i] = ResampledDecoder_Create(&selector_stages[i], config->dynamic_sample_rate, &wanted_spec, &specs[i], mixer->pool);
 
-					if (resampled_decoders[1] != NULL)
-						ResampledDecoder_Destroy(resampled_decoders[1]);
+				if (resampled_decoders[i] == NULL)
+				{
+					for (size_t j = 0; j < 2; ++j)
+					{
+						if (decoder_selectors[j] != NULL)
+						{
+							DecoderStage *stage_to_destroy = j < i ? &resampled_stages[j] : &selector_stages[j];
+							stage_to_destroy->Destroy(stage_to_destroy->decoder);
+						}
+					}
 
 					return NULL;
 				}
@@ -439,46 +1558,29 @@ CLOWNAUDIO_EXPORT ClownAudio_Sound* ClownAudio_Mixer_SoundCreate(ClownAudio_Mixe
 				resampled_stages[i].Rewind = ResampledDecoder_Rewind;
 				resampled_stages[i].GetSamples = ResampledDecoder_GetSamples;
 				resampled_stages[i].SetLoop = ResampledDecoder_SetLoop;
+				resampled_stages[i].ReadDirect = NULL;
 			}
 		}
 
-		// Now for the split-decoder, if needed
-
-		void *split_decoder = NULL;
+		// Now for the split-decoder, if the intro and loop could not be joined earlier
 
 		if (decoder_selectors[0] != NULL && decoder_selectors[1] != NULL)
 		{
-			split_decoder = SplitDecoder_Create(&resampled_stages[0], &resampled_stages[1], CHANNEL_COUNT);
-
-			if (split_decoder == NULL)
+			if (!CreateSplitStage(&stage, &resampled_stages[0], &resampled_stages[1], CHANNEL_COUNT, mixer->pool))
 			{
-				ResampledDecoder_Destroy(resampled_decoders[0]);
-				ResampledDecoder_Destroy(resampled_decoders[1]);
+				resampled_stages[0].Destroy(resampled_stages[0].decoder);
+				resampled_stages[1].Destroy(resampled_stages[1].decoder);
 				return NULL;
 			}
-
-			stage.decoder = split_decoder;
-			stage.Destroy = SplitDecoder_Destroy;
-			stage.Rewind = SplitDecoder_Rewind;
-			stage.GetSamples = SplitDecoder_GetSamples;
-			stage.SetLoop = SplitDecoder_SetLoop;
 		}
 		else
 		{
-			if (resampled_decoders[0] != NULL)
-				stage.decoder = resampled_decoders[0];
-			else
-				stage.decoder = resampled_decoders[1];
-
-			stage.Destroy = ResampledDecoder_Destroy;
-			stage.Rewind = ResampledDecoder_Rewind;
-			stage.GetSamples = ResampledDecoder_GetSamples;
-			stage.SetLoop = ResampledDecoder_SetLoop;
+			stage = resampled_stages[decoder_selectors[0] != NULL ? 0 : 1];
 		}
 
 		// Finally we're done - now just allocate the sound
 
-		ClownAudio_Sound *sound = (ClownAudio_Sound*)malloc(sizeof(ClownAudio_Sound));
+		ClownAudio_Sound *sound = (ClownAudio_Sound*)Pool_Alloc(mixer->pool, sizeof(ClownAudio_Sound));
 
 		if (sound == NULL)
 		{
@@ -508,39 +1610,63 @@ CLOWNAUDIO_EXPORT ClownAudio_Sound* ClownAudio_Mixer_SoundCreate(ClownAudio_Mixe
 	return NULL;
 }
 
-CLOWNAUDIO_EXPORT ClownAudio_SoundID ClownAudio_Mixer_SoundRegister(ClownAudio_Mixer *mixer, ClownAudio_Sound *sound, ClownAudio_SoundData *sound_data)
+CLOWNAUDIO_EXPORT ClownAudio_SoundID ClownAudio_Mixer_SoundAllocateID(ClownAudio_Mixer *mixer)
 {
-	ClownAudio_SoundID sound_id = 0;
+	unsigned long index;
 
-	if (sound != NULL)
+	if (!AllocateSoundSlot(mixer, &index))
+		return 0;
+
+	// Make sure that registering the sound will not require the mixer to allocate memory
+	PrepareVoices(mixer, Atomic_Load(&mixer->live_sound_ids));
+
+	// The slot's generation cannot change until the slot is freed again, so nothing else can be touching its state.
+	// Sounds start off paused, so that is what the ID reports until it is used.
+	SoundSlot *slot = GetSoundSlot(mixer, index);
+	const unsigned long generation = SLOT_STATE_GENERATION(Atomic_Load(&slot->state));
+
+	Atomic_Store(&slot->state, SLOT_STATE(generation, SLOT_STATUS_PAUSED));
+
+	return (ClownAudio_SoundID)((generation << 16) | index);
+}
+
+CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundRegisterWithID(ClownAudio_Mixer *mixer, ClownAudio_Sound *sound, ClownAudio_SoundData *sound_data, ClownAudio_SoundID sound_id)
+{
+	// Make sure that there will be a voice available for when the sound is unpaused
+	if (sound_id == 0 || !ReserveVoices(mixer, mixer->sound_count + 1))
 	{
-		do
-		{
-			sound_id = ++mixer->sound_id_allocator;
-		} while (sound_id == 0);	// Do not let it allocate 0 - it is an error value
+		// The sound cannot be registered, so get rid of it
+		if (sound_id != 0)
+			FreeSoundSlot(mixer, sound_id & 0xFFFF);
+
+		RetireSound(mixer, sound);
+		return;
+	}
 
-		sound->id = sound_id;
+	++mixer->sound_count;
 
-		// Add sound to hash table of all sound
-		ClownAudio_Sound **sound_list_head_pointer = &mixer->sound_hash_table[sound_id % COUNT_OF(mixer->sound_hash_table)];
-		ClownAudio_Sound *sound_list_head = *sound_list_head_pointer;
+	sound->id = sound_id;
 
-		sound->prev_in_bucket = NULL;
-		sound->next_in_bucket = sound_list_head;
+	GetSoundSlot(mixer, sound_id & 0xFFFF)->sound = sound;
 
-		if (sound_list_head != NULL)
-			sound_list_head->prev_in_bucket = sound;
+	// Add sound to list of sounds derived from the same sound data
+	sound->prev_sibling = &sound_data->sound_list_sentinel;
+	sound->next_sibling = sound_data->sound_list_sentinel.next_sibling;
 
-		*sound_list_head_pointer = sound;
+	if (sound_data->sound_list_sentinel.next_sibling != NULL)
+		sound_data->sound_list_sentinel.next_sibling->prev_sibling = sound;
 
-		// Add sound to list of sounds derived from the same sound data
-		sound->prev_sibling = &sound_data->sound_list_sentinel;
-		sound->next_sibling = sound_data->sound_list_sentinel.next_sibling;
+	sound_data->sound_list_sentinel.next_sibling = sound;
+}
 
-		if (sound_data->sound_list_sentinel.next_sibling != NULL)
-			sound_data->sound_list_sentinel.next_sibling->prev_sibling = sound;
+CLOWNAUDIO_EXPORT ClownAudio_SoundID ClownAudio_Mixer_SoundRegister(ClownAudio_Mixer *mixer, ClownAudio_Sound *sound, ClownAudio_SoundData *sound_data)
+{
+	ClownAudio_SoundID sound_id = 0;
 
-		sound_data->sound_list_sentinel.next_sibling = sound;
+	if (sound != NULL)
+	{
+		sound_id = ClownAudio_Mixer_SoundAllocateID(mixer);
+		ClownAudio_Mixer_SoundRegisterWithID(mixer, sound, sound_data, sound_id);
 	}
 
 	return sound_id;
@@ -580,9 +1706,31 @@ CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundUnpause(ClownAudio_Mixer *mixer, Cl
 
 CLOWNAUDIO_EXPORT int ClownAudio_Mixer_SoundGetStatus(ClownAudio_Mixer *mixer, ClownAudio_SoundID sound_id)
 {
-	ClownAudio_Sound *sound = FindSound(mixer, sound_id);
+	const unsigned long index = sound_id & 0xFFFF;
+
+	if (index < SOUND_SLOT_LIMIT)
+	{
+		SoundSlot *slot = GetSoundSlot(mixer, index);
+
+		if (slot != NULL)
+		{
+			const unsigned long state = Atomic_Load(&slot->state);
+
+			if (SLOT_STATE_GENERATION(state) == sound_id >> 16)
+			{
+				switch (SLOT_STATE_STATUS(state))
+				{
+					case SLOT_STATUS_PLAYING:
+						return 0;
+
+					case SLOT_STATUS_PAUSED:
+						return 1;
+				}
+			}
+		}
+	}
 
-	return (sound == NULL) ? -1 : sound->paused;
+	return -1;
 }
 
 CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundSetVolume(ClownAudio_Mixer *mixer, ClownAudio_SoundID sound_id, unsigned short volume_left, unsigned short volume_right)
@@ -591,9 +1739,15 @@ CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundSetVolume(ClownAudio_Mixer *mixer,
 
 	if (sound != NULL)
 	{
+		if (!sound->paused)
+			SaveVoiceState(mixer, sound);
+
 		sound->volume_left = volume_left;
 		sound->volume_right = volume_right;
 		UpdateSoundVolume(sound);
+
+		if (!sound->paused)
+			LoadVoiceState(mixer, sound);
 	}
 }
 
@@ -639,6 +1793,9 @@ CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundFade(ClownAudio_Mixer *mixer, Clown
 
 	if (sound != NULL)
 	{
+		if (!sound->paused)
+			SaveVoiceState(mixer, sound);
+
 		sound->fade_countdown = (mixer->sample_rate * duration) / 1000; // Convert duration from milliseconds to audio frames
 
 		if (sound->fade_countdown <= 1)
@@ -653,113 +1810,155 @@ CLOWNAUDIO_EXPORT void ClownAudio_Mixer_SoundFade(ClownAudio_Mixer *mixer, Clown
 			// Finish setting-up to fade in the mixer
 			sound->fade_volume_delta = (((long)volume << 16) - (long)sound->fade_volume_accumulator) / (long)sound->fade_countdown;
 		}
+
+		if (!sound->paused)
+			LoadVoiceState(mixer, sound);
 	}
 }
 
-CLOWNAUDIO_EXPORT void ClownAudio_Mixer_MixSamples(ClownAudio_Mixer *mixer, long *output_buffer, size_t frames_to_do)
+static void MixSamples(ClownAudio_Mixer *mixer, const MixBus *bus, size_t frames_to_do)
 {
-	const long *output_buffer_end = output_buffer + frames_to_do * CHANNEL_COUNT;
-
-	ClownAudio_Sound *sound = mixer->playing_list_head;
+	VoiceTable *voices = &mixer->voices;
 
-	// Linked-list: iterate until it ends
-	while (sound != NULL)
+	if (mixer->worker_count == 0 || voices->count < 2)
 	{
-		// Cache this for later (`sound` may be freed by then)
-		ClownAudio_Sound *next_sound = sound->next_playing;
-
-		long *output_buffer_pointer = output_buffer;
+		// Voices can be removed part-way through, so only advance when the current one survives
+		size_t voice = 0;
+		while (voice < voices->count)
+		{
+			if (MixVoice(mixer, voice, bus, frames_to_do, mixer->scratch))
+				FinishVoice(mixer, voice);
+			else
+				++voice;
+		}
+	}
+	else
+	{
+		size_t frames_done = 0;
 
-		// Loop until all requested samples have been written
-		size_t samples_to_do;
-		while ((samples_to_do = output_buffer_end - output_buffer_pointer) != 0)
+		while (frames_done != frames_to_do)
 		{
-			// We'll be reading into an intermediary (short) buffer, before writing to the final (long) buffer
-			short read_buffer[0x1000];
+			const size_t sub_frames_to_do = MIN(frames_to_do - frames_done, WORKER_BUS_FRAMES);
+			const MixBus sub_bus = OffsetBus(bus, frames_done);
 
-			// Obtain samples
-			const size_t sub_frames_to_do = MIN(COUNT_OF(read_buffer), samples_to_do) / CHANNEL_COUNT;
-			const size_t sub_frames_done = sound->pipeline.GetSamples(sound->pipeline.decoder, read_buffer, sub_frames_to_do);
+			// Hand the voices out to the workers, and help them out by mixing some directly into the output bus
+			mixer->job_voice_count = voices->count;
+			mixer->job_float_bus = bus->float_buffer != NULL;
+			mixer->job_frames = sub_frames_to_do;
+			Atomic_Store(&mixer->job_next_voice, 0);
 
-			const short *read_buffer_pointer = read_buffer;
+			for (unsigned int i = 0; i < mixer->worker_count; ++i)
+				Semaphore_Post(mixer->workers[i]->start_semaphore);
 
-			// Choose from multiple mixing codepaths
-			if (sound->fade_countdown != 0)
-			{
-				// Slow path which performs fading and volume adjustments
-				for (size_t i = 0; i < sub_frames_done; ++i)
-				{
-					// Update fade volume if needed
-					if (sound->fade_countdown != 0)
-					{
-						--sound->fade_countdown;
-						sound->fade_volume_accumulator += sound->fade_volume_delta;
-						UpdateSoundVolume(sound);
-					}
+			MixClaimedVoices(mixer, &sub_bus, mixer->scratch, false);
 
-					// Mix samples with output, and apply volume
-					*output_buffer_pointer++ += SCALE(*read_buffer_pointer++, sound->final_volume_left);
-					*output_buffer_pointer++ += SCALE(*read_buffer_pointer++, sound->final_volume_right);
-				}
-			}
-			else if (sound->final_volume_left != 0x100 || sound->final_volume_right != 0x100)
-			{
-				// Fast path which bypasses fading
-				for (size_t i = 0; i < sub_frames_done; ++i)
-				{
-					// Mix samples with output, and apply volume
-					*output_buffer_pointer++ += SCALE(*read_buffer_pointer++, sound->final_volume_left);
-					*output_buffer_pointer++ += SCALE(*read_buffer_pointer++, sound->final_volume_right);
-				}
-			}
-			else
+			for (unsigned int i = 0; i < mixer->worker_count; ++i)
+				Semaphore_Wait(mixer->workers_done_semaphore);
+
+			// Sum the workers' buses
+			for (unsigned int i = 0; i < mixer->worker_count; ++i)
 			{
-				// Fastest path which bypasses fading and volume adjustments
-				for (size_t i = 0; i < sub_frames_done; ++i)
+				MixWorker *worker = mixer->workers[i];
+
+				if (worker->voices_mixed != 0)
 				{
-					// Mix samples with output
-					*output_buffer_pointer++ += *read_buffer_pointer++;
-					*output_buffer_pointer++ += *read_buffer_pointer++;
+					const MixBus worker_bus = MakeBus(&worker->bus, mixer->job_float_bus);
+					SumBus(&sub_bus, &worker_bus, sub_frames_to_do);
 				}
 			}
 
-			// If we received fewer samples than we requested, then the sound has reached its end
-			if (sub_frames_done < sub_frames_to_do)
-			{
-				if (sound->destroy_when_done)
-					DestroySound(mixer, sound); // Frees `sound`
-				else
-					PauseSound(mixer, sound);
+			// Now deal with the voices that finished. This is done back-to-front, since removing
+			// a voice moves the last one into its place, and the last one has been dealt with already.
+			for (size_t voice = mixer->job_voice_count; voice-- != 0; )
+				if (voices->finished[voice])
+					FinishVoice(mixer, voice);
+
+			frames_done += sub_frames_to_do;
 
+			if (voices->count < 2)
+			{
+				// Not worth waking the workers for
+				const MixBus remaining_bus = OffsetBus(bus, frames_done);
+				MixSamples(mixer, &remaining_bus, frames_to_do - frames_done);
 				break;
 			}
 		}
-
-		sound = next_sound;
 	}
 }
 
-CLOWNAUDIO_EXPORT void ClownAudio_Mixer_OutputSamples(ClownAudio_Mixer *mixer, short *output_buffer, size_t frames_to_do)
+CLOWNAUDIO_EXPORT void ClownAudio_Mixer_MixSamples(ClownAudio_Mixer *mixer, long *output_buffer, size_t frames_to_do)
+{
+	const MixBus bus = MakeBus(output_buffer, false);
+	MixSamples(mixer, &bus, frames_to_do);
+}
+
+CLOWNAUDIO_EXPORT void ClownAudio_Mixer_MixSamplesFloat(ClownAudio_Mixer *mixer, float *output_buffer, size_t frames_to_do)
+{
+	// The voices are mixed straight into the caller's buffer
+	const MixBus bus = MakeBus(output_buffer, true);
+	MixSamples(mixer, &bus, frames_to_do);
+}
+
+// Mixes into a temporary bus, a chunk at a time, and hands each chunk to `Store`, along with how many frames came before it
+static void OutputMixedSamples(ClownAudio_Mixer *mixer, bool float_bus, void (*Store)(ClownAudio_Mixer *mixer, void *output, size_t frames_done, const MixBus *bus, size_t frames_to_do), void *output, size_t frames_to_do)
 {
 	size_t frames_done = 0;
 	while (frames_done < frames_to_do)
 	{
 		// Mix samples into a temporary mix buffer
-		long mix_buffer[0x1000];
-
-		const size_t sub_frames_to_do = MIN(COUNT_OF(mix_buffer) / CHANNEL_COUNT, frames_to_do - frames_done);
+		union
+		{
+			long long_samples[0x1000];
+			float float_samples[0x1000];
+		} mix_buffer;
 
-		memset(mix_buffer, 0, sub_frames_to_do * sizeof(long) * CHANNEL_COUNT);
-		ClownAudio_Mixer_MixSamples(mixer, mix_buffer, sub_frames_to_do);
+		const MixBus bus = MakeBus(&mix_buffer, float_bus);
+		const size_t sub_frames_to_do = MIN(COUNT_OF(mix_buffer.long_samples) / CHANNEL_COUNT, frames_to_do - frames_done);
 
-		// Clamp mixed samples to 16-bit range and write them to output buffer
-		for (size_t i = 0; i < sub_frames_to_do * CHANNEL_COUNT; ++i)
-		{
-			const long mix_sample = mix_buffer[i];
+		ClearBus(&bus, sub_frames_to_do);
+		MixSamples(mixer, &bus, sub_frames_to_do);
 
-			*output_buffer++ = (short)CLAMP(mix_sample, -0x7FFF, 0x7FFF);
-		}
+		Store(mixer, output, frames_done, &bus, sub_frames_to_do);
 
 		frames_done += sub_frames_to_do;
 	}
 }
+
+static void StoreS16(ClownAudio_Mixer *mixer, void *output, size_t frames_done, const MixBus *bus, size_t frames_to_do)
+{
+	// Clamp mixed samples to 16-bit range and write them to output buffer
+	mixer->kernels->ClampToS16(&((short*)output)[frames_done * CHANNEL_COUNT], bus->long_buffer, frames_to_do * CHANNEL_COUNT);
+}
+
+static void StoreFloatPlanar(ClownAudio_Mixer *mixer, void *output, size_t frames_done, const MixBus *bus, size_t frames_to_do)
+{
+	(void)mixer;
+
+	float *const *output_buffers = (float *const *)output;
+
+	// De-interlace the mixed samples into one buffer per channel
+	for (unsigned int channel = 0; channel < CHANNEL_COUNT; ++channel)
+	{
+		float *channel_buffer = &output_buffers[channel][frames_done];
+
+		for (size_t i = 0; i < frames_to_do; ++i)
+			channel_buffer[i] = bus->float_buffer[i * CHANNEL_COUNT + channel];
+	}
+}
+
+CLOWNAUDIO_EXPORT void ClownAudio_Mixer_OutputSamples(ClownAudio_Mixer *mixer, short *output_buffer, size_t frames_to_do)
+{
+	OutputMixedSamples(mixer, false, StoreS16, output_buffer, frames_to_do);
+}
+
+CLOWNAUDIO_EXPORT void ClownAudio_Mixer_OutputSamplesFloat(ClownAudio_Mixer *mixer, float *output_buffer, size_t frames_to_do)
+{
+	memset(output_buffer, 0, frames_to_do * CHANNEL_COUNT * sizeof(float));
+	ClownAudio_Mixer_MixSamplesFloat(mixer, output_buffer, frames_to_do);
+}
+
+CLOWNAUDIO_EXPORT void ClownAudio_Mixer_OutputSamplesFloatPlanar(ClownAudio_Mixer *mixer, float *const *output_buffers, size_t frames_to_do)
+{
+	// The array of pointers is only read, but `void*` cannot point to it without casting away its `const`
+	OutputMixedSamples(mixer, true, StoreFloatPlanar, (void*)output_buffers, frames_to_do);
+}
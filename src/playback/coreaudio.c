@@ -41,6 +41,7 @@ PERFORMANCE OF THIS SOFTWARE.
 struct ClownAudio_Stream
 {
 	void (*user_callback)(void*, short*, size_t);
+	void (*user_callback_float)(void*, float*, size_t);
 	void *user_data;
 
 	AudioUnit audio_unit;
@@ -59,7 +60,10 @@ static OSStatus Callback(void *inRefCon, AudioUnitRenderActionFlags *ioActionFla
 	(void)inBusNumber;
 
 	/* Because the stream is interleaved, there is only one buffer */
-	stream->user_callback(stream->user_data, (short*)ioData->mBuffers[0].mData, inNumberFrames);
+	if (stream->user_callback_float != NULL)
+		stream->user_callback_float(stream->user_data, (float*)ioData->mBuffers[0].mData, inNumberFrames);
+	else
+		stream->user_callback(stream->user_data, (short*)ioData->mBuffers[0].mData, inNumberFrames);
 
 	return 0;
 }
@@ -89,7 +93,7 @@ CLOWNAUDIO_EXPORT void ClownAudio_DeinitPlayback(void)
 	default_output_component = NULL;
 }
 
-CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *sample_rate, void (*user_callback)(void *user_data, short *output_buffer, size_t frames_to_do))
+static ClownAudio_Stream* CreateStream(unsigned long *sample_rate, void (*user_callback)(void*, short*, size_t), void (*user_callback_float)(void*, float*, size_t))
 {
 	ClownAudio_Stream *stream = (ClownAudio_Stream*)malloc(sizeof(ClownAudio_Stream));
 
@@ -105,15 +109,15 @@ CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *samp
 				/* Use a suitable output format */
 				AudioStreamBasicDescription want;
 				want.mFormatID = kAudioFormatLinearPCM;
-				want.mFormatFlags = kLinearPCMFormatFlagIsSignedInteger | kLinearPCMFormatFlagIsPacked
+				want.mFormatFlags = (user_callback_float != NULL ? kLinearPCMFormatFlagIsFloat : kLinearPCMFormatFlagIsSignedInteger) | kLinearPCMFormatFlagIsPacked
 			#if defined(__ppc64__) || defined(__ppc__)
 				                    | kAudioFormatFlagIsBigEndian
 			#endif
 				                    ;
 				/* TODO: Get default sample rate */
 				want.mSampleRate = (float) *sample_rate;
-				/* 16 bit output */
-				want.mBitsPerChannel = sizeof(short) * 8;
+				/* 32 bit float or 16 bit integer output */
+				want.mBitsPerChannel = (user_callback_float != NULL ? sizeof(float) : sizeof(short)) * 8;
 				want.mChannelsPerFrame = CLOWNAUDIO_STREAM_CHANNEL_COUNT;
 				/* kAudioFormatLinearPCM doesn't use packets */
 				want.mFramesPerPacket = 1;
@@ -143,6 +147,7 @@ CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *samp
 						if (!error)
 						{
 							stream->user_callback = user_callback;
+							stream->user_callback_float = user_callback_float;
 							stream->user_data = NULL;
 
 							pthread_mutex_init(&stream->pthread_mutex, NULL);
@@ -162,6 +167,16 @@ CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *samp
 	return NULL;
 }
 
+CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *sample_rate, void (*user_callback)(void *user_data, short *output_buffer, size_t frames_to_do))
+{
+	return CreateStream(sample_rate, user_callback, NULL);
+}
+
+CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreateFloat(unsigned long *sample_rate, void (*user_callback)(void *user_data, float *output_buffer, size_t frames_to_do))
+{
+	return CreateStream(sample_rate, NULL, user_callback);
+}
+
 CLOWNAUDIO_EXPORT bool ClownAudio_StreamDestroy(ClownAudio_Stream *stream)
 {
 	bool success = true;
@@ -34,6 +34,7 @@
 struct ClownAudio_Stream
 {
 	void (*user_callback)(void*, short*, size_t);
+	void (*user_callback_float)(void*, float*, size_t);
 	void *user_data;
 
 	cubeb_stream *cubeb_stream_pointer;
@@ -55,7 +56,10 @@ static long DataCallback(cubeb_stream *c_stream, void *user_data, void const *in
 
 	ClownAudio_Stream *stream = (ClownAudio_Stream*)user_data;
 
-	stream->user_callback(stream->user_data, (short*)output_buffer, frames_to_do);
+	if (stream->user_callback_float != NULL)
+		stream->user_callback_float(stream->user_data, (float*)output_buffer, frames_to_do);
+	else
+		stream->user_callback(stream->user_data, (short*)output_buffer, frames_to_do);
 
 	return frames_to_do;
 }
@@ -85,10 +89,10 @@ CLOWNAUDIO_EXPORT void ClownAudio_DeinitPlayback(void)
 #endif
 }
 
-CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *sample_rate, void (*user_callback)(void *user_data, short *output_buffer, size_t frames_to_do))
+static ClownAudio_Stream* CreateStream(unsigned long *sample_rate, void (*user_callback)(void*, short*, size_t), void (*user_callback_float)(void*, float*, size_t))
 {
 	cubeb_stream_params output_params;
-	output_params.format = CUBEB_SAMPLE_S16NE;
+	output_params.format = user_callback_float != NULL ? CUBEB_SAMPLE_FLOAT32NE : CUBEB_SAMPLE_S16NE;
 	output_params.prefs = CUBEB_STREAM_PREF_NONE;
 	output_params.channels = CLOWNAUDIO_STREAM_CHANNEL_COUNT;
 	output_params.layout = CLOWNAUDIO_STREAM_CHANNEL_COUNT == 2 ? CUBEB_LAYOUT_STEREO : CUBEB_LAYOUT_MONO;
@@ -111,6 +115,7 @@ CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *samp
 			if (cubeb_stream_init(cubeb_context, &cubeb_stream_pointer, "clownaudio stream", NULL, NULL, NULL, &output_params, latency_frames, DataCallback, StateCallback, stream) == CUBEB_OK)
 			{
 				stream->user_callback = user_callback;
+				stream->user_callback_float = user_callback_float;
 				stream->user_data = NULL;
 
 				stream->cubeb_stream_pointer = cubeb_stream_pointer;
@@ -131,6 +136,16 @@ CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *samp
 	return NULL;
 }
 
+CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *sample_rate, void (*user_callback)(void *user_data, short *output_buffer, size_t frames_to_do))
+{
+	return CreateStream(sample_rate, user_callback, NULL);
+}
+
+CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreateFloat(unsigned long *sample_rate, void (*user_callback)(void *user_data, float *output_buffer, size_t frames_to_do))
+{
+	return CreateStream(sample_rate, NULL, user_callback);
+}
+
 CLOWNAUDIO_EXPORT bool ClownAudio_StreamDestroy(ClownAudio_Stream *stream)
 {
 	bool success = true;
@@ -44,6 +44,7 @@
 struct ClownAudio_Stream
 {
 	void (*user_callback)(void*, short*, size_t);
+	void (*user_callback_float)(void*, float*, size_t);
 	void *user_data;
 
 	ma_device device;
@@ -58,9 +59,11 @@ static void Callback(ma_device *device, void *output_buffer_void, const void *in
 	(void)input_buffer;
 
 	ClownAudio_Stream *stream = (ClownAudio_Stream*)device->pUserData;
-	short *output_buffer = (short*)output_buffer_void;
 
-	stream->user_callback(stream->user_data, output_buffer, frames_to_do);
+	if (stream->user_callback_float != NULL)
+		stream->user_callback_float(stream->user_data, (float*)output_buffer_void, frames_to_do);
+	else
+		stream->user_callback(stream->user_data, (short*)output_buffer_void, frames_to_do);
 }
 
 CLOWNAUDIO_EXPORT bool ClownAudio_InitPlayback(void)
@@ -73,7 +76,7 @@ CLOWNAUDIO_EXPORT void ClownAudio_DeinitPlayback(void)
 	ma_context_uninit(&context);
 }
 
-CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *sample_rate, void (*user_callback)(void *user_data, short *output_buffer, size_t frames_to_do))
+static ClownAudio_Stream* CreateStream(unsigned long *sample_rate, void (*user_callback)(void*, short*, size_t), void (*user_callback_float)(void*, float*, size_t))
 {
 	ClownAudio_Stream *stream = (ClownAudio_Stream*)malloc(sizeof(ClownAudio_Stream));
 
@@ -81,7 +84,7 @@ CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *samp
 	{
 		ma_device_config config = ma_device_config_init(ma_device_type_playback);
 		config.playback.pDeviceID = NULL;
-		config.playback.format = ma_format_s16;
+		config.playback.format = user_callback_float != NULL ? ma_format_f32 : ma_format_s16;
 		config.playback.channels = 2;
 		config.sampleRate = 0;	// Use native sample rate
 		config.noPreSilencedOutputBuffer = MA_TRUE;
@@ -94,6 +97,7 @@ CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *samp
 			*sample_rate = stream->device.sampleRate;
 
 			stream->user_callback = user_callback;
+			stream->user_callback_float = user_callback_float;
 			stream->user_data = NULL;
 
 			if (ma_mutex_init(&stream->mutex) == MA_SUCCESS)
@@ -108,6 +112,16 @@ CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *samp
 	return NULL;
 }
 
+CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *sample_rate, void (*user_callback)(void *user_data, short *output_buffer, size_t frames_to_do))
+{
+	return CreateStream(sample_rate, user_callback, NULL);
+}
+
+CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreateFloat(unsigned long *sample_rate, void (*user_callback)(void *user_data, float *output_buffer, size_t frames_to_do))
+{
+	return CreateStream(sample_rate, NULL, user_callback);
+}
+
 CLOWNAUDIO_EXPORT bool ClownAudio_StreamDestroy(ClownAudio_Stream *stream)
 {
 	if (stream != NULL)
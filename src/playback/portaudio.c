@@ -35,6 +35,7 @@
 struct ClownAudio_Stream
 {
 	void (*user_callback)(void*, short*, size_t);
+	void (*user_callback_float)(void*, float*, size_t);
 	void *user_data;
 
 	PaStream *pa_stream;
@@ -53,9 +54,11 @@ static int Callback(const void *input_buffer, void *output_buffer_void, unsigned
 	(void)status_flags;
 
 	ClownAudio_Stream *stream = (ClownAudio_Stream*)user_data;
-	short *output_buffer = (short*)output_buffer_void;
 
-	stream->user_callback(stream->user_data, output_buffer, frames_to_do);
+	if (stream->user_callback_float != NULL)
+		stream->user_callback_float(stream->user_data, (float*)output_buffer_void, frames_to_do);
+	else
+		stream->user_callback(stream->user_data, (short*)output_buffer_void, frames_to_do);
 
 	return paContinue;
 }
@@ -70,7 +73,7 @@ CLOWNAUDIO_EXPORT void ClownAudio_DeinitPlayback(void)
 	Pa_Terminate();
 }
 
-CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *sample_rate, void (*user_callback)(void *user_data, short *output_buffer, size_t frames_to_do))
+static ClownAudio_Stream* CreateStream(unsigned long *sample_rate, void (*user_callback)(void*, short*, size_t), void (*user_callback_float)(void*, float*, size_t))
 {
 	ClownAudio_Stream *stream = (ClownAudio_Stream*)malloc(sizeof(ClownAudio_Stream));
 
@@ -80,9 +83,10 @@ CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *samp
 
 		*sample_rate = device_info->defaultSampleRate;
 
-		if (Pa_OpenDefaultStream(&stream->pa_stream, 0, CLOWNAUDIO_STREAM_CHANNEL_COUNT, paInt16, device_info->defaultSampleRate, paFramesPerBufferUnspecified, Callback, stream ) == paNoError)
+		if (Pa_OpenDefaultStream(&stream->pa_stream, 0, CLOWNAUDIO_STREAM_CHANNEL_COUNT, user_callback_float != NULL ? paFloat32 : paInt16, device_info->defaultSampleRate, paFramesPerBufferUnspecified, Callback, stream ) == paNoError)
 		{
 			stream->user_callback = user_callback;
+			stream->user_callback_float = user_callback_float;
 			stream->user_data = NULL;
 
 		#ifdef _WIN32
@@ -100,6 +104,16 @@ CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *samp
 	return NULL;
 }
 
+CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *sample_rate, void (*user_callback)(void *user_data, short *output_buffer, size_t frames_to_do))
+{
+	return CreateStream(sample_rate, user_callback, NULL);
+}
+
+CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreateFloat(unsigned long *sample_rate, void (*user_callback)(void *user_data, float *output_buffer, size_t frames_to_do))
+{
+	return CreateStream(sample_rate, NULL, user_callback);
+}
+
 CLOWNAUDIO_EXPORT bool ClownAudio_StreamDestroy(ClownAudio_Stream *stream)
 {
 	bool success = true;
@@ -32,6 +32,7 @@
 struct ClownAudio_Stream
 {
 	void (*user_callback)(void*, short*, size_t);
+	void (*user_callback_float)(void*, float*, size_t);
 	void *user_data;
 };
 
@@ -56,7 +57,33 @@ static void Callback(void *user_data, Uint8 *output_buffer_uint8, int bytes_to_d
 	const unsigned long frames_to_do = bytes_to_do / (sizeof(short) * CLOWNAUDIO_STREAM_CHANNEL_COUNT);
 	short *output_buffer = (short*)output_buffer_uint8;
 
-	stream->user_callback(stream->user_data, output_buffer, frames_to_do);
+	if (stream->user_callback_float != NULL)
+	{
+		// SDL1.2 does not support float output, so convert it here
+		unsigned long frames_done = 0;
+		while (frames_done < frames_to_do)
+		{
+			float float_buffer[0x400 * CLOWNAUDIO_STREAM_CHANNEL_COUNT];
+
+			const unsigned long sub_frames_to_do = MIN(0x400, frames_to_do - frames_done);
+
+			stream->user_callback_float(stream->user_data, float_buffer, sub_frames_to_do);
+
+			for (unsigned long i = 0; i < sub_frames_to_do * CLOWNAUDIO_STREAM_CHANNEL_COUNT; ++i)
+			{
+				const float sample = float_buffer[i] * 0x8000;
+
+				output_buffer[i] = (short)(sample > 0x7FFF ? 0x7FFF : sample < -0x7FFF ? -0x7FFF : sample);
+			}
+
+			output_buffer += sub_frames_to_do * CLOWNAUDIO_STREAM_CHANNEL_COUNT;
+			frames_done += sub_frames_to_do;
+		}
+	}
+	else
+	{
+		stream->user_callback(stream->user_data, output_buffer, frames_to_do);
+	}
 }
 
 CLOWNAUDIO_EXPORT bool ClownAudio_InitPlayback(void)
@@ -78,7 +105,7 @@ CLOWNAUDIO_EXPORT void ClownAudio_DeinitPlayback(void)
 		SDL_QuitSubSystem(SDL_INIT_AUDIO);
 }
 
-CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *sample_rate, void (*user_callback)(void *user_data, short *output_buffer, size_t frames_to_do))
+static ClownAudio_Stream* CreateStream(unsigned long *sample_rate, void (*user_callback)(void*, short*, size_t), void (*user_callback_float)(void*, float*, size_t))
 {
 	ClownAudio_Stream *stream = (ClownAudio_Stream*)malloc(sizeof(ClownAudio_Stream));
 
@@ -96,6 +123,7 @@ CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *samp
 		if (SDL_OpenAudio(&want, NULL) == 0)
 		{
 			stream->user_callback = user_callback;
+			stream->user_callback_float = user_callback_float;
 			stream->user_data = NULL;
 
 			return stream;
@@ -107,6 +135,16 @@ CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *samp
 	return NULL;
 }
 
+CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *sample_rate, void (*user_callback)(void *user_data, short *output_buffer, size_t frames_to_do))
+{
+	return CreateStream(sample_rate, user_callback, NULL);
+}
+
+CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreateFloat(unsigned long *sample_rate, void (*user_callback)(void *user_data, float *output_buffer, size_t frames_to_do))
+{
+	return CreateStream(sample_rate, NULL, user_callback);
+}
+
 CLOWNAUDIO_EXPORT bool ClownAudio_StreamDestroy(ClownAudio_Stream *stream)
 {
 	if (stream != NULL)
@@ -30,6 +30,7 @@
 struct ClownAudio_Stream
 {
 	void (*user_callback)(void*, short*, size_t);
+	void (*user_callback_float)(void*, float*, size_t);
 	void *user_data;
 
 	SDL_AudioDeviceID device;
@@ -58,10 +59,11 @@ static unsigned int NextPowerOfTwo(unsigned int value)
 static void Callback(void *user_data, Uint8 *output_buffer_uint8, int bytes_to_do)
 {
 	ClownAudio_Stream *stream = (ClownAudio_Stream*)user_data;
-	const unsigned long frames_to_do = bytes_to_do / (sizeof(short) * CLOWNAUDIO_STREAM_CHANNEL_COUNT);
-	short *output_buffer = (short*)output_buffer_uint8;
 
-	stream->user_callback(stream->user_data, output_buffer, frames_to_do);
+	if (stream->user_callback_float != NULL)
+		stream->user_callback_float(stream->user_data, (float*)output_buffer_uint8, bytes_to_do / (sizeof(float) * CLOWNAUDIO_STREAM_CHANNEL_COUNT));
+	else
+		stream->user_callback(stream->user_data, (short*)output_buffer_uint8, bytes_to_do / (sizeof(short) * CLOWNAUDIO_STREAM_CHANNEL_COUNT));
 }
 
 CLOWNAUDIO_EXPORT bool ClownAudio_InitPlayback(void)
@@ -83,7 +85,7 @@ CLOWNAUDIO_EXPORT void ClownAudio_DeinitPlayback(void)
 		SDL_QuitSubSystem(SDL_INIT_AUDIO);
 }
 
-CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *sample_rate, void (*user_callback)(void *user_data, short *output_buffer, size_t frames_to_do))
+static ClownAudio_Stream* CreateStream(unsigned long *sample_rate, void (*user_callback)(void*, short*, size_t), void (*user_callback_float)(void*, float*, size_t))
 {
 	ClownAudio_Stream *stream = (ClownAudio_Stream*)malloc(sizeof(ClownAudio_Stream));
 
@@ -92,7 +94,7 @@ CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *samp
 		SDL_AudioSpec want, have;
 		memset(&want, 0, sizeof(want));
 		want.freq = *sample_rate;
-		want.format = AUDIO_S16;
+		want.format = user_callback_float != NULL ? AUDIO_F32SYS : AUDIO_S16;
 		want.channels = CLOWNAUDIO_STREAM_CHANNEL_COUNT;
 		want.samples = NextPowerOfTwo(((*sample_rate * 10) / 1000) * CLOWNAUDIO_STREAM_CHANNEL_COUNT);	// A low-latency buffer of 10 milliseconds
 		want.callback = Callback;
@@ -105,6 +107,7 @@ CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *samp
 			*sample_rate = have.freq;
 
 			stream->user_callback = user_callback;
+			stream->user_callback_float = user_callback_float;
 			stream->user_data = NULL;
 
 			stream->device = device;
@@ -118,6 +121,16 @@ CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *samp
 	return NULL;
 }
 
+CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreate(unsigned long *sample_rate, void (*user_callback)(void *user_data, short *output_buffer, size_t frames_to_do))
+{
+	return CreateStream(sample_rate, user_callback, NULL);
+}
+
+CLOWNAUDIO_EXPORT ClownAudio_Stream* ClownAudio_StreamCreateFloat(unsigned long *sample_rate, void (*user_callback)(void *user_data, float *output_buffer, size_t frames_to_do))
+{
+	return CreateStream(sample_rate, NULL, user_callback);
+}
+
 CLOWNAUDIO_EXPORT bool ClownAudio_StreamDestroy(ClownAudio_Stream *stream)
 {
 	if (stream != NULL)
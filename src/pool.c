@@ -0,0 +1,230 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#include "pool.h"
+
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "threading.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+#define COUNT_OF(array) (sizeof(array) / sizeof(*(array)))
+
+#define SMALLEST_BLOCK_SIZE 0x40
+#define CHUNK_SIZE 0x10000	// Blocks are allocated from the heap in batches of roughly this many bytes
+
+typedef struct PoolSizeClass PoolSizeClass;
+
+// Sits in front of every block, and of every chunk of blocks.
+// It is a union so that whatever comes after it is suitably aligned for anything.
+typedef union PoolHeader
+{
+	struct
+	{
+		PoolSizeClass *size_class;	// NULL if the block came from `malloc`
+		size_t capacity;
+	} block;
+
+	union PoolHeader *next_chunk;
+
+	void *alignment_pointer;
+	long alignment_long;
+	double alignment_double;
+	long double alignment_long_double;
+} PoolHeader;
+
+struct PoolSizeClass
+{
+	Pool *pool;
+	size_t block_size;
+	void *free_list;	// The first few bytes of each free block point to the next one
+};
+
+struct Pool
+{
+	Mutex *mutex;
+	PoolSizeClass size_classes[10];	// 0x40 to 0x8000 bytes
+	PoolHeader *chunk_list;
+};
+
+// Must be guarded with mutex
+static bool AddChunk(PoolSizeClass *size_class)
+{
+	const size_t stride = sizeof(PoolHeader) + size_class->block_size;
+	const size_t total_blocks = MAX(1, CHUNK_SIZE / stride);
+
+	PoolHeader *chunk = (PoolHeader*)malloc(sizeof(PoolHeader) + stride * total_blocks);
+
+	if (chunk == NULL)
+		return false;
+
+	chunk->next_chunk = size_class->pool->chunk_list;
+	size_class->pool->chunk_list = chunk;
+
+	unsigned char *pointer = (unsigned char*)&chunk[1];
+
+	for (size_t i = 0; i < total_blocks; ++i)
+	{
+		PoolHeader *header = (PoolHeader*)pointer;
+		void *block = &header[1];
+
+		header->block.size_class = size_class;
+		header->block.capacity = size_class->block_size;
+
+		*(void**)block = size_class->free_list;
+		size_class->free_list = block;
+
+		pointer += stride;
+	}
+
+	return true;
+}
+
+Pool* Pool_Create(void)
+{
+	Pool *pool = (Pool*)malloc(sizeof(Pool));
+
+	if (pool != NULL)
+	{
+		pool->mutex = Mutex_Create();
+
+		if (pool->mutex != NULL)
+		{
+			for (size_t i = 0; i < COUNT_OF(pool->size_classes); ++i)
+			{
+				pool->size_classes[i].pool = pool;
+				pool->size_classes[i].block_size = (size_t)SMALLEST_BLOCK_SIZE << i;
+				pool->size_classes[i].free_list = NULL;
+			}
+
+			pool->chunk_list = NULL;
+
+			return pool;
+		}
+
+		free(pool);
+	}
+
+	return NULL;
+}
+
+void Pool_Destroy(Pool *pool)
+{
+	for (PoolHeader *chunk = pool->chunk_list; chunk != NULL; )
+	{
+		PoolHeader *next_chunk = chunk->next_chunk;
+
+		free(chunk);
+
+		chunk = next_chunk;
+	}
+
+	Mutex_Destroy(pool->mutex);
+	free(pool);
+}
+
+void* Pool_Alloc(Pool *pool, size_t size)
+{
+	if (pool != NULL)
+	{
+		for (size_t i = 0; i < COUNT_OF(pool->size_classes); ++i)
+		{
+			PoolSizeClass *size_class = &pool->size_classes[i];
+
+			if (size <= size_class->block_size)
+			{
+				void *block = NULL;
+
+				Mutex_Lock(pool->mutex);
+
+				if (size_class->free_list != NULL || AddChunk(size_class))
+				{
+					block = size_class->free_list;
+					size_class->free_list = *(void**)block;
+				}
+
+				Mutex_Unlock(pool->mutex);
+
+				return block;
+			}
+		}
+	}
+
+	// Either there is no pool, or the allocation is too big for it
+	PoolHeader *header = (PoolHeader*)malloc(sizeof(PoolHeader) + size);
+
+	if (header == NULL)
+		return NULL;
+
+	header->block.size_class = NULL;
+	header->block.capacity = size;
+
+	return &header[1];
+}
+
+void* Pool_Realloc(Pool *pool, void *block, size_t size)
+{
+	if (block == NULL)
+		return Pool_Alloc(pool, size);
+
+	const PoolHeader *header = (PoolHeader*)block - 1;
+
+	if (size <= header->block.capacity)
+		return block;
+
+	void *new_block = Pool_Alloc(pool, size);
+
+	if (new_block != NULL)
+	{
+		memcpy(new_block, block, MIN(size, header->block.capacity));
+		Pool_Free(block);
+	}
+
+	return new_block;
+}
+
+void Pool_Free(void *block)
+{
+	if (block != NULL)
+	{
+		PoolHeader *header = (PoolHeader*)block - 1;
+		PoolSizeClass *size_class = header->block.size_class;
+
+		if (size_class == NULL)
+		{
+			free(header);
+		}
+		else
+		{
+			Mutex_Lock(size_class->pool->mutex);
+
+			*(void**)block = size_class->free_list;
+			size_class->free_list = block;
+
+			Mutex_Unlock(size_class->pool->mutex);
+		}
+	}
+}
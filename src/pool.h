@@ -0,0 +1,38 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+
+// A thread-safe allocator which recycles blocks, so that objects which are created and destroyed
+// often do not have to go through the general-purpose heap every time.
+// Blocks are sorted into power-of-two size classes. Anything too large for the biggest one is passed
+// through to `malloc`, as is everything when the pool is NULL.
+
+typedef struct Pool Pool;
+
+Pool* Pool_Create(void);
+void Pool_Destroy(Pool *pool); // Every block must have been freed already
+void* Pool_Alloc(Pool *pool, size_t size);
+void* Pool_Realloc(Pool *pool, void *block, size_t size);
+void Pool_Free(void *block); // Blocks remember where they came from, so the pool does not need to be specified
+
+#endif // POOL_H
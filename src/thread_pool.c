@@ -0,0 +1,150 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#include "thread_pool.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "threading.h"
+
+struct ThreadPool
+{
+	Thread **threads;
+	unsigned int thread_count;
+
+	// Posted once for every job that is submitted, and once for every thread when the pool is destroyed
+	Semaphore *wake_semaphore;
+
+	Mutex *queue_mutex;	// Guards the queue
+	ThreadPoolJob *queue_head;
+	ThreadPoolJob *queue_tail;
+};
+
+static void ThreadFunction(void *user_data)
+{
+	ThreadPool *pool = (ThreadPool*)user_data;
+
+	for (;;)
+	{
+		Semaphore_Wait(pool->wake_semaphore);
+
+		Mutex_Lock(pool->queue_mutex);
+
+		ThreadPoolJob *job = pool->queue_head;
+
+		if (job != NULL)
+		{
+			pool->queue_head = job->next;
+
+			if (pool->queue_head == NULL)
+				pool->queue_tail = NULL;
+		}
+
+		Mutex_Unlock(pool->queue_mutex);
+
+		// Threads are only woken without a job when the pool is being destroyed, and by then every job has been taken
+		if (job == NULL)
+			break;
+
+		job->function(job->user_data);
+	}
+}
+
+ThreadPool* ThreadPool_Create(unsigned int thread_count)
+{
+	ThreadPool *pool = (ThreadPool*)malloc(sizeof(ThreadPool));
+
+	if (pool != NULL)
+	{
+		pool->threads = (Thread**)malloc(sizeof(Thread*) * thread_count);
+		pool->thread_count = 0;
+		pool->queue_head = NULL;
+		pool->queue_tail = NULL;
+
+		if (pool->threads != NULL)
+		{
+			pool->wake_semaphore = Semaphore_Create(0);
+
+			if (pool->wake_semaphore != NULL)
+			{
+				pool->queue_mutex = Mutex_Create();
+
+				if (pool->queue_mutex != NULL)
+				{
+					while (pool->thread_count < thread_count)
+					{
+						Thread *thread = Thread_Create(ThreadFunction, pool);
+
+						if (thread == NULL)
+							break;
+
+						pool->threads[pool->thread_count++] = thread;
+					}
+
+					// Make do with fewer threads if some could not be created
+					if (pool->thread_count != 0)
+						return pool;
+
+					Mutex_Destroy(pool->queue_mutex);
+				}
+
+				Semaphore_Destroy(pool->wake_semaphore);
+			}
+
+			free(pool->threads);
+		}
+
+		free(pool);
+	}
+
+	return NULL;
+}
+
+void ThreadPool_Destroy(ThreadPool *pool)
+{
+	for (unsigned int i = 0; i < pool->thread_count; ++i)
+		Semaphore_Post(pool->wake_semaphore);
+
+	for (unsigned int i = 0; i < pool->thread_count; ++i)
+		Thread_Join(pool->threads[i]);
+
+	Mutex_Destroy(pool->queue_mutex);
+	Semaphore_Destroy(pool->wake_semaphore);
+	free(pool->threads);
+	free(pool);
+}
+
+void ThreadPool_Submit(ThreadPool *pool, ThreadPoolJob *job)
+{
+	job->next = NULL;
+
+	Mutex_Lock(pool->queue_mutex);
+
+	if (pool->queue_tail != NULL)
+		pool->queue_tail->next = job;
+	else
+		pool->queue_head = job;
+
+	pool->queue_tail = job;
+
+	Mutex_Unlock(pool->queue_mutex);
+
+	Semaphore_Post(pool->wake_semaphore);
+}
@@ -0,0 +1,38 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+// A fixed set of threads which run jobs in the order that they were submitted
+
+typedef struct ThreadPoolJob
+{
+	void (*function)(void *user_data);
+	void *user_data;
+	struct ThreadPoolJob *next;	// Used internally
+} ThreadPoolJob;
+
+typedef struct ThreadPool ThreadPool;
+
+ThreadPool* ThreadPool_Create(unsigned int thread_count);
+void ThreadPool_Destroy(ThreadPool *pool); // Waits for every submitted job to finish first
+void ThreadPool_Submit(ThreadPool *pool, ThreadPoolJob *job); // `job` must remain valid until its function is called
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,295 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#include "threading.h"
+
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+#include <stddef.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+ #define WIN32_LEAN_AND_MEAN
+ #include <windows.h>
+#else
+ #include <pthread.h>
+ #include <sys/time.h>
+ #include <time.h>
+ #include <unistd.h>
+#endif
+
+struct Mutex
+{
+#ifdef _WIN32
+	CRITICAL_SECTION critical_section;
+#else
+	pthread_mutex_t pthread_mutex;
+#endif
+};
+
+Mutex* Mutex_Create(void)
+{
+	Mutex *mutex = (Mutex*)malloc(sizeof(Mutex));
+
+	if (mutex != NULL)
+	{
+	#ifdef _WIN32
+		InitializeCriticalSection(&mutex->critical_section);
+		return mutex;
+	#else
+		if (pthread_mutex_init(&mutex->pthread_mutex, NULL) == 0)
+			return mutex;
+	#endif
+
+		free(mutex);
+	}
+
+	return NULL;
+}
+
+void Mutex_Destroy(Mutex *mutex)
+{
+#ifdef _WIN32
+	DeleteCriticalSection(&mutex->critical_section);
+#else
+	pthread_mutex_destroy(&mutex->pthread_mutex);
+#endif
+
+	free(mutex);
+}
+
+void Mutex_Lock(Mutex *mutex)
+{
+#ifdef _WIN32
+	EnterCriticalSection(&mutex->critical_section);
+#else
+	pthread_mutex_lock(&mutex->pthread_mutex);
+#endif
+}
+
+void Mutex_Unlock(Mutex *mutex)
+{
+#ifdef _WIN32
+	LeaveCriticalSection(&mutex->critical_section);
+#else
+	pthread_mutex_unlock(&mutex->pthread_mutex);
+#endif
+}
+
+struct Semaphore
+{
+#ifdef _WIN32
+	HANDLE handle;
+#else
+	// POSIX semaphores are not available everywhere (macOS lacks unnamed ones), so this is built from a condition variable
+	pthread_mutex_t pthread_mutex;
+	pthread_cond_t pthread_cond;
+	unsigned int count;
+#endif
+};
+
+Semaphore* Semaphore_Create(unsigned int initial_count)
+{
+	Semaphore *semaphore = (Semaphore*)malloc(sizeof(Semaphore));
+
+	if (semaphore != NULL)
+	{
+	#ifdef _WIN32
+		semaphore->handle = CreateSemaphore(NULL, initial_count, 0x7FFFFFFF, NULL);
+
+		if (semaphore->handle != NULL)
+			return semaphore;
+	#else
+		semaphore->count = initial_count;
+
+		if (pthread_mutex_init(&semaphore->pthread_mutex, NULL) == 0)
+		{
+			if (pthread_cond_init(&semaphore->pthread_cond, NULL) == 0)
+				return semaphore;
+
+			pthread_mutex_destroy(&semaphore->pthread_mutex);
+		}
+	#endif
+
+		free(semaphore);
+	}
+
+	return NULL;
+}
+
+void Semaphore_Destroy(Semaphore *semaphore)
+{
+#ifdef _WIN32
+	CloseHandle(semaphore->handle);
+#else
+	pthread_cond_destroy(&semaphore->pthread_cond);
+	pthread_mutex_destroy(&semaphore->pthread_mutex);
+#endif
+
+	free(semaphore);
+}
+
+void Semaphore_Post(Semaphore *semaphore)
+{
+#ifdef _WIN32
+	ReleaseSemaphore(semaphore->handle, 1, NULL);
+#else
+	pthread_mutex_lock(&semaphore->pthread_mutex);
+	++semaphore->count;
+	pthread_cond_signal(&semaphore->pthread_cond);
+	pthread_mutex_unlock(&semaphore->pthread_mutex);
+#endif
+}
+
+void Semaphore_Wait(Semaphore *semaphore)
+{
+#ifdef _WIN32
+	WaitForSingleObject(semaphore->handle, INFINITE);
+#else
+	pthread_mutex_lock(&semaphore->pthread_mutex);
+
+	while (semaphore->count == 0)
+		pthread_cond_wait(&semaphore->pthread_cond, &semaphore->pthread_mutex);
+
+	--semaphore->count;
+	pthread_mutex_unlock(&semaphore->pthread_mutex);
+#endif
+}
+
+bool Semaphore_TimedWait(Semaphore *semaphore, unsigned int milliseconds)
+{
+#ifdef _WIN32
+	return WaitForSingleObject(semaphore->handle, milliseconds) == WAIT_OBJECT_0;
+#else
+	// `pthread_cond_timedwait` wants an absolute time on the realtime clock, which `gettimeofday` gives everywhere
+	struct timeval now;
+	gettimeofday(&now, NULL);
+
+	const unsigned long nanoseconds = (unsigned long)now.tv_usec * 1000 + (unsigned long)(milliseconds % 1000) * 1000000;
+
+	struct timespec deadline;
+	deadline.tv_sec = now.tv_sec + milliseconds / 1000 + (time_t)(nanoseconds / 1000000000);
+	deadline.tv_nsec = (long)(nanoseconds % 1000000000);
+
+	bool success = true;
+
+	pthread_mutex_lock(&semaphore->pthread_mutex);
+
+	while (semaphore->count == 0)
+	{
+		if (pthread_cond_timedwait(&semaphore->pthread_cond, &semaphore->pthread_mutex, &deadline) != 0 && semaphore->count == 0)
+		{
+			success = false;
+			break;
+		}
+	}
+
+	if (success)
+		--semaphore->count;
+
+	pthread_mutex_unlock(&semaphore->pthread_mutex);
+
+	return success;
+#endif
+}
+
+struct Thread
+{
+#ifdef _WIN32
+	HANDLE handle;
+#else
+	pthread_t pthread;
+#endif
+	void (*function)(void *user_data);
+	void *user_data;
+};
+
+#ifdef _WIN32
+static DWORD WINAPI ThreadEntry(LPVOID thread_void)
+{
+	Thread *thread = (Thread*)thread_void;
+
+	thread->function(thread->user_data);
+
+	return 0;
+}
+#else
+static void* ThreadEntry(void *thread_void)
+{
+	Thread *thread = (Thread*)thread_void;
+
+	thread->function(thread->user_data);
+
+	return NULL;
+}
+#endif
+
+Thread* Thread_Create(void (*function)(void *user_data), void *user_data)
+{
+	Thread *thread = (Thread*)malloc(sizeof(Thread));
+
+	if (thread != NULL)
+	{
+		thread->function = function;
+		thread->user_data = user_data;
+
+	#ifdef _WIN32
+		thread->handle = CreateThread(NULL, 0, ThreadEntry, thread, 0, NULL);
+
+		if (thread->handle != NULL)
+			return thread;
+	#else
+		if (pthread_create(&thread->pthread, NULL, ThreadEntry, thread) == 0)
+			return thread;
+	#endif
+
+		free(thread);
+	}
+
+	return NULL;
+}
+
+void Thread_Join(Thread *thread)
+{
+#ifdef _WIN32
+	WaitForSingleObject(thread->handle, INFINITE);
+	CloseHandle(thread->handle);
+#else
+	pthread_join(thread->pthread, NULL);
+#endif
+
+	free(thread);
+}
+
+unsigned int Thread_GetProcessorCount(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO system_info;
+	GetSystemInfo(&system_info);
+
+	return system_info.dwNumberOfProcessors != 0 ? (unsigned int)system_info.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+	const long processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return processor_count > 0 ? (unsigned int)processor_count : 1;
+#else
+	return 1;
+#endif
+}
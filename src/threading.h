@@ -0,0 +1,49 @@
+// Copyright (c) 2019-2021 Clownacy
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#ifndef THREADING_H
+#define THREADING_H
+
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+
+typedef struct Mutex Mutex;
+
+Mutex* Mutex_Create(void);
+void Mutex_Destroy(Mutex *mutex);
+void Mutex_Lock(Mutex *mutex);
+void Mutex_Unlock(Mutex *mutex);
+
+typedef struct Semaphore Semaphore;
+
+Semaphore* Semaphore_Create(unsigned int initial_count);
+void Semaphore_Destroy(Semaphore *semaphore);
+void Semaphore_Post(Semaphore *semaphore);
+void Semaphore_Wait(Semaphore *semaphore);
+bool Semaphore_TimedWait(Semaphore *semaphore, unsigned int milliseconds); // Returns false if the semaphore was not posted in time
+
+typedef struct Thread Thread;
+
+Thread* Thread_Create(void (*function)(void *user_data), void *user_data);
+void Thread_Join(Thread *thread); // Waits for the thread to finish, and then frees it
+
+unsigned int Thread_GetProcessorCount(void); // Never returns less than 1
+
+#endif // THREADING_H